@@ -4,9 +4,24 @@
  * 
  */
 
+#include <ctype.h>
+#include <errno.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
-#include <sys/time.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <poll.h>
 
 #include <SDL.h>
 #include <SDL_ttf.h>
@@ -14,13 +29,26 @@
 #include <pthread.h>
 #include <GL/gl.h>
 #include <GL/glu.h>
+#ifdef USE_MPI
+#include <mpi.h>
+#endif
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
 
 // Declare constants. Better way than #define due to compiler optimisation
-const Uint32 kBoardWidth = 40;
-const Uint32 kMaxWidth = 39;// To avoid unuseful computation (kBoardWidth - 1)
-const Uint32 kBoardHeight = 30;
-const Uint32 kMaxHeight = 29;// To avoid unuseful computation (kBoardHeight - 1)
+const Uint32 kDefaultBoardWidth = 40;
+const Uint32 kDefaultBoardHeight = 30;
 const Uint32 kTileSize = 20;
+const Uint32 kMaxWindowWidth = 1280; // The window never grows beyond this, the tile shrinks instead
+const Uint32 kMaxWindowHeight = 960;
+const Uint32 kBoardAlignment = 64;   // Every row starts on a cache line
+const Uint32 kActiveTileSize = 64;   // Side in cells of a tile of the active region tracking
+const Uint32 kTemporalDepth = 8;     // Generations per sweep of --temporal unless --depth is given
+const Uint32 kOverlayHeight = 72;    // Height in pixels of the buttons and timings drawn over the board
+const Uint32 kMaxRuleRange = 64;     // Widest neighbourhood of a Larger than Life rule
 static SDL_Color kWhite =  { 0xFF, 0xFF, 0xFF };
 
 #define ACTIVE 1
@@ -39,14 +67,147 @@ typedef struct Button
     char active;                        // Flag to mark the button active or not
 } Button;
 
+/**
+ * The lines of text drawn over the board
+ */
+typedef enum OverlayLine
+{
+    OVERLAY_FPS = 0,
+    OVERLAY_COMPUTE,
+    OVERLAY_DRAW,
+    OVERLAY_LINES
+} OverlayLine;
+
+/**
+ * A line of the overlay: a label, a number and a unit. The line is composed
+ * in its own surface from the cached glyphs, again only when the number
+ * changes.
+ */
+typedef struct OverlayText
+{
+    SDL_Surface * label;                // Rendered once
+    SDL_Surface * unit;                 // Rendered once
+    SDL_Surface * surf;                 // The composed line, black is transparent
+    Sint64 value;                       // Number shown in surf
+    Uint16 width;                       // Width of the composed line in surf
+    int valid;                          // surf holds value
+} OverlayText;
+
+/**
+ * Glyph atlas of the overlay. TTF_RenderText_Blended is only called when
+ * the game starts, each frame only blits cached surfaces.
+ */
+typedef struct Overlay
+{
+    SDL_Surface * digits[11];           // '0' to '9' then '-'
+    OverlayText lines[OVERLAY_LINES];
+} Overlay;
+
+/**
+ * How the cells of a board are stored
+ */
+typedef enum BoardFormat
+{
+    BOARD_BYTES = 0,                    // One byte per cell
+    BOARD_PACKED                        // One bit per cell, 64 cells per Uint64
+} BoardFormat;
+
+/**
+ * What lies beyond the edges of the board (see board_fill_halo)
+ */
+typedef enum Topology
+{
+    TOPOLOGY_DEAD = 0,                  // Dead cells, the default
+    TOPOLOGY_TORUS,                     // The opposite edge
+    TOPOLOGY_KLEIN,                     // The opposite edge, mirrored when going through the top or the bottom
+    TOPOLOGY_ALIVE                      // Living cells
+} Topology;
+
+/**
+ * Board structure.
+ * A generation lives in one contiguous aligned block. The playable area is
+ * surrounded by a dead halo (one row above and below, padding on both sides)
+ * so a neighbour can always be read without walking out of the allocation.
+ */
+typedef struct Board
+{
+    Uint32 width;                       // Number of playable cells per row
+    Uint32 height;                      // Number of playable rows
+    Uint32 stride;                      // Distance in bytes between two rows, padding included
+    Uint32 words;                       // Number of Uint64 per playable row (packed format only)
+    BoardFormat format;
+    Uint8 * memory;                     // The aligned block (halo included)
+    Uint8 * cells;                      // First playable cell of the first playable row
+    size_t mapped;                      // Size of the block when it maps a snapshot file, 0 when allocated
+    Uint8 pooled;                       // The block belongs to an arena, released with it
+} Board;
+
 // Pre-declare the GameContainer structure
 typedef struct GameContainer GameContainer;
 
+// Pre-declare the arena holding the storage of a simulation
+typedef struct Arena Arena;
+
+// Pre-declare the worker pool used by --thread
+typedef struct WorkerPool WorkerPool;
+
+// Pre-declare the GPU state used by --opengl
+typedef struct GpuLife GpuLife;
+
+// Pre-declare the simulation thread used by --sim-thread
+typedef struct Simulation Simulation;
+
+// Pre-declare the frame profiler
+typedef struct Profiler Profiler;
+
+// Pre-declare the subdomain of an --mpi rank
+typedef struct MpiDomain MpiDomain;
+
+// Pre-declare the counters of a compute thread and the metrics they feed
+typedef struct ThreadCounters ThreadCounters;
+typedef struct Metrics Metrics;
+
+// Declare the job type run by each worker on its band of rows, see worker_pool_band
+typedef void (*WorkerJobFunc)(GameContainer *, Uint32 band);
+
+/**
+ * Worker thread argument
+ */
+typedef struct ThreadArg
+{
+    WorkerPool * pool;                  // The pool the worker belongs to
+    Uint32 i;                           // Worker indice, gives its band of rows
+    pthread_t thread;
+} ThreadArg;
+
+/**
+ * Fixed set of threads created once at startup. The caller releases the
+ * workers with a barrier, works on the first band itself, then waits on a
+ * second barrier for everybody to finish.
+ */
+struct WorkerPool
+{
+    Uint32 count;                       // Number of bands, the caller included
+    ThreadArg * workers;                // count - 1 threads
+    pthread_barrier_t start;            // Everybody got the job
+    pthread_barrier_t done;             // Everybody finished the job
+    WorkerJobFunc job;                  // The job of the current round
+    GameContainer * game;               // The game of the current round
+    Uint32 rows;                        // Number of rows to split between the bands
+    int quit;                           // Flag to stop the workers
+};
+
 // Declare the draw function type
-typedef void (*DrawBoardFunc)(GameContainer);
+typedef void (*DrawBoardFunc)(GameContainer *);
 
 // Declare the compute function type
-typedef void (*ComputeBoardFunc)(int **, int **);
+// Declare the compute function type. It reads the current generation and
+// writes a later one, the caller then swaps them (see game_step). It returns
+// how many generations it went through.
+typedef Uint32 (*ComputeBoardFunc)(GameContainer *);
+
+// Declare the row kernel type: compute one row of the next generation
+typedef void (*ComputeRowFunc)(const Board *, Board *, const Uint32);
 
 /**
  * Game structure.
@@ -59,17 +220,81 @@ struct GameContainer
     Button * stopBtn;                   // Stop button
     Button * resetBtn;                  // Reset button
     TTF_Font * defaultFont;             // The default font mainly for the FPS. 
-    SDL_Surface * whiteSquare;          // Don't need to recreate the white square on each loop.
+    Overlay * overlay;                  // Pre-rendered glyphs of the FPS and timings
     DrawBoardFunc drawBoardFunc;
     ComputeBoardFunc computeBoardFunc;
-    void (*compute_board_func)(int **, int **);
-    int ** board;                       // The real board
-    int ** temp;                        // The temporary board for computation
+    ComputeRowFunc computeRowFunc;      // Row kernel picked for this CPU (see simd_select)
+    Board boards[3];                    // Front and back buffers, swapped after each generation (the third one is for --sim-thread)
+    int current;                        // Indice of the buffer holding the current generation
+    int next;                           // Indice of the buffer receiving the next generation
+    Arena * arena;                      // Holds the boards, the tile map and the scratch tiles (see Arena)
+    Uint32 width;                       // Board width requested on the command line
+    Uint32 height;                      // Board height requested on the command line
+    Uint32 tileSize;                    // Size in pixels of a cell on the screen
+    Uint32 cellsPerPixel;               // Cells per pixel side when zoomed out (a power of 2, tileSize is 1 then)
     int quit;                           // Flag to know if the game continue (1) or not (0)
     int playing;                        // Flah to know if the game is running (1) or not (0)
     int useOpenGL;
+    BoardFormat format;                 // Storage required by the compute function
+    Uint64 generation;                  // Number of generations computed since the start
+    Uint32 blockWidth;                  // Width in cells of a tile of the tiled scheduler
+    Uint32 blockHeight;                 // Height in cells of a tile of the tiled scheduler
+    Uint32 temporalDepth;               // Generations per sweep of the temporal blocking
+    Uint8 * scratch;                    // Two scratch tiles per thread of the temporal blocking, in the arena
+    size_t scratchSize;
+    WorkerPool * pool;                  // Persistent threads of --thread
+    Uint8 * changedTiles;               // One flag per tile: did it change during the last generation
+    Uint32 * activeList;                // Tiles computed by the current generation
+    Uint32 activeCount;                 // Number of tiles in activeList
+    Uint32 tilesX;                      // Size of the tile map
+    Uint32 tilesY;
+    int activityReset;                  // The board was edited: every tile must be computed again
+    int partialDraw;                    // The draw function only repaints the changed tiles
+    int redrawAll;                      // The whole screen must be repainted anyway
+    GpuLife * gpu;                      // Textures and shaders of --opengl
+    int simulationThread;               // Compute on a thread of its own (--sim-thread)
+    double targetRate;                  // Generations per second of that thread, 0 for as fast as possible
+    Simulation * simulation;
+    Profiler * profiler;                // Per-phase timings of the last frames
+    const char * profileCsv;            // Where to dump them on exit (--profile-csv)
+    const char * profileTrace;          // Same in the Chrome trace format (--profile-trace)
+    Uint64 * tileHashes;                // Hash of each 64x64 tile of the current board (see game_hash)
+    Uint64 boardHash;                   // Their sum
+    Uint64 hashGeneration;              // Generation they were computed for
+    int hashValid;                      // No once the board was edited
+    const char * loadPath;              // Pattern or snapshot to start from (--load)
+    const char * savePath;              // Where the board is saved (--save)
+    Uint8 * ages;                       // Generations rules: state of each dying cell (2 to states - 1), 0 otherwise
+    Uint32 * ruleSums;                  // Row sums of board_compute_extended, a ring per thread
+    Topology topology;                  // What lies beyond the edges (--topology)
+    MpiDomain * mpi;                    // Subdomain of this rank (--mpi), the board is only that part
+    int checkAllocations;               // Fail the headless run if a generation past the first one allocates
+    Metrics * metrics;                  // Served by --metrics, NULL without it
+    ThreadCounters * counters;          // One per thread, added to by the kernels when there are metrics
+    Uint32 counterCount;
+    int countPopulation;                // The kernels count the population of this generation for the counters
+    Uint32 * tilePopulation;            // Living cells of each tile of the tile map, kept by --active for the counters
+    Sint64 population;                  // Living cells of the current board, as last counted for the metrics
 };
 
+/**
+ * Get the board holding the current generation
+ * @param game
+ */
+static inline Board * game_board(const GameContainer * game)
+{
+    return (Board *)&game->boards[game->current];
+}
+
+/**
+ * Get the board receiving the next generation
+ * @param game
+ */
+static inline Board * game_next_board(const GameContainer * game)
+{
+    return (Board *)&game->boards[game->next];
+}
+
 
 /** Create the button 
  * @param defaultFont The preloaded font
@@ -156,543 +381,10482 @@ static void button_draw(Button * btn, SDL_Surface * dest)
     SDL_BlitSurface(btn->surf[btn->active], NULL, dest, &(btn->position));
 }
 
-/** Compute the board without multi-threading (traditional way)
- * @param board An array  on which the computation is done
- * @param temp An array on which the result are set
- * @param height The vertical indice of the board
+/**
+ * Clear the whole block, halo included. The rows are cleared by the threads
+ * which will compute them (same static split as the tiled scheduler), so on
+ * NUMA hosts the pages land on the socket owning those rows (first touch).
+ * @param board
  */
-static void board_compute_thread(int ** board, int ** temp, const int height)
+static void board_first_touch(Board * board)
 {
-    register Uint32 count = 0;
-    register Uint32 width = 0;
+    int y;
+    const int height = (int)board->height;
 
-    for(width=0; width < kBoardWidth; width++)
+    #pragma omp parallel for schedule(static)
+    for (y = -1; y <= height; y++)
     {
-        // Count how many cell are alive around
-        count = 0;
-
-        if (height)
-        {
-            // Top left
-            if (width)
-            {
-                count += board[height-1][width-1];
-            }
+        memset(board->cells - kBoardAlignment + (ptrdiff_t)y * board->stride, 0, board->stride);
+    }
+}
 
-            // Top center
-            count += board[height-1][width];
+/**
+ * Distance in bytes between two rows of a board
+ * @param width Number of cells per row
+ * @param format Byte or bit storage
+ */
+static Uint32 board_stride(Uint32 width, BoardFormat format)
+{
+    const Uint32 rowBytes = format == BOARD_PACKED ? (width + 63) / 64 * sizeof(Uint64) : width;
 
-            // Top right
-            if (width < kMaxWidth)
-            {
-                count += board[height-1][width+1];
-            }
-        }
+    // A full alignment unit on the left keeps the first playable cell aligned,
+    // at least one cell (one word when packed) remains on the right for the halo.
+    return kBoardAlignment + ((rowBytes + sizeof(Uint64) + kBoardAlignment - 1) / kBoardAlignment) * kBoardAlignment;
+}
 
-        // center left
-        if (width)
-        {
-            count += board[height][width-1];
-        }
+/**
+ * Size of the block of a board, halo rows included
+ * @param width Number of cells per row
+ * @param height Number of rows
+ * @param format Byte or bit storage
+ */
+static size_t board_size(Uint32 width, Uint32 height, BoardFormat format)
+{
+    // One halo row above and one below
+    return (size_t)board_stride(width, format) * (height + 2);
+}
 
-        // center right
-        if (width < kMaxWidth)
-        {
-            count += board[height][width+1];
-        }
+/**
+ * Lay a board out in a block of board_size bytes, aligned on kBoardAlignment.
+ * The cells are left as they are.
+ * @param board The board to fill
+ * @param width Number of cells per row
+ * @param height Number of rows
+ * @param format Byte or bit storage
+ * @param memory The block, owned by the caller
+ */
+static void board_init(Board * board, Uint32 width, Uint32 height, BoardFormat format, Uint8 * memory)
+{
+    board->width = width;
+    board->height = height;
+    board->format = format;
+    board->words = (width + 63) / 64;
+    board->stride = board_stride(width, format);
+    board->mapped = 0;
+    board->pooled = Yes;
+    board->memory = memory;
+    board->cells = board->memory + board->stride + kBoardAlignment;
+}
 
-        if (height < kMaxHeight)
-        {
-            // bottom left
-            if (width)
-            {
-                count += board[height+1][width-1];
-            }
+/**
+ * Allocate a board. The rows are padded so each one starts on a cache line
+ * and the whole generation is a single block.
+ * @param board The board to fill
+ * @param width Number of cells per row
+ * @param height Number of rows
+ * @param format Byte or bit storage
+ * @return 0 on success, -1 if the memory is not available
+ */
+static int board_create(Board * board, Uint32 width, Uint32 height, BoardFormat format)
+{
+    Uint8 * memory;
 
-            // bottom center
-            count += board[height+1][width];
+    if (posix_memalign((void **)&memory, kBoardAlignment, board_size(width, height, format)))
+    {
+        board->memory = NULL;
+        board->cells = NULL;
+        return -1;
+    }
 
-            // bottom right
-            if (width < kMaxWidth)
-            {
-                count += board[height+1][width+1];
-            }
-        }
+    board_init(board, width, height, format, memory);
+    board->pooled = No;
+    board_first_touch(board);
 
-        // If the cell is dead and there's 3 neighbour alive. The cell become alive
-        if (board[height][width] == 0 && count == 3)
-        {
-            temp[height][width] = 1;
-        }
-        // If the cell is alive and it have 2 or 3 cell alive around, it stay alive
-        else if (board[height][width] == 1 && (count == 2 || count == 3))
-        {
-            temp[height][width] = 1;
-        }
-        // Otherwise, it's dead.
-        else
-        {
-            temp[height][width] = 0;
-        }
-    }
+    return 0;
 }
 
 /**
- * Do the computation
+ * Release the board memory
  * @param board
- * @param temp
  */
-static void board_compute(int ** board, int ** temp)
+static void board_dispose(Board * board)
 {
-    register Uint32 i,j;
-    
-    for(i=0; i < kBoardHeight; i++)
+    if (board->mapped)
     {
-        board_compute_thread(board, temp, i);
+        munmap(board->memory, board->mapped);
+        board->mapped = 0;
     }
-    
-    // Copy the temp board to the new
-    for(i=0; i < kBoardHeight ; i++)
+    else if ( ! board->pooled)
     {
-        for(j=0; j < kBoardWidth ; j++)
-        {
-            board[i][j] = temp[i][j];
-        }
+        free(board->memory);
     }
+    board->memory = NULL;
+    board->cells = NULL;
 }
 
-/**
- * Do the computation with OpenMP
- * @param board
- * @param temp
+#if defined(__GLIBC__) && ! defined(__SANITIZE_ADDRESS__)
+#define COUNT_ALLOCATIONS
+
+static Uint64 gAllocations = 0;         // Heap allocations of the whole process, libraries included
+
+extern void * __libc_malloc(size_t size);
+extern void * __libc_calloc(size_t count, size_t size);
+extern void * __libc_realloc(void * pointer, size_t size);
+extern void * __libc_memalign(size_t alignment, size_t size);
+
+/*
+ * The allocation functions of glibc are replaced by counting ones, which
+ * forward to the glibc allocator. The allocations of SDL, OpenGL or OpenMP
+ * are counted too: a frame or a generation which allocates anything shows.
  */
-static void board_compute_openmp(int ** board, int ** temp)
+void * malloc(size_t size)
 {
-    register Uint32 i,j;
-    
-    // COmptute the board with the maximum possible core
-    #pragma omp parallel for private(i) shared(board, temp)
-    for(i=0; i < kBoardHeight; i++)
-    {
-        board_compute_thread(board, temp, i);
-    }
-    
-    // Copy the temp board to the new
-    for(i=0; i < kBoardHeight ; i++)
+    __atomic_add_fetch(&gAllocations, 1, __ATOMIC_RELAXED);
+    return __libc_malloc(size);
+}
+
+void * calloc(size_t count, size_t size)
+{
+    __atomic_add_fetch(&gAllocations, 1, __ATOMIC_RELAXED);
+    return __libc_calloc(count, size);
+}
+
+void * realloc(void * pointer, size_t size)
+{
+    __atomic_add_fetch(&gAllocations, 1, __ATOMIC_RELAXED);
+    return __libc_realloc(pointer, size);
+}
+
+void * memalign(size_t alignment, size_t size)
+{
+    __atomic_add_fetch(&gAllocations, 1, __ATOMIC_RELAXED);
+    return __libc_memalign(alignment, size);
+}
+
+void * aligned_alloc(size_t alignment, size_t size)
+{
+    return memalign(alignment, size);
+}
+
+int posix_memalign(void ** pointer, size_t alignment, size_t size)
+{
+    if (alignment % sizeof(void *) || (alignment & (alignment - 1)))
     {
-        #pragma omp parallel for private(j) shared(board,temp)
-        for(j=0; j < kBoardWidth ; j++)
-        {
-            board[i][j] = temp[i][j];
-        }
+        return EINVAL;
     }
-    // Ensure all threads are finished
-    #pragma omp barrier
+    *pointer = memalign(alignment, size);
+    return *pointer || ! size ? 0 : ENOMEM;
 }
+#endif
 
 /**
- * Clear the board and the temp board (respond to a click on "Reset Button")
- * @param game
+ * Number of heap allocations since the start of the process
+ * @return 0 when they can't be counted (not glibc, or a sanitizer owns them)
  */
-static void board_reset(GameContainer * game)
+static inline Uint64 heap_allocations(void)
 {
-    register Uint32 i,j;
-    
-    for (i = 0; i < kBoardHeight; i++) 
-    {
-        for (j = 0; j < kBoardWidth; j++ )
-        {
-            game->board[i][j] = 0;
-            game->temp[i][j] = 0;
-        }
-    }
+#ifdef COUNT_ALLOCATIONS
+    return __atomic_load_n(&gAllocations, __ATOMIC_RELAXED);
+#else
+    return 0;
+#endif
 }
 
+const Uint32 kArenaBlock = 1 << 20;     // Smallest block added to a full arena
+
 /**
- * Initialize the game board.
- * @param game
+ * A block of an arena, its room follows the header
  */
-static void initialize_game(GameContainer * game)
+typedef struct ArenaBlock
 {
-    register Uint32 i;
-     
-    
-    // Store the video surface. We don't have to call this routine each time
-    game->screen = SDL_GetVideoSurface();
-    
-    // Clean up default vars
-    game->useOpenGL = No;
-    game->playing = No;
-    game->quit = No;
-    
-    // Get the font
-    game->defaultFont = TTF_OpenFont("FreeSans.ttf", 16);
-    
-    // Create Start button
-    game->startBtn = button_create(game->defaultFont, "Start");
-    button_set_position(game->startBtn, 5, 5);
-    button_set_active(game->startBtn, 1);
-    
-    // Create Stop button
-    game->stopBtn  = button_create(game->defaultFont, "Stop");
-    button_set_position(game->stopBtn, game->startBtn->surf[INACTIVE]->clip_rect.w + 10, 5);
-    button_set_active(game->stopBtn, 0);
-    
-    // Create Reset button
-    game->resetBtn = button_create(game->defaultFont, "Reset");        
-    button_set_position(game->resetBtn, game->startBtn->surf[INACTIVE]->clip_rect.w + game->stopBtn->surf[INACTIVE]->clip_rect.w + 15, 5);
-    button_set_active(game->resetBtn, 1);
-        
-    // Create the two boards. 
-    game->board  = malloc(sizeof(int*) * kBoardHeight );
-    game->temp   = malloc(sizeof(int*) * kBoardHeight );
-    for(i = 0; i < kBoardHeight; i++)
-    {
-        game->board[i] = (int*)malloc(sizeof(int) * kBoardWidth);
-        game->temp[i] = (int*)malloc(sizeof(int) * kBoardWidth);
-    }
-    
-    // Create the white square. Don't need to create it on each loop
-    game->whiteSquare = SDL_CreateRGBSurface(SDL_SWSURFACE, kTileSize, kTileSize, 32, 0, 0, 0, 0);
-    SDL_FillRect(game->whiteSquare, NULL, 0xFFFFFF);
-    
-    // Clear both board
-    board_reset(game);
+    struct ArenaBlock * next;           // The block carved before this one
+    size_t size;                        // Room of the block
+    size_t used;                        // Already handed out
+} ArenaBlock;
+
+/**
+ * Storage of a simulation: the boards, the tile map and the scratch tiles
+ * are carved out of one block allocated with the boards, and all go away
+ * with it. Nothing is freed on its own. What can't be sized up front (the
+ * scratch tiles of a deeper sweep...) goes to an extra block, so once every
+ * part was carved a generation allocates nothing.
+ */
+struct Arena
+{
+    ArenaBlock * blocks;                // The block being carved, the older ones follow
+    size_t size;                        // Room of all the blocks
+    size_t used;                        // Handed out of all the blocks
+};
+
+/**
+ * Round a size up to the alignment of the arena
+ * @param size
+ */
+static inline size_t arena_round(size_t size)
+{
+    return (size + kBoardAlignment - 1) / kBoardAlignment * kBoardAlignment;
 }
 
 /**
- * Be nice with the system on exiting (Old MacOS classic habit)
- * @param game
+ * Add a block to an arena
+ * @param arena
+ * @param size Room of the block
+ * @return 0 on success, -1 if the memory is not available
  */
-static void dispose_game(GameContainer * game)
+static int arena_grow(Arena * arena, size_t size)
 {
-    Uint32 i;
-    for(i = 0; i < kBoardHeight; i++)
+    ArenaBlock * block;
+
+    // The header takes a whole alignment unit, the room stays aligned
+    if (posix_memalign((void **)&block, kBoardAlignment, kBoardAlignment + size))
     {
-        free(game->board[i]);
-        free(game->temp[i]);
+        return -1;
     }
-    SDL_FreeSurface(game->whiteSquare);
-    TTF_CloseFont(game->defaultFont);
-    button_dispose(game->startBtn);
-    button_dispose(game->stopBtn);
-    button_dispose(game->resetBtn);
+    block->next = arena->blocks;
+    block->size = size;
+    block->used = 0;
+    arena->blocks = block;
+    arena->size += size;
+    return 0;
 }
 
 /**
- * Draw the board in usual way
- * @param game
+ * Create an arena with its first block
+ * @param size Room of the first block: what the simulation is known to need
+ * @return NULL if the memory is not available
  */
-static void draw_board(GameContainer game)
+static Arena * arena_create(size_t size)
 {
-    register Uint32 i,j;
-    
-    for (i = 0; i < kBoardHeight; i++) 
+    Arena * arena = (Arena *)calloc(1, sizeof(Arena));
+
+    if (arena && arena_grow(arena, arena_round(size)))
     {
-        for (j = 0; j < kBoardWidth; j++ )
-        {
-            SDL_Rect square = { 0, 0, kTileSize, kTileSize };
-            if ( ! game.board[i][j])
-                continue;
-            square.y = i * kTileSize;
-            square.x = j * kTileSize;
-            SDL_BlitSurface(game.whiteSquare, NULL, game.screen, &square);
-        }
+        free(arena);
+        return NULL;
     }
+    return arena;
 }
 
 /**
- * Draw the board with OpenMP. As the "sprite" may not be displayed at the same place,
- * yes it's possible. 
- * @param game
+ * Carve a part out of an arena. It starts on a cache line and is not
+ * cleared: the pages of a new block are not touched yet, the first thread
+ * writing them gets them.
+ * @param arena
+ * @param size
+ * @return NULL if the memory is not available
  */
-static void draw_board_openmp(GameContainer game)
+static void * arena_alloc(Arena * arena, size_t size)
 {
-    register Uint32 i,j;
-    int ** board = game.board;
-    SDL_Surface * surf = game.screen;
-    SDL_Rect square = { 0, 0, kTileSize, kTileSize };
-    
-    for (i = 0; i < kBoardHeight; i++) 
+    ArenaBlock * block = arena->blocks;
+    void * part;
+
+    size = arena_round(size);
+    if ( ! block || block->size - block->used < size)
     {
-        #pragma omp parallel for private(j) shared(board,surf,square)
-        for (j = 0; j < kBoardWidth; j++ )
+        if (arena_grow(arena, size > kArenaBlock ? size : kArenaBlock))
         {
-            if ( ! board[i][j])
-                continue;
-            square.y = i * kTileSize;
-            square.x = j * kTileSize;
-            SDL_BlitSurface(game.whiteSquare, NULL, surf, &square);
+            return NULL;
         }
+        block = arena->blocks;
     }
-    #pragma omp barrier
+    part = (Uint8 *)block + kBoardAlignment + block->used;
+    block->used += size;
+    arena->used += size;
+    return part;
 }
 
-typedef struct ThreadArg
-{
-    GameContainer * game;
-    Uint32 i;
-} ThreadArg;
-
-static void draw_thread(ThreadArg * arg)
+/**
+ * Carve a board out of an arena, cleared by board_first_touch
+ * @param arena
+ * @param board The board to fill
+ * @param width Number of cells per row
+ * @param height Number of rows
+ * @param format Byte or bit storage
+ * @return 0 on success, -1 if the memory is not available
+ */
+static int arena_board(Arena * arena, Board * board, Uint32 width, Uint32 height, BoardFormat format)
 {
-    register Uint32 j;
-    SDL_Rect square = { 0, 0, kTileSize, kTileSize };
+    Uint8 * memory = (Uint8 *)arena_alloc(arena, board_size(width, height, format));
 
-    for (j = 0; j < kBoardWidth; j++)
+    if ( ! memory)
     {
-        if ( ! arg->game->board[arg->i][j]) 
-        {
-            continue;
-        }
-        square.y = arg->i * kTileSize;
-        square.x = j * kTileSize;
-        SDL_BlitSurface(arg->game->whiteSquare, NULL, arg->game->screen, &square);
+        board->memory = NULL;
+        board->cells = NULL;
+        return -1;
     }
+    board_init(board, width, height, format, memory);
+    board_first_touch(board);
+    return 0;
 }
 
-static void draw_board_multithread(GameContainer game)
+/**
+ * Release an arena and everything carved out of it
+ * @param arena
+ */
+static void arena_dispose(Arena * arena)
 {
-    register Uint32 i;
-    
-    for (i = 0; i < kBoardHeight; i++) 
+    while (arena && arena->blocks)
     {
-    }    
+        ArenaBlock * block = arena->blocks;
+        arena->blocks = block->next;
+        free(block);
+    }
+    free(arena);
 }
 
-
 /**
- * Draw the FPS on the screen. We lost are 10 fps to do that but it's useful I think :)
- * @param screen
- * @param defaultFont
- * @param fps
+ * Get a row of the board. -1 and height are the halo rows.
+ * @param board
+ * @param y The row indice
+ * @return The first playable cell of the row
  */
-static void draw_fps(SDL_Surface * screen, TTF_Font * defaultFont, Uint32 fps)
+static inline Uint8 * board_row(const Board * board, int y)
 {
-    SDL_Surface * surf;
-    char str[50];
-    SDL_Rect pos = { 0, 10, 0, 0 };
-    
-    sprintf(str, "%u fps", fps);
-    surf = TTF_RenderText_Blended(defaultFont, str, kWhite);
-    pos.x = kBoardWidth * kTileSize - surf->clip_rect.w  - 10;
-    SDL_BlitSurface(surf, NULL, screen, &pos);
-    SDL_FreeSurface(surf);
+    return board->cells + (ptrdiff_t)y * board->stride;
 }
 
-static void draw_time(SDL_Surface * screen, TTF_Font * font,const char * title, const suseconds_t  time, const int posY)
+/**
+ * Get a packed row of the board. -1 and words are the halo words.
+ * @param board
+ * @param y The row indice
+ * @return The first playable word of the row
+ */
+static inline Uint64 * board_packed_row(const Board * board, int y)
 {
-    SDL_Surface * surf;
-    char str[50];
-    SDL_Rect pos = { 0, posY, 0, 0 };
-    
-    sprintf(str, "%s %d microsec", title, (long int)time);
-    surf = TTF_RenderText_Blended(font, str, kWhite);
-    pos.x = kBoardWidth * kTileSize - surf->clip_rect.w  - 10;
-    SDL_BlitSurface(surf, NULL, screen, &pos);
-    SDL_FreeSurface(surf);
+    return (Uint64 *)board_row(board, y);
 }
 
 /**
- * Get Microseconds because SDL_GetTicks have not enought granulosity
+ * Number of bytes holding the playable part of a row
+ * @param board
  */
-static suseconds_t get_usec(void)
+static inline Uint32 board_row_bytes(const Board * board)
 {
-    struct timeval tv;
-    gettimeofday(&tv, NULL);
-    return tv.tv_usec;
+    return board->format == BOARD_PACKED ? board->words * sizeof(Uint64) : board->width;
 }
 
 /**
- * Process the main loop
- * @param game
+ * Read a cell whatever the storage is
+ * @param board
+ * @param x
+ * @param y
+ * @return 1 if alive, 0 otherwise
  */
-static void do_main_loop(GameContainer game)
+static inline Uint8 board_get_cell(const Board * board, Uint32 x, Uint32 y)
 {
-    SDL_Event evt;
-    char mouseButtonDown = 0;
-    unsigned long frame = 0;
-    Uint32 ticks = 0, start = 0, result = 0;
-    suseconds_t drawTime = 0;
-    suseconds_t avgDraw = 0, avgCompute = 0;
-    
-    memset(&evt, 0, sizeof(SDL_Event));
+    if (board->format == BOARD_PACKED)
+    {
+        return (board_packed_row(board, y)[x >> 6] >> (x & 63)) & 1;
+    }
+    return board_row(board, y)[x];
+}
 
-    start = SDL_GetTicks();
-    
-    while ( ! game.quit )
+/**
+ * Write a cell whatever the storage is
+ * @param board
+ * @param x
+ * @param y
+ * @param alive 1 to set the cell alive, 0 to kill it
+ */
+static inline void board_set_cell(Board * board, Uint32 x, Uint32 y, Uint8 alive)
+{
+    if (board->format == BOARD_PACKED)
     {
-        ticks = SDL_GetTicks();
-        while (SDL_PollEvent(&evt)) 
-        {
-            game.quit = evt.type == SDL_QUIT;
+        Uint64 * word = &board_packed_row(board, y)[x >> 6];
+        const Uint64 bit = (Uint64)1 << (x & 63);
+        *word = alive ? (*word | bit) : (*word & ~bit);
+    }
+    else
+    {
+        board_row(board, y)[x] = alive;
+    }
+}
+
+/**
+ * Read a cell of the board or of its halo
+ * @param board
+ * @param x -1 to width
+ * @param y -1 to height
+ */
+static inline Uint8 board_get_halo(const Board * board, int x, int y)
+{
+    if (board->format == BOARD_PACKED)
+    {
+        // Shifted by a word so -1 lands on the last bit of the left halo word
+        return (board_packed_row(board, y)[(x + 64) / 64 - 1] >> ((x + 64) & 63)) & 1;
+    }
+    return board_row(board, y)[x];
+}
+
+/**
+ * Write a cell of the board or of its halo
+ * @param board
+ * @param x -1 to width
+ * @param y -1 to height
+ * @param alive
+ */
+static inline void board_set_halo(Board * board, int x, int y, Uint8 alive)
+{
+    if (board->format == BOARD_PACKED)
+    {
+        Uint64 * word = &board_packed_row(board, y)[(x + 64) / 64 - 1];
+        const Uint64 bit = (Uint64)1 << ((x + 64) & 63);
+        *word = alive ? (*word | bit) : (*word & ~bit);
+    }
+    else
+    {
+        board_row(board, y)[x] = alive;
+    }
+}
+
+/**
+ * Fill the halo with what lies beyond the edges, before a generation is
+ * computed from the board. The kernels read their missing neighbours from
+ * the halo whatever it holds, so they need no wrap test of their own: the
+ * cost is a copy of the border per generation. A packed board uses the bits
+ * after its last cell as the right halo, they are cleared again when the
+ * next generation masks its tail.
+ * @param board
+ * @param topology
+ */
+static void board_fill_halo(Board * board, Topology topology)
+{
+    const int width = (int)board->width;
+    const int height = (int)board->height;
+    int x, y;
+
+    if (topology == TOPOLOGY_DEAD)
+    {
+        return;
+    }
+
+    // The columns first: the halo rows then bring the corners with them
+    for (y = 0; y < height; y++)
+    {
+        board_set_halo(board, -1, y, topology == TOPOLOGY_ALIVE || board_get_halo(board, width - 1, y));
+        board_set_halo(board, width, y, topology == TOPOLOGY_ALIVE || board_get_halo(board, 0, y));
+    }
+
+    if (topology == TOPOLOGY_TORUS)
+    {
+        // The whole row, halo cells included
+        const size_t offset = board->format == BOARD_PACKED ? sizeof(Uint64) : 1;
+        const size_t bytes = board->format == BOARD_PACKED ? (board->words + 2) * sizeof(Uint64) : (size_t)width + 2;
+        memcpy(board_row(board, -1) - offset, board_row(board, height - 1) - offset, bytes);
+        memcpy(board_row(board, height) - offset, board_row(board, 0) - offset, bytes);
+        return;
+    }
+    for (x = -1; x <= width; x++)
+    {
+        if (topology == TOPOLOGY_ALIVE)
+        {
+            board_set_halo(board, x, -1, 1);
+            board_set_halo(board, x, height, 1);
+        }
+        else
+        {
+            // Klein bottle: going through the top or the bottom mirrors the row
+            board_set_halo(board, x, -1, board_get_halo(board, width - 1 - x, height - 1));
+            board_set_halo(board, x, height, board_get_halo(board, width - 1 - x, 0));
+        }
+    }
+}
+
+/**
+ * Small and fast pseudo random generator (xorshift64*), the same seed
+ * always gives the same board whatever the libc is.
+ * @param state The generator state, never 0
+ * @return 64 random bits
+ */
+static inline Uint64 random_next(Uint64 * state)
+{
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+    return *state * 0x2545F4914F6CDD1DULL;
+}
+
+/**
+ * Fill the board with random cells
+ * @param board
+ * @param seed The generator seed
+ * @param density Percentage of living cells
+ */
+static void board_randomize(Board * board, Uint64 seed, Uint32 density)
+{
+    register Uint32 x, y;
+    Uint64 state = seed * 0x9E3779B97F4A7C15ULL + 1;
+    const Uint64 threshold = (Uint64)density * (0xFFFFFFFFULL / 100);
+
+    for (y = 0; y < board->height; y++)
+    {
+        for (x = 0; x < board->width; x++)
+        {
+            board_set_cell(board, x, y, (random_next(&state) >> 32) < threshold);
+        }
+    }
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+/**
+ * Count the bits of words with the popcnt instruction
+ */
+__attribute__((target("popcnt")))
+static Uint64 words_population_popcnt(const Uint64 * words, Uint32 count)
+{
+    Uint64 population = 0;
+    Uint32 i;
+
+    for (i = 0; i < count; i++)
+    {
+        population += __builtin_popcountll(words[i]);
+    }
+    return population;
+}
+#endif
+
+/**
+ * Count the bits of words. Without -mpopcnt the builtin is a call per word,
+ * the instruction is used when the CPU has it.
+ * @param words
+ * @param count
+ */
+static inline Uint64 words_population(const Uint64 * words, Uint32 count)
+{
+    Uint64 population = 0;
+    Uint32 i;
+
+#if defined(__x86_64__) || defined(__i386__)
+    if (__builtin_cpu_supports("popcnt"))
+    {
+        return words_population_popcnt(words, count);
+    }
+#endif
+    for (i = 0; i < count; i++)
+    {
+        population += __builtin_popcountll(words[i]);
+    }
+    return population;
+}
+
+/**
+ * Count the living cells of a part of a row
+ * @param board
+ * @param y The row
+ * @param x First cell, a multiple of 64 for packed boards
+ * @param width Number of cells, up to the end of the row
+ */
+static inline Uint64 board_span_population(const Board * board, Uint32 y, Uint32 x, Uint32 width)
+{
+    register Uint32 i;
+    Uint64 population = 0;
+
+    if (board->format == BOARD_PACKED)
+    {
+        // The bits past the last cell may hold the halo of a topology
+        const Uint64 * row = board_packed_row(board, y);
+        const Uint32 end = (x + width) / 64;
+        population = words_population(row + x / 64, end - x / 64);
+        if ((x + width) & 63)
+        {
+            population += __builtin_popcountll(row[end] & (((Uint64)1 << ((x + width) & 63)) - 1));
+        }
+    }
+    else
+    {
+        const Uint8 * row = board_row(board, y) + x;
+        for (i = 0; i < width; i++)
+        {
+            population += row[i];
+        }
+    }
+    return population;
+}
+
+/**
+ * Count the living cells of a rectangle, clipped to the board
+ * @param board
+ * @param x First column (a multiple of 64 for packed boards)
+ * @param y First row
+ * @param width
+ * @param height
+ */
+static Uint64 board_rect_population(const Board * board, Uint32 x, Uint32 y, Uint32 width, Uint32 height)
+{
+    register Uint32 row;
+    const Uint32 right = x + width < board->width ? x + width : board->width;
+    const Uint32 bottom = y + height < board->height ? y + height : board->height;
+    Uint64 population = 0;
+
+    for (row = y; row < bottom; row++)
+    {
+        population += board_span_population(board, row, x, right - x);
+    }
+    return population;
+}
+
+/**
+ * Count the living cells
+ * @param board
+ * @return The population
+ */
+static Uint64 board_population(const Board * board)
+{
+    return board_rect_population(board, 0, 0, board->width, board->height);
+}
+
+// Neighbour counts of B3/S23: bit n stands for n living neighbours
+#define LIFE_BIRTH      0x008
+#define LIFE_SURVIVAL   0x00C
+
+// Pre-declare the kernels of a rule
+typedef struct RuleKernels RuleKernels;
+
+/**
+ * The rule of the automaton, as read by rule_parse. Life-like rules (two
+ * states, the eight neighbours) run on every backend, with kernels of their
+ * own for the common ones. Generations (dying states) and Larger than Life
+ * (a wider neighbourhood) run on byte boards only (board_compute_extended).
+ */
+typedef struct Rule
+{
+    char name[64];                      // B.../S... (/C... for Generations), or the Larger than Life notation
+    Uint32 birth;                       // Bit n set: a dead cell with n living neighbours is born
+    Uint32 survival;                    // Bit n set: a living cell with n living neighbours stays alive
+    Uint32 states;                      // 2, more for Generations: a cell which dies goes through states - 2 dying steps
+    Uint32 range;                       // 1 for the eight neighbours, more for Larger than Life
+    int vonNeumann;                     // Larger than Life: diamond neighbourhood instead of a square
+    int countSelf;                      // Larger than Life: a living cell counts itself (M1)
+    Uint32 birthMin, birthMax;          // Larger than Life: counts giving a birth
+    Uint32 survivalMin, survivalMax;    // Larger than Life: counts keeping a cell alive
+    const RuleKernels * kernels;        // Picked by rule_select
+} Rule;
+
+// The rule of the whole run, like the OpenMP schedule. main sets it before
+// anything is computed.
+static Rule gRule;
+
+/**
+ * Tell if a rule needs board_compute_extended
+ * @param rule
+ */
+static inline int rule_is_extended(const Rule * rule)
+{
+    return rule->states > 2 || rule->range > 1 || rule->vonNeumann;
+}
+
+/**
+ * Read the neighbour counts of B/S notation, up to the next '/'
+ * @param str
+ * @param mask Receive a bit per count
+ * @return The character after the counts, NULL if one is not 0 to 8
+ */
+static const char * rule_parse_counts(const char * str, Uint32 * mask)
+{
+    for (; *str && *str != '/'; str++)
+    {
+        if (*str < '0' || *str > '8')
+        {
+            return NULL;
+        }
+        *mask |= 1U << (*str - '0');
+    }
+    return str;
+}
+
+/**
+ * Read a rule: B3/S23 (or the older 23/3), B2/S345/C4 for Generations,
+ * R5,C0,M1,S34..58,B34..45,NM for Larger than Life. A Larger than Life rule
+ * of range 1 on the eight neighbours is stored as the Life-like rule it is.
+ * @param str
+ * @param rule Receive the rule, its kernels are not picked (see rule_select)
+ * @return Yes if the rule is valid, No otherwise
+ */
+static int rule_parse(const char * str, Rule * rule)
+{
+    memset(rule, 0, sizeof(Rule));
+    rule->states = 2;
+    rule->range = 1;
+
+    if (*str == 'R' || *str == 'r')
+    {
+        unsigned int range, states, self, sMin, sMax, bMin, bMax;
+        char neighbourhood;
+        int length = 0;
+        Uint32 n;
+
+        if (sscanf(str + 1, "%u,C%u,M%u,S%u..%u,B%u..%u,N%c%n", &range, &states, &self, &sMin, &sMax, &bMin, &bMax, &neighbourhood, &length) != 8 ||
+            str[1 + length] || ! range || range > kMaxRuleRange || states > 256 || self > 1 || ! bMin || sMin > sMax || bMin > bMax ||
+            (neighbourhood != 'M' && neighbourhood != 'N'))
+        {
+            return No;
+        }
+        rule->range = range;
+        rule->states = states < 2 ? 2 : states;
+        rule->countSelf = self;
+        rule->vonNeumann = neighbourhood == 'N';
+        rule->survivalMin = sMin;
+        rule->survivalMax = sMax;
+        rule->birthMin = bMin;
+        rule->birthMax = bMax;
+        snprintf(rule->name, sizeof(rule->name), "R%u,C%u,M%u,S%u..%u,B%u..%u,N%c", range, states, self, sMin, sMax, bMin, bMax, neighbourhood);
+        if (range == 1 && ! rule->vonNeumann)
+        {
+            for (n = 0; n <= 8; n++)
+            {
+                rule->birth |= (Uint32)(n >= bMin && n <= bMax) << n;
+                rule->survival |= (Uint32)(n + self >= sMin && n + self <= sMax) << n;
+            }
+            rule->countSelf = No;
+        }
+        return Yes;
+    }
+    else
+    {
+        // B/S/C with letters, in any order, or S/B/C without
+        const int letters = strpbrk(str, "BbSs") != NULL;
+        Uint32 part;
+        char birth[16], survival[16];
+        Uint32 b = 0, s = 0, n;
+
+        for (part = 0; part < 3 && str; part++)
+        {
+            const char tag = letters ? (char)toupper((unsigned char)*str) : "SBC"[part];
+            if (letters && tag != 'B' && tag != 'S' && tag != 'C')
+            {
+                return No;
+            }
+            str += letters;
+            if (tag == 'C')
+            {
+                char * end;
+                const unsigned long states = strtoul(str, &end, 10);
+                if (end == str || (*end && *end != '/') || states < 2 || states > 256)
+                {
+                    return No;
+                }
+                rule->states = (Uint32)states;
+                str = end;
+            }
+            else
+            {
+                str = rule_parse_counts(str, tag == 'B' ? &rule->birth : &rule->survival);
+            }
+            if ( ! str || ! *str)
+            {
+                break;
+            }
+            str++;
+        }
+        // B0 would light up the whole dead halo
+        if ( ! str || *str || (rule->birth & 1))
+        {
+            return No;
+        }
+        for (n = 0; n <= 8; n++)
+        {
+            if ((rule->birth >> n) & 1)
+            {
+                birth[b++] = (char)('0' + n);
+            }
+            if ((rule->survival >> n) & 1)
+            {
+                survival[s++] = (char)('0' + n);
+            }
+        }
+        birth[b] = 0;
+        survival[s] = 0;
+        if (rule->states > 2)
+        {
+            snprintf(rule->name, sizeof(rule->name), "B%s/S%s/C%u", birth, survival, rule->states);
+        }
+        else
+        {
+            snprintf(rule->name, sizeof(rule->name), "B%s/S%s", birth, survival);
+        }
+        return Yes;
+    }
+}
+
+/**
+ * Tell if two rules compute the same thing, whatever their notation is
+ * @param a
+ * @param b
+ */
+static int rule_equal(const Rule * a, const Rule * b)
+{
+    return a->birth == b->birth && a->survival == b->survival && a->states == b->states && a->range == b->range &&
+           a->vonNeumann == b->vonNeumann && a->countSelf == b->countSelf &&
+           a->birthMin == b->birthMin && a->birthMax == b->birthMax &&
+           a->survivalMin == b->survivalMin && a->survivalMax == b->survivalMax;
+}
+
+/** Compute a span of cells of a row
+ * The dead halo around the board stands for the outside world, so border
+ * cells read their missing neighbours from it and every cell takes the same
+ * path: the loop has no test and the compiler is free to vectorize it.
+ * Always inlined with constant masks, the rule test folds into the kernel of
+ * that rule (see RULE_SPECIALIZATIONS).
+ * @param above The row above
+ * @param current The row being computed
+ * @param below The row below
+ * @param result The row receiving the next generation
+ * @param from First cell
+ * @param to Last cell (excluded)
+ * @param birth, survival The rule (see Rule)
+ */
+__attribute__((always_inline))
+static inline void board_compute_span_rule(const Uint8 * restrict above, const Uint8 * restrict current,
+                                           const Uint8 * restrict below, Uint8 * restrict result, int from, int to,
+                                           const Uint32 birth, const Uint32 survival)
+{
+    register int width;   // Signed: width - 1 reaches the left halo
+
+    for(width=from; width < to; width++)
+    {
+        // Count how many cell are alive around. The halo is always dead.
+        const Uint8 count = above[width-1] + above[width] + above[width+1]
+                          + current[width-1]              + current[width+1]
+                          + below[width-1] + below[width] + below[width+1];
+
+        if (birth == LIFE_BIRTH && survival == LIFE_SURVIVAL)
+        {
+            // A dead cell with 3 neighbours is born, a living one with 2 or 3 stays alive.
+            // Or-ing the cell state folds both cases into a single comparison.
+            result[width] = (count | current[width]) == 3;
+        }
+        else
+        {
+            result[width] = ((current[width] ? survival : birth) >> count) & 1;
+        }
+    }
+}
+
+// Word operations used to instantiate LIFE_ADDER on plain Uint64
+#define WORD_XOR(x, y)      ((x) ^ (y))
+#define WORD_AND(x, y)      ((x) & (y))
+#define WORD_OR(x, y)       ((x) | (y))
+#define WORD_ANDNOT(x, y)   (~(x) & (y))
+
+/**
+ * B3/S23 on bit planes, whatever the word type is (Uint64 or a SIMD register).
+ * The eight neighbours are added with full adders, so each bit of the result
+ * is a cell and no cell is looked at on its own. ANDNOT(x, y) is ~x & y.
+ */
+#define LIFE_ADDER(T, XOR, AND, OR, ANDNOT, aL, a, aR, cL, c, cR, bL, b, bR, result)               \
+    do                                                                                          \
+    {                                                                                           \
+        /* Each line gives a 2 bits count (the middle one does not count the cell itself) */   \
+        const T aOnes_ = XOR(XOR(aL, a), aR);                                                   \
+        const T aTwos_ = OR(AND(aL, a), AND(aR, XOR(aL, a)));                                   \
+        const T bOnes_ = XOR(XOR(bL, b), bR);                                                   \
+        const T bTwos_ = OR(AND(bL, b), AND(bR, XOR(bL, b)));                                   \
+        const T cOnes_ = XOR(cL, cR);                                                           \
+        const T cTwos_ = AND(cL, cR);                                                           \
+        /* Add the ones together, the carry goes with the twos */                              \
+        const T ones_ = XOR(XOR(aOnes_, bOnes_), cOnes_);                                       \
+        const T carry_ = OR(AND(aOnes_, bOnes_), AND(cOnes_, XOR(aOnes_, bOnes_)));             \
+        /* Exactly one "two" among the four means a total of 2 or 3 */                         \
+        const T oneTwo_ = ANDNOT(OR(AND(aTwos_, bTwos_), AND(cTwos_, carry_)),                  \
+                                 XOR(XOR(aTwos_, bTwos_), XOR(cTwos_, carry_)));                \
+        /* 3 neighbours: alive. 2 neighbours: unchanged. Otherwise dead. */                    \
+        (result) = AND(oneTwo_, OR(ones_, c));                                                  \
+    } while (0)
+
+/**
+ * Any Life-like rule on bit planes. Same adders as LIFE_ADDER, carried on to
+ * the four bits of the count (0 to 8), then the counts of the rule are
+ * matched. With constant masks the loops unroll into the few terms the rule
+ * needs.
+ */
+#define RULE_ADDER(T, XOR, AND, OR, ANDNOT, ONES, ZERO, birth, survival, aL, a, aR, cL, c, cR, bL, b, bR, result) \
+    do                                                                                          \
+    {                                                                                           \
+        const T aOnes_ = XOR(XOR(aL, a), aR);                                                   \
+        const T aTwos_ = OR(AND(aL, a), AND(aR, XOR(aL, a)));                                   \
+        const T bOnes_ = XOR(XOR(bL, b), bR);                                                   \
+        const T bTwos_ = OR(AND(bL, b), AND(bR, XOR(bL, b)));                                   \
+        const T cOnes_ = XOR(cL, cR);                                                           \
+        const T cTwos_ = AND(cL, cR);                                                           \
+        const T carry_ = OR(AND(aOnes_, bOnes_), AND(cOnes_, XOR(aOnes_, bOnes_)));             \
+        /* Four twos: bit 1 of the count, and two carries of weight 4 */                       \
+        const T twos1_ = XOR(aTwos_, bTwos_);                                                   \
+        const T twos2_ = XOR(cTwos_, carry_);                                                   \
+        const T fours1_ = AND(aTwos_, bTwos_);                                                  \
+        const T fours2_ = AND(cTwos_, carry_);                                                  \
+        const T fours3_ = AND(twos1_, twos2_);                                                  \
+        const T bits_[4] = {                                                                    \
+            XOR(XOR(aOnes_, bOnes_), cOnes_),                                                   \
+            XOR(twos1_, twos2_),                                                                \
+            XOR(XOR(fours1_, fours2_), fours3_),                                                \
+            OR(AND(fours1_, fours2_), AND(fours3_, XOR(fours1_, fours2_)))                      \
+        };                                                                                      \
+        T next_ = ZERO;                                                                         \
+        Uint32 n_, i_;                                                                          \
+        for (n_ = 0; n_ <= 8; n_++)                                                             \
+        {                                                                                       \
+            if ((((birth) | (survival)) >> n_) & 1)                                             \
+            {                                                                                   \
+                T hit_ = ONES;                                                                  \
+                for (i_ = 0; i_ < 4; i_++)                                                      \
+                {                                                                               \
+                    hit_ = (n_ >> i_) & 1 ? AND(hit_, bits_[i_]) : ANDNOT(bits_[i_], hit_);     \
+                }                                                                               \
+                /* A dead cell takes the birth counts, a living one the survival counts */     \
+                next_ = OR(next_, (((birth) & (survival)) >> n_) & 1 ? hit_ :                   \
+                                  ((birth) >> n_) & 1 ? ANDNOT(c, hit_) : AND(c, hit_));        \
+            }                                                                                   \
+        }                                                                                       \
+        (result) = next_;                                                                       \
+    } while (0)
+
+/**
+ * Compute a span of words of a packed row, 64 cells at once.
+ * @param above The row above
+ * @param current The row being computed
+ * @param below The row below
+ * @param result The row receiving the next generation
+ * @param from First word
+ * @param to Last word (excluded)
+ * @param birth, survival The rule (see Rule)
+ */
+__attribute__((always_inline))
+static inline void board_compute_packed_span_rule(const Uint64 * above, const Uint64 * current,
+                                                  const Uint64 * below, Uint64 * result, int from, int to,
+                                                  const Uint32 birth, const Uint32 survival)
+{
+    register int i;   // Signed: i - 1 reaches the left halo word
+
+    for (i = from; i < to; i++)
+    {
+        // Neighbours at x-1 are shifted towards x, the halo words feed the row ends
+        const Uint64 aL = (above[i] << 1) | (above[i - 1] >> 63);
+        const Uint64 aR = (above[i] >> 1) | (above[i + 1] << 63);
+        const Uint64 cL = (current[i] << 1) | (current[i - 1] >> 63);
+        const Uint64 cR = (current[i] >> 1) | (current[i + 1] << 63);
+        const Uint64 bL = (below[i] << 1) | (below[i - 1] >> 63);
+        const Uint64 bR = (below[i] >> 1) | (below[i + 1] << 63);
+
+        if (birth == LIFE_BIRTH && survival == LIFE_SURVIVAL)
+        {
+            LIFE_ADDER(Uint64, WORD_XOR, WORD_AND, WORD_OR, WORD_ANDNOT,
+                       aL, above[i], aR, cL, current[i], cR, bL, below[i], bR, result[i]);
+        }
+        else
+        {
+            RULE_ADDER(Uint64, WORD_XOR, WORD_AND, WORD_OR, WORD_ANDNOT, ~0ULL, 0, birth, survival,
+                       aL, above[i], aR, cL, current[i], cR, bL, below[i], bR, result[i]);
+        }
+    }
+}
+
+/**
+ * The next state of 64 cells under the rule of the run, for the kernels
+ * which are not specialized (sparse universe, HashLife)
+ */
+static inline Uint64 rule_packed_word(Uint64 aL, Uint64 a, Uint64 aR, Uint64 cL, Uint64 c, Uint64 cR, Uint64 bL, Uint64 b, Uint64 bR)
+{
+    Uint64 result;
+
+    if (gRule.birth == LIFE_BIRTH && gRule.survival == LIFE_SURVIVAL)
+    {
+        LIFE_ADDER(Uint64, WORD_XOR, WORD_AND, WORD_OR, WORD_ANDNOT, aL, a, aR, cL, c, cR, bL, b, bR, result);
+    }
+    else
+    {
+        RULE_ADDER(Uint64, WORD_XOR, WORD_AND, WORD_OR, WORD_ANDNOT, ~0ULL, 0, gRule.birth, gRule.survival,
+                   aL, a, aR, cL, c, cR, bL, b, bR, result);
+    }
+    return result;
+}
+
+/**
+ * The bits after the last cell belong to the halo and must stay dead
+ * @param board The packed board
+ * @param result The row just computed
+ */
+static inline void board_packed_mask_tail(const Board * board, Uint64 * result)
+{
+    const Uint32 tail = board->width & 63;
+
+    if (tail)
+    {
+        result[board->words - 1] &= ((Uint64)1 << tail) - 1;
+    }
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+
+/**
+ * Byte kernel, 16 cells per instruction
+ * @param board
+ * @param temp
+ * @param height
+ * @param birth, survival The rule, constant once inlined
+ */
+__attribute__((target("sse2"), always_inline))
+static inline void board_compute_sse2_rule(const Board * board, Board * temp, const Uint32 height, const Uint32 birth, const Uint32 survival)
+{
+    int x;
+    Uint32 n;
+    const int size = (int)board->width;
+    const Uint8 * above = board_row(board, (int)height - 1);
+    const Uint8 * current = board_row(board, height);
+    const Uint8 * below = board_row(board, height + 1);
+    Uint8 * result = board_row(temp, height);
+    const __m128i three = _mm_set1_epi8(3);
+    const __m128i one = _mm_set1_epi8(1);
+
+    for (x = 0; x + 16 <= size; x += 16)
+    {
+        const __m128i cell = _mm_load_si128((const __m128i *)(current + x));
+        __m128i count = _mm_add_epi8(_mm_loadu_si128((const __m128i *)(above + x - 1)), _mm_load_si128((const __m128i *)(above + x)));
+        count = _mm_add_epi8(count, _mm_loadu_si128((const __m128i *)(above + x + 1)));
+        count = _mm_add_epi8(count, _mm_loadu_si128((const __m128i *)(current + x - 1)));
+        count = _mm_add_epi8(count, _mm_loadu_si128((const __m128i *)(current + x + 1)));
+        count = _mm_add_epi8(count, _mm_loadu_si128((const __m128i *)(below + x - 1)));
+        count = _mm_add_epi8(count, _mm_load_si128((const __m128i *)(below + x)));
+        count = _mm_add_epi8(count, _mm_loadu_si128((const __m128i *)(below + x + 1)));
+        if (birth == LIFE_BIRTH && survival == LIFE_SURVIVAL)
+        {
+            count = _mm_or_si128(count, cell);
+            _mm_store_si128((__m128i *)(result + x), _mm_and_si128(_mm_cmpeq_epi8(count, three), one));
+        }
+        else
+        {
+            // One comparison per count of the rule
+            const __m128i alive = _mm_cmpeq_epi8(cell, one);
+            __m128i next = _mm_setzero_si128();
+            for (n = 0; n <= 8; n++)
+            {
+                if (((birth | survival) >> n) & 1)
+                {
+                    const __m128i hit = _mm_cmpeq_epi8(count, _mm_set1_epi8((char)n));
+                    next = _mm_or_si128(next, ((birth & survival) >> n) & 1 ? hit :
+                                              (birth >> n) & 1 ? _mm_andnot_si128(alive, hit) : _mm_and_si128(alive, hit));
+                }
+            }
+            _mm_store_si128((__m128i *)(result + x), _mm_and_si128(next, one));
+        }
+    }
+    // The last cells would spill in the halo
+    board_compute_span_rule(above, current, below, result, x, size, birth, survival);
+}
+
+/**
+ * Byte kernel, 32 cells per instruction
+ * @param board
+ * @param temp
+ * @param height
+ * @param birth, survival The rule, constant once inlined
+ */
+__attribute__((target("avx2"), always_inline))
+static inline void board_compute_avx2_rule(const Board * board, Board * temp, const Uint32 height, const Uint32 birth, const Uint32 survival)
+{
+    int x;
+    Uint32 n;
+    const int size = (int)board->width;
+    const Uint8 * above = board_row(board, (int)height - 1);
+    const Uint8 * current = board_row(board, height);
+    const Uint8 * below = board_row(board, height + 1);
+    Uint8 * result = board_row(temp, height);
+    const __m256i three = _mm256_set1_epi8(3);
+    const __m256i one = _mm256_set1_epi8(1);
+
+    for (x = 0; x + 32 <= size; x += 32)
+    {
+        const __m256i cell = _mm256_load_si256((const __m256i *)(current + x));
+        __m256i count = _mm256_add_epi8(_mm256_loadu_si256((const __m256i *)(above + x - 1)), _mm256_load_si256((const __m256i *)(above + x)));
+        count = _mm256_add_epi8(count, _mm256_loadu_si256((const __m256i *)(above + x + 1)));
+        count = _mm256_add_epi8(count, _mm256_loadu_si256((const __m256i *)(current + x - 1)));
+        count = _mm256_add_epi8(count, _mm256_loadu_si256((const __m256i *)(current + x + 1)));
+        count = _mm256_add_epi8(count, _mm256_loadu_si256((const __m256i *)(below + x - 1)));
+        count = _mm256_add_epi8(count, _mm256_load_si256((const __m256i *)(below + x)));
+        count = _mm256_add_epi8(count, _mm256_loadu_si256((const __m256i *)(below + x + 1)));
+        if (birth == LIFE_BIRTH && survival == LIFE_SURVIVAL)
+        {
+            count = _mm256_or_si256(count, cell);
+            _mm256_store_si256((__m256i *)(result + x), _mm256_and_si256(_mm256_cmpeq_epi8(count, three), one));
+        }
+        else
+        {
+            const __m256i alive = _mm256_cmpeq_epi8(cell, one);
+            __m256i next = _mm256_setzero_si256();
+            for (n = 0; n <= 8; n++)
+            {
+                if (((birth | survival) >> n) & 1)
+                {
+                    const __m256i hit = _mm256_cmpeq_epi8(count, _mm256_set1_epi8((char)n));
+                    next = _mm256_or_si256(next, ((birth & survival) >> n) & 1 ? hit :
+                                                 (birth >> n) & 1 ? _mm256_andnot_si256(alive, hit) : _mm256_and_si256(alive, hit));
+                }
+            }
+            _mm256_store_si256((__m256i *)(result + x), _mm256_and_si256(next, one));
+        }
+    }
+    board_compute_span_rule(above, current, below, result, x, size, birth, survival);
+}
+
+/**
+ * Byte kernel, 64 cells (a whole cache line) per instruction
+ * @param board
+ * @param temp
+ * @param height
+ * @param birth, survival The rule, constant once inlined
+ */
+__attribute__((target("avx512f,avx512bw"), always_inline))
+static inline void board_compute_avx512_rule(const Board * board, Board * temp, const Uint32 height, const Uint32 birth, const Uint32 survival)
+{
+    int x;
+    Uint32 n;
+    const int size = (int)board->width;
+    const Uint8 * above = board_row(board, (int)height - 1);
+    const Uint8 * current = board_row(board, height);
+    const Uint8 * below = board_row(board, height + 1);
+    Uint8 * result = board_row(temp, height);
+    const __m512i three = _mm512_set1_epi8(3);
+    const __m512i one = _mm512_set1_epi8(1);
+
+    for (x = 0; x + 64 <= size; x += 64)
+    {
+        const __m512i cell = _mm512_load_si512(current + x);
+        __m512i count = _mm512_add_epi8(_mm512_loadu_si512(above + x - 1), _mm512_load_si512(above + x));
+        count = _mm512_add_epi8(count, _mm512_loadu_si512(above + x + 1));
+        count = _mm512_add_epi8(count, _mm512_loadu_si512(current + x - 1));
+        count = _mm512_add_epi8(count, _mm512_loadu_si512(current + x + 1));
+        count = _mm512_add_epi8(count, _mm512_loadu_si512(below + x - 1));
+        count = _mm512_add_epi8(count, _mm512_load_si512(below + x));
+        count = _mm512_add_epi8(count, _mm512_loadu_si512(below + x + 1));
+        if (birth == LIFE_BIRTH && survival == LIFE_SURVIVAL)
+        {
+            count = _mm512_or_si512(count, cell);
+            _mm512_store_si512(result + x, _mm512_maskz_mov_epi8(_mm512_cmpeq_epi8_mask(count, three), one));
+        }
+        else
+        {
+            // The comparisons give mask registers, combined as plain integers
+            const __mmask64 alive = _mm512_test_epi8_mask(cell, cell);
+            __mmask64 next = 0;
+            for (n = 0; n <= 8; n++)
+            {
+                if (((birth | survival) >> n) & 1)
+                {
+                    const __mmask64 hit = _mm512_cmpeq_epi8_mask(count, _mm512_set1_epi8((char)n));
+                    next |= ((birth & survival) >> n) & 1 ? hit : (birth >> n) & 1 ? hit & ~alive : hit & alive;
+                }
+            }
+            _mm512_store_si512(result + x, _mm512_maskz_mov_epi8(next, one));
+        }
+    }
+    board_compute_span_rule(above, current, below, result, x, size, birth, survival);
+}
+
+// Shift a vector of rows so neighbour x-1 (or x+1) lands on x. The previous
+// (or next) words come from an unaligned load one word aside.
+#define SSE2_LEFT(v, prev)      _mm_or_si128(_mm_slli_epi64(v, 1), _mm_srli_epi64(prev, 63))
+#define SSE2_RIGHT(v, next)     _mm_or_si128(_mm_srli_epi64(v, 1), _mm_slli_epi64(next, 63))
+#define AVX2_LEFT(v, prev)      _mm256_or_si256(_mm256_slli_epi64(v, 1), _mm256_srli_epi64(prev, 63))
+#define AVX2_RIGHT(v, next)     _mm256_or_si256(_mm256_srli_epi64(v, 1), _mm256_slli_epi64(next, 63))
+#define AVX512_LEFT(v, prev)    _mm512_or_si512(_mm512_slli_epi64(v, 1), _mm512_srli_epi64(prev, 63))
+#define AVX512_RIGHT(v, next)   _mm512_or_si512(_mm512_srli_epi64(v, 1), _mm512_slli_epi64(next, 63))
+
+/**
+ * Packed kernel, 2 words (128 cells) per instruction
+ * @param board
+ * @param temp
+ * @param height
+ * @param birth, survival The rule, constant once inlined
+ */
+__attribute__((target("sse2"), always_inline))
+static inline void board_compute_packed_sse2_rule(const Board * board, Board * temp, const Uint32 height, const Uint32 birth, const Uint32 survival)
+{
+    int i;
+    const int words = (int)board->words;
+    const Uint64 * above = board_packed_row(board, (int)height - 1);
+    const Uint64 * current = board_packed_row(board, height);
+    const Uint64 * below = board_packed_row(board, height + 1);
+    Uint64 * result = board_packed_row(temp, height);
+
+    for (i = 0; i + 2 <= words; i += 2)
+    {
+        const __m128i a = _mm_load_si128((const __m128i *)(above + i));
+        const __m128i c = _mm_load_si128((const __m128i *)(current + i));
+        const __m128i b = _mm_load_si128((const __m128i *)(below + i));
+        const __m128i aL = SSE2_LEFT(a, _mm_loadu_si128((const __m128i *)(above + i - 1)));
+        const __m128i aR = SSE2_RIGHT(a, _mm_loadu_si128((const __m128i *)(above + i + 1)));
+        const __m128i cL = SSE2_LEFT(c, _mm_loadu_si128((const __m128i *)(current + i - 1)));
+        const __m128i cR = SSE2_RIGHT(c, _mm_loadu_si128((const __m128i *)(current + i + 1)));
+        const __m128i bL = SSE2_LEFT(b, _mm_loadu_si128((const __m128i *)(below + i - 1)));
+        const __m128i bR = SSE2_RIGHT(b, _mm_loadu_si128((const __m128i *)(below + i + 1)));
+        __m128i next;
+
+        if (birth == LIFE_BIRTH && survival == LIFE_SURVIVAL)
+        {
+            LIFE_ADDER(__m128i, _mm_xor_si128, _mm_and_si128, _mm_or_si128, _mm_andnot_si128,
+                       aL, a, aR, cL, c, cR, bL, b, bR, next);
+        }
+        else
+        {
+            RULE_ADDER(__m128i, _mm_xor_si128, _mm_and_si128, _mm_or_si128, _mm_andnot_si128,
+                       _mm_set1_epi32(-1), _mm_setzero_si128(), birth, survival,
+                       aL, a, aR, cL, c, cR, bL, b, bR, next);
+        }
+        _mm_store_si128((__m128i *)(result + i), next);
+    }
+    board_compute_packed_span_rule(above, current, below, result, i, words, birth, survival);
+    board_packed_mask_tail(board, result);
+}
+
+/**
+ * Packed kernel, 4 words (256 cells) per instruction
+ * @param board
+ * @param temp
+ * @param height
+ * @param birth, survival The rule, constant once inlined
+ */
+__attribute__((target("avx2"), always_inline))
+static inline void board_compute_packed_avx2_rule(const Board * board, Board * temp, const Uint32 height, const Uint32 birth, const Uint32 survival)
+{
+    int i;
+    const int words = (int)board->words;
+    const Uint64 * above = board_packed_row(board, (int)height - 1);
+    const Uint64 * current = board_packed_row(board, height);
+    const Uint64 * below = board_packed_row(board, height + 1);
+    Uint64 * result = board_packed_row(temp, height);
+
+    for (i = 0; i + 4 <= words; i += 4)
+    {
+        const __m256i a = _mm256_load_si256((const __m256i *)(above + i));
+        const __m256i c = _mm256_load_si256((const __m256i *)(current + i));
+        const __m256i b = _mm256_load_si256((const __m256i *)(below + i));
+        const __m256i aL = AVX2_LEFT(a, _mm256_loadu_si256((const __m256i *)(above + i - 1)));
+        const __m256i aR = AVX2_RIGHT(a, _mm256_loadu_si256((const __m256i *)(above + i + 1)));
+        const __m256i cL = AVX2_LEFT(c, _mm256_loadu_si256((const __m256i *)(current + i - 1)));
+        const __m256i cR = AVX2_RIGHT(c, _mm256_loadu_si256((const __m256i *)(current + i + 1)));
+        const __m256i bL = AVX2_LEFT(b, _mm256_loadu_si256((const __m256i *)(below + i - 1)));
+        const __m256i bR = AVX2_RIGHT(b, _mm256_loadu_si256((const __m256i *)(below + i + 1)));
+        __m256i next;
+
+        if (birth == LIFE_BIRTH && survival == LIFE_SURVIVAL)
+        {
+            LIFE_ADDER(__m256i, _mm256_xor_si256, _mm256_and_si256, _mm256_or_si256, _mm256_andnot_si256,
+                       aL, a, aR, cL, c, cR, bL, b, bR, next);
+        }
+        else
+        {
+            RULE_ADDER(__m256i, _mm256_xor_si256, _mm256_and_si256, _mm256_or_si256, _mm256_andnot_si256,
+                       _mm256_set1_epi32(-1), _mm256_setzero_si256(), birth, survival,
+                       aL, a, aR, cL, c, cR, bL, b, bR, next);
+        }
+        _mm256_store_si256((__m256i *)(result + i), next);
+    }
+    board_compute_packed_span_rule(above, current, below, result, i, words, birth, survival);
+    board_packed_mask_tail(board, result);
+}
+
+/**
+ * Packed kernel, 8 words (512 cells) per instruction
+ * @param board
+ * @param temp
+ * @param height
+ * @param birth, survival The rule, constant once inlined
+ */
+__attribute__((target("avx512f,avx512bw"), always_inline))
+static inline void board_compute_packed_avx512_rule(const Board * board, Board * temp, const Uint32 height, const Uint32 birth, const Uint32 survival)
+{
+    int i;
+    const int words = (int)board->words;
+    const Uint64 * above = board_packed_row(board, (int)height - 1);
+    const Uint64 * current = board_packed_row(board, height);
+    const Uint64 * below = board_packed_row(board, height + 1);
+    Uint64 * result = board_packed_row(temp, height);
+
+    for (i = 0; i + 8 <= words; i += 8)
+    {
+        const __m512i a = _mm512_load_si512(above + i);
+        const __m512i c = _mm512_load_si512(current + i);
+        const __m512i b = _mm512_load_si512(below + i);
+        const __m512i aL = AVX512_LEFT(a, _mm512_loadu_si512(above + i - 1));
+        const __m512i aR = AVX512_RIGHT(a, _mm512_loadu_si512(above + i + 1));
+        const __m512i cL = AVX512_LEFT(c, _mm512_loadu_si512(current + i - 1));
+        const __m512i cR = AVX512_RIGHT(c, _mm512_loadu_si512(current + i + 1));
+        const __m512i bL = AVX512_LEFT(b, _mm512_loadu_si512(below + i - 1));
+        const __m512i bR = AVX512_RIGHT(b, _mm512_loadu_si512(below + i + 1));
+        __m512i next;
+
+        if (birth == LIFE_BIRTH && survival == LIFE_SURVIVAL)
+        {
+            LIFE_ADDER(__m512i, _mm512_xor_si512, _mm512_and_si512, _mm512_or_si512, _mm512_andnot_si512,
+                       aL, a, aR, cL, c, cR, bL, b, bR, next);
+        }
+        else
+        {
+            RULE_ADDER(__m512i, _mm512_xor_si512, _mm512_and_si512, _mm512_or_si512, _mm512_andnot_si512,
+                       _mm512_set1_epi32(-1), _mm512_setzero_si512(), birth, survival,
+                       aL, a, aR, cL, c, cR, bL, b, bR, next);
+        }
+        _mm512_store_si512(result + i, next);
+    }
+    board_compute_packed_span_rule(above, current, below, result, i, words, birth, survival);
+    board_packed_mask_tail(board, result);
+}
+
+#elif defined(__ARM_NEON)
+
+/**
+ * Byte kernel, 16 cells per instruction
+ * @param board
+ * @param temp
+ * @param height
+ * @param birth, survival The rule, constant once inlined
+ */
+__attribute__((always_inline))
+static inline void board_compute_neon_rule(const Board * board, Board * temp, const Uint32 height, const Uint32 birth, const Uint32 survival)
+{
+    int x;
+    Uint32 n;
+    const int size = (int)board->width;
+    const Uint8 * above = board_row(board, (int)height - 1);
+    const Uint8 * current = board_row(board, height);
+    const Uint8 * below = board_row(board, height + 1);
+    Uint8 * result = board_row(temp, height);
+    const uint8x16_t three = vdupq_n_u8(3);
+    const uint8x16_t one = vdupq_n_u8(1);
+
+    for (x = 0; x + 16 <= size; x += 16)
+    {
+        const uint8x16_t cell = vld1q_u8(current + x);
+        uint8x16_t count = vaddq_u8(vld1q_u8(above + x - 1), vld1q_u8(above + x));
+        count = vaddq_u8(count, vld1q_u8(above + x + 1));
+        count = vaddq_u8(count, vld1q_u8(current + x - 1));
+        count = vaddq_u8(count, vld1q_u8(current + x + 1));
+        count = vaddq_u8(count, vld1q_u8(below + x - 1));
+        count = vaddq_u8(count, vld1q_u8(below + x));
+        count = vaddq_u8(count, vld1q_u8(below + x + 1));
+        if (birth == LIFE_BIRTH && survival == LIFE_SURVIVAL)
+        {
+            count = vorrq_u8(count, cell);
+            vst1q_u8(result + x, vandq_u8(vceqq_u8(count, three), one));
+        }
+        else
+        {
+            const uint8x16_t alive = vceqq_u8(cell, one);
+            uint8x16_t next = vdupq_n_u8(0);
+            for (n = 0; n <= 8; n++)
+            {
+                if (((birth | survival) >> n) & 1)
+                {
+                    const uint8x16_t hit = vceqq_u8(count, vdupq_n_u8((Uint8)n));
+                    next = vorrq_u8(next, ((birth & survival) >> n) & 1 ? hit :
+                                          (birth >> n) & 1 ? vbicq_u8(hit, alive) : vandq_u8(hit, alive));
+                }
+            }
+            vst1q_u8(result + x, vandq_u8(next, one));
+        }
+    }
+    board_compute_span_rule(above, current, below, result, x, size, birth, survival);
+}
+
+#define NEON_LEFT(v, prev)      vorrq_u64(vshlq_n_u64(v, 1), vshrq_n_u64(prev, 63))
+#define NEON_RIGHT(v, next)     vorrq_u64(vshrq_n_u64(v, 1), vshlq_n_u64(next, 63))
+#define NEON_ANDNOT(x, y)       vbicq_u64(y, x)
+
+/**
+ * Packed kernel, 2 words (128 cells) per instruction
+ * @param board
+ * @param temp
+ * @param height
+ * @param birth, survival The rule, constant once inlined
+ */
+__attribute__((always_inline))
+static inline void board_compute_packed_neon_rule(const Board * board, Board * temp, const Uint32 height, const Uint32 birth, const Uint32 survival)
+{
+    int i;
+    const int words = (int)board->words;
+    const Uint64 * above = board_packed_row(board, (int)height - 1);
+    const Uint64 * current = board_packed_row(board, height);
+    const Uint64 * below = board_packed_row(board, height + 1);
+    Uint64 * result = board_packed_row(temp, height);
+
+    for (i = 0; i + 2 <= words; i += 2)
+    {
+        const uint64x2_t a = vld1q_u64(above + i);
+        const uint64x2_t c = vld1q_u64(current + i);
+        const uint64x2_t b = vld1q_u64(below + i);
+        const uint64x2_t aL = NEON_LEFT(a, vld1q_u64(above + i - 1));
+        const uint64x2_t aR = NEON_RIGHT(a, vld1q_u64(above + i + 1));
+        const uint64x2_t cL = NEON_LEFT(c, vld1q_u64(current + i - 1));
+        const uint64x2_t cR = NEON_RIGHT(c, vld1q_u64(current + i + 1));
+        const uint64x2_t bL = NEON_LEFT(b, vld1q_u64(below + i - 1));
+        const uint64x2_t bR = NEON_RIGHT(b, vld1q_u64(below + i + 1));
+        uint64x2_t next;
+
+        if (birth == LIFE_BIRTH && survival == LIFE_SURVIVAL)
+        {
+            LIFE_ADDER(uint64x2_t, veorq_u64, vandq_u64, vorrq_u64, NEON_ANDNOT,
+                       aL, a, aR, cL, c, cR, bL, b, bR, next);
+        }
+        else
+        {
+            RULE_ADDER(uint64x2_t, veorq_u64, vandq_u64, vorrq_u64, NEON_ANDNOT,
+                       vdupq_n_u64(~0ULL), vdupq_n_u64(0), birth, survival,
+                       aL, a, aR, cL, c, cR, bL, b, bR, next);
+        }
+        vst1q_u64(result + i, next);
+    }
+    board_compute_packed_span_rule(above, current, below, result, i, words, birth, survival);
+    board_packed_mask_tail(board, result);
+}
+
+#endif
+
+// Span kernels of a rule, see board_compute_span_rule
+typedef void (*ByteSpanFunc)(const Uint8 * restrict, const Uint8 * restrict, const Uint8 * restrict, Uint8 * restrict, int, int);
+typedef void (*PackedSpanFunc)(const Uint64 *, const Uint64 *, const Uint64 *, Uint64 *, int, int);
+
+/**
+ * Every kernel of a rule: the spans used by the scalar, tiled, temporal and
+ * active backends, and the SIMD rows indexed by BoardFormat. The last entry
+ * of kRuleKernels reads the masks of gRule at run time, for the rules which
+ * are not specialized.
+ */
+struct RuleKernels
+{
+    Uint32 birth;
+    Uint32 survival;
+    ByteSpanFunc span;
+    PackedSpanFunc packedSpan;
+#if defined(__x86_64__) || defined(__i386__)
+    ComputeRowFunc sse2[2];
+    ComputeRowFunc avx2[2];
+    ComputeRowFunc avx512[2];
+#elif defined(__ARM_NEON)
+    ComputeRowFunc neon[2];
+#endif
+};
+
+/**
+ * Common rules, each gets its own compiled kernels: the masks are constants
+ * where the generic bodies are inlined. Name, birth mask, survival mask.
+ */
+#define RULE_SPECIALIZATIONS(X)                                                                 \
+    X(life,             LIFE_BIRTH, LIFE_SURVIVAL)  /* B3/S23 */                                \
+    X(highlife,         0x048,      LIFE_SURVIVAL)  /* B36/S23 */                               \
+    X(daynight,         0x1C8,      0x1D8)          /* B3678/S34678 */                          \
+    X(seeds,            0x004,      0x000)          /* B2/S */                                  \
+    X(lifewithoutdeath, LIFE_BIRTH, 0x1FF)          /* B3/S012345678 */                         \
+    X(maze,             LIFE_BIRTH, 0x03E)          /* B3/S12345 */                             \
+    X(replicator,       0x0AA,      0x0AA)          /* B1357/S1357 */
+
+#if defined(__x86_64__) || defined(__i386__)
+#define RULE_SIMD_INSTANCE(name, birth, survival)                                               \
+    __attribute__((target("sse2")))                                                            \
+    static void board_compute_sse2_##name(const Board * board, Board * temp, const Uint32 height) \
+    { board_compute_sse2_rule(board, temp, height, birth, survival); }                          \
+    __attribute__((target("avx2")))                                                            \
+    static void board_compute_avx2_##name(const Board * board, Board * temp, const Uint32 height) \
+    { board_compute_avx2_rule(board, temp, height, birth, survival); }                          \
+    __attribute__((target("avx512f,avx512bw")))                                                \
+    static void board_compute_avx512_##name(const Board * board, Board * temp, const Uint32 height) \
+    { board_compute_avx512_rule(board, temp, height, birth, survival); }                        \
+    __attribute__((target("sse2")))                                                            \
+    static void board_compute_packed_sse2_##name(const Board * board, Board * temp, const Uint32 height) \
+    { board_compute_packed_sse2_rule(board, temp, height, birth, survival); }                   \
+    __attribute__((target("avx2")))                                                            \
+    static void board_compute_packed_avx2_##name(const Board * board, Board * temp, const Uint32 height) \
+    { board_compute_packed_avx2_rule(board, temp, height, birth, survival); }                   \
+    __attribute__((target("avx512f,avx512bw")))                                                \
+    static void board_compute_packed_avx512_##name(const Board * board, Board * temp, const Uint32 height) \
+    { board_compute_packed_avx512_rule(board, temp, height, birth, survival); }
+#define RULE_SIMD_ENTRY(name)                                                                   \
+    , { board_compute_sse2_##name, board_compute_packed_sse2_##name }                           \
+    , { board_compute_avx2_##name, board_compute_packed_avx2_##name }                           \
+    , { board_compute_avx512_##name, board_compute_packed_avx512_##name }
+#elif defined(__ARM_NEON)
+#define RULE_SIMD_INSTANCE(name, birth, survival)                                               \
+    static void board_compute_neon_##name(const Board * board, Board * temp, const Uint32 height) \
+    { board_compute_neon_rule(board, temp, height, birth, survival); }                          \
+    static void board_compute_packed_neon_##name(const Board * board, Board * temp, const Uint32 height) \
+    { board_compute_packed_neon_rule(board, temp, height, birth, survival); }
+#define RULE_SIMD_ENTRY(name)                                                                   \
+    , { board_compute_neon_##name, board_compute_packed_neon_##name }
+#else
+#define RULE_SIMD_INSTANCE(name, birth, survival)
+#define RULE_SIMD_ENTRY(name)
+#endif
+
+#define RULE_INSTANCE(name, birth, survival)                                                    \
+    static void board_compute_span_##name(const Uint8 * restrict above, const Uint8 * restrict current, \
+                                          const Uint8 * restrict below, Uint8 * restrict result, int from, int to) \
+    { board_compute_span_rule(above, current, below, result, from, to, birth, survival); }      \
+    static void board_compute_packed_span_##name(const Uint64 * above, const Uint64 * current,  \
+                                                 const Uint64 * below, Uint64 * result, int from, int to) \
+    { board_compute_packed_span_rule(above, current, below, result, from, to, birth, survival); } \
+    RULE_SIMD_INSTANCE(name, birth, survival)
+#define RULE_ENTRY(name, birth, survival)                                                       \
+    { birth, survival, board_compute_span_##name, board_compute_packed_span_##name RULE_SIMD_ENTRY(name) },
+
+RULE_SPECIALIZATIONS(RULE_INSTANCE)
+RULE_INSTANCE(generic, gRule.birth, gRule.survival)
+
+static const RuleKernels kRuleKernels[] = {
+    RULE_SPECIALIZATIONS(RULE_ENTRY)
+    RULE_ENTRY(generic, 0, 0)
+};
+
+#undef RULE_INSTANCE
+#undef RULE_ENTRY
+
+/**
+ * Pick the kernels of a rule: its own ones when it is specialized, the
+ * generic ones otherwise
+ * @param rule
+ * @return Yes if the rule has kernels of its own
+ */
+static int rule_select(Rule * rule)
+{
+    const Uint32 count = sizeof(kRuleKernels) / sizeof(RuleKernels);
+    Uint32 i;
+
+    for (i = 0; i + 1 < count; i++)
+    {
+        if (kRuleKernels[i].birth == rule->birth && kRuleKernels[i].survival == rule->survival)
+        {
+            break;
+        }
+    }
+    rule->kernels = &kRuleKernels[i];
+    return i + 1 < count;
+}
+
+/**
+ * Compute a span of cells of a row with the kernel of the rule
+ */
+static inline void board_compute_span(const Uint8 * restrict above, const Uint8 * restrict current,
+                                      const Uint8 * restrict below, Uint8 * restrict result, int from, int to)
+{
+    gRule.kernels->span(above, current, below, result, from, to);
+}
+
+/**
+ * Compute a span of words of a packed row with the kernel of the rule
+ */
+static inline void board_compute_packed_span(const Uint64 * above, const Uint64 * current,
+                                             const Uint64 * below, Uint64 * result, int from, int to)
+{
+    gRule.kernels->packedSpan(above, current, below, result, from, to);
+}
+
+/**
+ * Nanoseconds on the monotonic clock
+ */
+static inline Uint64 profile_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (Uint64)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/**
+ * Phases of a frame measured by the profiler
+ */
+typedef enum ProfileScope
+{
+    PROFILE_EVENTS = 0,
+    PROFILE_COMPUTE,
+    PROFILE_DRAW,
+    PROFILE_OVERLAY,
+    PROFILE_FLIP,
+    PROFILE_SCOPES
+} ProfileScope;
+
+static const char * kProfileScopeNames[PROFILE_SCOPES] = { "events", "compute", "draw", "overlay", "flip" };
+
+/**
+ * Counters of one compute thread. The kernels add to them as they go, one
+ * row or tile at a time, and metrics_step merges them once per generation.
+ * Each thread has a cache line of its own: no atomics, no false sharing.
+ */
+struct ThreadCounters
+{
+    Sint64 population;                  // Living cells in what the thread computed (their change with --active)
+    Uint64 cells;                       // Cells computed
+    Uint64 busy;                        // Nanoseconds spent computing
+    Uint64 start;                       // Clock when the thread started its share of the generation
+    int counting;                       // Count the population too (see GameContainer.countPopulation)
+    Uint8 padding[28];
+};
+
+/**
+ * Start the share of a thread in a generation
+ * @param game
+ * @param thread Number of the thread in the team
+ * @return Its counters, NULL when nothing is counted
+ */
+static inline ThreadCounters * counters_enter(GameContainer * game, Uint32 thread)
+{
+    ThreadCounters * counters = game->counters && thread < game->counterCount ? &game->counters[thread] : NULL;
+
+    if (counters)
+    {
+        counters->start = profile_now();
+        counters->counting = game->countPopulation;
+    }
+    return counters;
+}
+
+/**
+ * Count a rectangle of the next generation, just computed by the thread. Its
+ * population is only counted when it is asked for: it would cost as much as
+ * the packed kernels on every generation.
+ * @param counters NULL when nothing is counted
+ * @param next
+ * @param x, y, width, height As for board_rect_population
+ */
+static inline void counters_rect(ThreadCounters * counters, const Board * next, Uint32 x, Uint32 y, Uint32 width, Uint32 height)
+{
+    if (counters)
+    {
+        const Uint32 right = x + width < next->width ? x + width : next->width;
+        const Uint32 bottom = y + height < next->height ? y + height : next->height;
+        if (counters->counting)
+        {
+            counters->population += board_rect_population(next, x, y, width, height);
+        }
+        counters->cells += (Uint64)(right - x) * (bottom - y);
+    }
+}
+
+/**
+ * End the share of a thread in a generation
+ * @param counters NULL when nothing is counted
+ */
+static inline void counters_leave(ThreadCounters * counters)
+{
+    if (counters)
+    {
+        counters->busy += profile_now() - counters->start;
+    }
+}
+
+/** Compute a row of the board without multi-threading (traditional way)
+ * @param board An array  on which the computation is done
+ * @param temp An array on which the result are set
+ * @param height The vertical indice of the board
+ */
+static void board_compute_thread(const Board * board, Board * temp, const Uint32 height)
+{
+    board_compute_span(board_row(board, (int)height - 1), board_row(board, height),
+                       board_row(board, height + 1), board_row(temp, height), 0, (int)board->width);
+}
+
+/**
+ * Do the computation
+ * @param game
+ * @return 1, a single generation is computed
+ */
+static Uint32 board_compute(GameContainer * game)
+{
+    register Uint32 i;
+    const Board * board = game_board(game);
+    Board * next = game_next_board(game);
+    ThreadCounters * counters = counters_enter(game, 0);
+
+    for(i=0; i < board->height; i++)
+    {
+        board_compute_thread(board, next, i);
+        counters_rect(counters, next, 0, i, next->width, 1);
+    }
+    counters_leave(counters);
+
+    return 1;
+}
+
+/**
+ * Tell if the OpenMP backends must run without a parallel region. With a
+ * single thread libgomp allocates the team on every region (and the work
+ * share of an orphaned dynamic loop), so they take a plain loop instead.
+ * @return Yes when OpenMP has a single thread
+ */
+static inline int openmp_serial(void)
+{
+    return omp_get_max_threads() == 1;
+}
+
+/**
+ * Do the computation with OpenMP
+ * @param game
+ * @return 1, a single generation is computed
+ */
+static Uint32 board_compute_openmp(GameContainer * game)
+{
+    register Uint32 i;
+    const Board * board = game_board(game);
+    Board * next = game_next_board(game);
+    const Uint32 height = board->height;
+
+    if (openmp_serial())
+    {
+        return board_compute(game);
+    }
+    // COmptute the board with the maximum possible core
+    #pragma omp parallel private(i) shared(board, next)
+    {
+        ThreadCounters * counters = counters_enter(game, omp_get_thread_num());
+        #pragma omp for nowait
+        for(i=0; i < height; i++)
+        {
+            board_compute_thread(board, next, i);
+            counters_rect(counters, next, 0, i, next->width, 1);
+        }
+        counters_leave(counters);
+    }
+
+    return 1;
+}
+
+/**
+ * Do the computation one cell at a time, straight from the masks of gRule.
+ * Slow on purpose: it shares no kernel with the backends it checks (--verify).
+ * @param game
+ * @return 1, a single generation is computed
+ */
+static Uint32 board_compute_reference(GameContainer * game)
+{
+    register Uint32 x, y;
+    int dx, dy;
+    const Board * board = game_board(game);
+    Board * next = game_next_board(game);
+
+    for (y = 0; y < board->height; y++)
+    {
+        for (x = 0; x < board->width; x++)
+        {
+            Uint32 count = 0;
+            for (dy = -1; dy <= 1; dy++)
+            {
+                for (dx = -1; dx <= 1; dx++)
+                {
+                    count += (dx || dy) && board_row(board, (int)y + dy)[(int)x + dx];
+                }
+            }
+            board_row(next, y)[x] = ((board_row(board, y)[x] ? gRule.survival : gRule.birth) >> count) & 1;
+        }
+    }
+
+    return 1;
+}
+
+/**
+ * Compute one packed row
+ * @param board The packed board on which the computation is done
+ * @param temp The packed board on which the result are set
+ * @param height The vertical indice of the board
+ */
+static void board_compute_packed_thread(const Board * board, Board * temp, const Uint32 height)
+{
+    Uint64 * result = board_packed_row(temp, height);
+
+    board_compute_packed_span(board_packed_row(board, (int)height - 1), board_packed_row(board, height),
+                              board_packed_row(board, height + 1), result, 0, (int)board->words);
+    board_packed_mask_tail(board, result);
+}
+
+/**
+ * Do the computation on a packed board
+ * @param game
+ * @return 1, a single generation is computed
+ */
+static Uint32 board_compute_packed(GameContainer * game)
+{
+    register Uint32 i;
+    const Board * board = game_board(game);
+    Board * next = game_next_board(game);
+    ThreadCounters * counters = counters_enter(game, 0);
+
+    for(i=0; i < board->height; i++)
+    {
+        board_compute_packed_thread(board, next, i);
+        counters_rect(counters, next, 0, i, next->width, 1);
+    }
+    counters_leave(counters);
+
+    return 1;
+}
+
+/**
+ * Do the computation on a packed board with OpenMP
+ * @param game
+ * @return 1, a single generation is computed
+ */
+static Uint32 board_compute_packed_openmp(GameContainer * game)
+{
+    register Uint32 i;
+    const Board * board = game_board(game);
+    Board * next = game_next_board(game);
+    const Uint32 height = board->height;
+
+    if (openmp_serial())
+    {
+        return board_compute_packed(game);
+    }
+    #pragma omp parallel private(i) shared(board, next)
+    {
+        ThreadCounters * counters = counters_enter(game, omp_get_thread_num());
+        #pragma omp for nowait
+        for(i=0; i < height; i++)
+        {
+            board_compute_packed_thread(board, next, i);
+            counters_rect(counters, next, 0, i, next->width, 1);
+        }
+        counters_leave(counters);
+    }
+
+    return 1;
+}
+
+/**
+ * Pick the widest row kernel the running CPU supports, for the rule of the run
+ * @param format The board storage
+ * @param name Receive the name of the instruction set
+ * @return The row kernel
+ */
+static ComputeRowFunc simd_select(BoardFormat format, const char ** name)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw"))
+    {
+        *name = "AVX-512";
+        return gRule.kernels->avx512[format];
+    }
+    if (__builtin_cpu_supports("avx2"))
+    {
+        *name = "AVX2";
+        return gRule.kernels->avx2[format];
+    }
+    if (__builtin_cpu_supports("sse2"))
+    {
+        *name = "SSE2";
+        return gRule.kernels->sse2[format];
+    }
+#elif defined(__ARM_NEON)
+    *name = "NEON";
+    return gRule.kernels->neon[format];
+#endif
+    *name = "scalar";
+    return format == BOARD_PACKED ? board_compute_packed_thread : board_compute_thread;
+}
+
+/**
+ * Do the computation with the row kernel picked by simd_select, rows are
+ * spread over the cores with OpenMP
+ * @param game
+ * @return 1, a single generation is computed
+ */
+static Uint32 board_compute_simd(GameContainer * game)
+{
+    register Uint32 i;
+    const Board * board = game_board(game);
+    Board * next = game_next_board(game);
+    const Uint32 height = board->height;
+    const ComputeRowFunc func = game->computeRowFunc;
+    
+    if (openmp_serial())
+    {
+        ThreadCounters * counters = counters_enter(game, 0);
+        for(i=0; i < height; i++)
+        {
+            func(board, next, i);
+            counters_rect(counters, next, 0, i, next->width, 1);
+        }
+        counters_leave(counters);
+        return 1;
+    }
+    #pragma omp parallel private(i) shared(board, next)
+    {
+        ThreadCounters * counters = counters_enter(game, omp_get_thread_num());
+        #pragma omp for nowait
+        for(i=0; i < height; i++)
+        {
+            func(board, next, i);
+            counters_rect(counters, next, 0, i, next->width, 1);
+        }
+        counters_leave(counters);
+    }
+    
+    return 1;
+}
+
+/**
+ * Prefix sums of a row of a byte board: sums[x] is the number of living
+ * cells before x. Rows outside the board are dead.
+ * @param board
+ * @param y The row, may be outside the board
+ * @param sums width + 1 counters
+ */
+static inline void board_row_sums(const Board * board, int y, Uint32 * sums)
+{
+    register Uint32 x;
+    const Uint8 * row;
+
+    sums[0] = 0;
+    if (y < 0 || y >= (int)board->height)
+    {
+        memset(sums + 1, 0, board->width * sizeof(Uint32));
+        return;
+    }
+    row = board_row(board, y);
+    for (x = 0; x < board->width; x++)
+    {
+        sums[x + 1] = sums[x] + row[x];
+    }
+}
+
+/**
+ * Compute a band of rows of a Generations or Larger than Life rule. Each
+ * row of the neighbourhood is summed from its prefix sums, a ring of
+ * 2 * range + 1 of them follows the band down: a cell costs a subtraction
+ * per neighbourhood row whatever the range is. The dying states are kept in
+ * game->ages, the boards only hold the living cells.
+ * @param game
+ * @param first First row of the band
+ * @param last Last row (excluded)
+ * @param ring 2 * range + 1 rows of width + 1 counters
+ */
+static void board_compute_extended_band(GameContainer * game, Uint32 first, Uint32 last, Uint32 * ring)
+{
+    const Board * board = game_board(game);
+    Board * next = game_next_board(game);
+    const Rule * rule = &gRule;
+    const int range = (int)rule->range;
+    const Uint32 rows = 2 * rule->range + 1;
+    const Uint32 width = board->width;
+    const int masks = rule->range == 1 && ! rule->vonNeumann;
+    register Uint32 x;
+    int y, dy;
+
+    for (dy = -range; dy <= range; dy++)
+    {
+        board_row_sums(board, (int)first + dy, ring + (Uint32)((int)first + dy + range) % rows * (width + 1));
+    }
+    for (y = (int)first; y < (int)last; y++)
+    {
+        const Uint8 * current = board_row(board, y);
+        Uint8 * result = board_row(next, y);
+        Uint8 * ages = game->ages + (size_t)y * width;
+
+        if (y > (int)first)
+        {
+            // The row entering the neighbourhood takes the place of the one leaving it
+            board_row_sums(board, y + range, ring + (Uint32)(y + 2 * range) % rows * (width + 1));
+        }
+        for (x = 0; x < width; x++)
+        {
+            Uint32 count = 0;
+            int alive = 0;
+
+            for (dy = -range; dy <= range; dy++)
+            {
+                const Uint32 * sums = ring + (Uint32)(y + dy + range) % rows * (width + 1);
+                const int reach = rule->vonNeumann ? range - abs(dy) : range;
+                const Uint32 left = (int)x - reach > 0 ? x - reach : 0;
+                const Uint32 right = x + reach + 1 < width ? x + reach + 1 : width;
+                count += sums[right] - sums[left];
+            }
+            if ( ! rule->countSelf)
+            {
+                count -= current[x];
+            }
+
+            if (current[x])
+            {
+                alive = masks ? (rule->survival >> count) & 1 : count >= rule->survivalMin && count <= rule->survivalMax;
+                // A cell which does not survive starts dying
+                ages[x] = alive || rule->states == 2 ? 0 : 2;
+            }
+            else if (ages[x])
+            {
+                // A dying cell is not a neighbour and can't be born again before it is dead
+                ages[x] = ages[x] + 1U < rule->states ? ages[x] + 1 : 0;
+            }
+            else
+            {
+                alive = masks ? (rule->birth >> count) & 1 : count >= rule->birthMin && count <= rule->birthMax;
+            }
+            result[x] = alive;
+        }
+    }
+}
+
+/**
+ * Do the computation of a Generations or Larger than Life rule
+ * @param game
+ * @return 1, a single generation is computed
+ */
+static Uint32 board_compute_extended(GameContainer * game)
+{
+    board_compute_extended_band(game, 0, game_board(game)->height, game->ruleSums);
+    return 1;
+}
+
+/**
+ * Do the computation of a Generations or Larger than Life rule with OpenMP.
+ * Each thread takes a band of its own so its ring of sums is reused from a
+ * row to the next.
+ * @param game
+ * @return 1, a single generation is computed
+ */
+static Uint32 board_compute_extended_openmp(GameContainer * game)
+{
+    const Uint32 height = game_board(game)->height;
+    const size_t ring = (size_t)(2 * gRule.range + 1) * (game->width + 1);
+
+    if (openmp_serial())
+    {
+        return board_compute_extended(game);
+    }
+    #pragma omp parallel shared(game)
+    {
+        const Uint32 count = omp_get_num_threads();
+        const Uint32 band = omp_get_thread_num();
+
+        board_compute_extended_band(game, (Uint32)((Uint64)height * band / count),
+                                    (Uint32)((Uint64)height * (band + 1) / count), game->ruleSums + ring * band);
+    }
+    return 1;
+}
+
+/**
+ * Compute a rectangle of the board
+ * @param board The current generation
+ * @param next The next generation
+ * @param x First column (a multiple of 64 for packed boards)
+ * @param y First row
+ * @param width Number of columns, clipped to the board
+ * @param height Number of rows, clipped to the board
+ */
+static void board_compute_tile(const Board * board, Board * next, Uint32 x, Uint32 y, Uint32 width, Uint32 height)
+{
+    register Uint32 row;
+    const Uint32 right = x + width < board->width ? x + width : board->width;
+    const Uint32 bottom = y + height < board->height ? y + height : board->height;
+
+    for (row = y; row < bottom; row++)
+    {
+        if (board->format == BOARD_PACKED)
+        {
+            Uint64 * result = board_packed_row(next, row);
+            board_compute_packed_span(board_packed_row(board, (int)row - 1), board_packed_row(board, row),
+                                      board_packed_row(board, row + 1), result, x / 64, (right + 63) / 64);
+            if (right == board->width)
+            {
+                board_packed_mask_tail(board, result);
+            }
+        }
+        else
+        {
+            board_compute_span(board_row(board, (int)row - 1), board_row(board, row),
+                               board_row(board, row + 1), board_row(next, row), x, right);
+        }
+    }
+}
+
+/**
+ * Pick a tile size so a tile of both generations fits in half of the L2
+ * cache. Tiles are wide (a few cache lines) to keep the streams long.
+ * @param game
+ * @param size Requested tile side in cells, 0 for automatic
+ */
+static void game_set_block_size(GameContainer * game, Uint32 size)
+{
+    long cache = sysconf(_SC_LEVEL2_CACHE_SIZE);
+    const Uint32 cellsPerByte = game->format == BOARD_PACKED ? 8 : 1;
+    Uint32 width, height;
+
+    if (cache <= 0)
+    {
+        cache = 256 * 1024;
+    }
+
+    if (size)
+    {
+        width = height = size;
+    }
+    else
+    {
+        width = 2048 * cellsPerByte;
+        if (width > game->width)
+        {
+            width = game->width;
+        }
+        // Rows of the source (plus the two halo rows) and rows of the result
+        height = (Uint32)((cache / 2) / (2 * ((width + cellsPerByte - 1) / cellsPerByte)));
+        height = height > 2 ? height - 2 : 1;
+        // A taller tile only clears more scratch rows for --temporal
+        if (height > game->height)
+        {
+            height = game->height;
+        }
+    }
+
+    // Packed tiles start on a word
+    if (game->format == BOARD_PACKED)
+    {
+        width = (width + 63) & ~63U;
+    }
+    game->blockWidth = width;
+    game->blockHeight = height;
+}
+
+/**
+ * Do the computation tile by tile with OpenMP. The whole generation is a
+ * single parallel region, the tiles are handed out by the schedule given
+ * with --schedule (static by default).
+ * @param game
+ * @return 1, a single generation is computed
+ */
+static Uint32 board_compute_tiled(GameContainer * game)
+{
+    int t;
+    const Board * board = game_board(game);
+    Board * next = game_next_board(game);
+    const Uint32 blockWidth = game->blockWidth;
+    const Uint32 blockHeight = game->blockHeight;
+    const int tilesX = (int)((board->width + blockWidth - 1) / blockWidth);
+    const int tiles = tilesX * (int)((board->height + blockHeight - 1) / blockHeight);
+
+    if (openmp_serial())
+    {
+        ThreadCounters * counters = counters_enter(game, 0);
+        for (t = 0; t < tiles; t++)
+        {
+            board_compute_tile(board, next, (t % tilesX) * blockWidth, (t / tilesX) * blockHeight, blockWidth, blockHeight);
+            counters_rect(counters, next, (t % tilesX) * blockWidth, (t / tilesX) * blockHeight, blockWidth, blockHeight);
+        }
+        counters_leave(counters);
+        return 1;
+    }
+    // Row-major order: with the static schedule each thread gets a band of
+    // rows, the same one board_first_touch gave it
+    #pragma omp parallel
+    {
+        ThreadCounters * counters = counters_enter(game, omp_get_thread_num());
+        #pragma omp for schedule(runtime) nowait
+        for (t = 0; t < tiles; t++)
+        {
+            board_compute_tile(board, next, (t % tilesX) * blockWidth, (t / tilesX) * blockHeight, blockWidth, blockHeight);
+            counters_rect(counters, next, (t % tilesX) * blockWidth, (t / tilesX) * blockHeight, blockWidth, blockHeight);
+        }
+        counters_leave(counters);
+    }
+    
+    return 1;
+}
+
+/**
+ * Copy a rectangle of cells between two boards of the same format
+ * @param dst Destination board
+ * @param dx Destination column (a multiple of 64 for packed boards)
+ * @param dy Destination row
+ * @param src Source board
+ * @param sx Source column (a multiple of 64 for packed boards)
+ * @param sy Source row
+ * @param width Number of columns (the last word is copied whole when packed)
+ * @param height Number of rows
+ */
+static void board_copy_rect(Board * dst, Uint32 dx, Uint32 dy, const Board * src, Uint32 sx, Uint32 sy, Uint32 width, Uint32 height)
+{
+    register Uint32 row;
+
+    for (row = 0; row < height; row++)
+    {
+        if (src->format == BOARD_PACKED)
+        {
+            memcpy(board_packed_row(dst, dy + row) + dx / 64, board_packed_row(src, sy + row) + sx / 64, (width + 63) / 64 * sizeof(Uint64));
+        }
+        else
+        {
+            memcpy(board_row(dst, dy + row) + dx, board_row(src, sy + row) + sx, width);
+        }
+    }
+}
+
+/**
+ * Advance one tile by several generations in a private scratch area.
+ * The tile is loaded with a halo as wide as the depth: each generation the
+ * valid part shrinks by one cell on every side, so after depth generations
+ * exactly the tile is right. Only the cells inside the board are computed,
+ * the outside world stays dead as in the other compute functions.
+ * @param board The current generation
+ * @param next Receive the tile after depth generations
+ * @param scratch Two scratch boards of at least (width + 2 * halo) x (height + 2 * depth)
+ * @param x First column of the tile (a multiple of 64 for packed boards)
+ * @param y First row of the tile
+ * @param width Number of columns of the tile
+ * @param height Number of rows of the tile
+ * @param depth Number of generations
+ */
+static void board_compute_temporal_tile(const Board * board, Board * next, Board scratch[2],
+                                        Uint32 x, Uint32 y, Uint32 width, Uint32 height, Uint32 depth)
+{
+    register Uint32 step, row;
+    int current = 0;
+    // Packed scratch areas must start on a word
+    const Uint32 halo = board->format == BOARD_PACKED ? (depth + 63) & ~63U : depth;
+    // Scratch origin in board coordinates (may be outside of the board)
+    const int originX = (int)x - (int)halo;
+    const int originY = (int)y - (int)depth;
+    // Part of the scratch area which lies inside the board
+    const Uint32 left = originX < 0 ? (Uint32)-originX : 0;
+    const Uint32 top = originY < 0 ? (Uint32)-originY : 0;
+    const Uint32 right = (x + width + halo < board->width ? x + width + halo : board->width) - originX;
+    const Uint32 bottom = (y + height + depth < board->height ? y + height + depth : board->height) - originY;
+    const Uint32 rowBytes = board_row_bytes(&scratch[0]);
+    // Bytes of a scratch row before and after the cells inside the board
+    const Uint32 leftBytes = board->format == BOARD_PACKED ? left / 64 * sizeof(Uint64) : left;
+    const Uint32 rightBytes = board->format == BOARD_PACKED ? (right + 63) / 64 * sizeof(Uint64) : right;
+
+    if (x + width > board->width)
+    {
+        width = board->width - x;
+    }
+    if (y + height > board->height)
+    {
+        height = board->height - y;
+    }
+
+    // Load the tile and its halo, everything outside of the board is dead.
+    // The rest is loaded or computed before it is read: an inner tile clears nothing.
+    for (row = 0; row < scratch[0].height; row++)
+    {
+        if (row < top || row >= bottom)
+        {
+            memset(board_row(&scratch[0], row), 0, rowBytes);
+            memset(board_row(&scratch[1], row), 0, rowBytes);
+        }
+        else
+        {
+            memset(board_row(&scratch[0], row), 0, leftBytes);
+            memset(board_row(&scratch[1], row), 0, leftBytes);
+            memset(board_row(&scratch[0], row) + rightBytes, 0, rowBytes - rightBytes);
+            memset(board_row(&scratch[1], row) + rightBytes, 0, rowBytes - rightBytes);
+        }
+    }
+    board_copy_rect(&scratch[0], left, top, board, originX + left, originY + top, right - left, bottom - top);
+
+    for (step = 1; step <= depth; step++)
+    {
+        // The rows near the scratch border are wrong after this step, skip them
+        const Uint32 first = step > top ? step : top;
+        const Uint32 last = scratch[0].height - step < bottom ? scratch[0].height - step : bottom;
+        const Board * from = &scratch[current];
+        Board * to = &scratch[current ^ 1];
+
+        for (row = first; row < last; row++)
+        {
+            if (board->format == BOARD_PACKED)
+            {
+                Uint64 * result = board_packed_row(to, row);
+                board_compute_packed_span(board_packed_row(from, (int)row - 1), board_packed_row(from, row),
+                                          board_packed_row(from, row + 1), result, left / 64, (right + 63) / 64);
+                // Beyond the right edge of the board the cells are dead
+                if (right & 63)
+                {
+                    result[right / 64] &= ((Uint64)1 << (right & 63)) - 1;
+                }
+            }
+            else
+            {
+                board_compute_span(board_row(from, (int)row - 1), board_row(from, row),
+                                   board_row(from, row + 1), board_row(to, row), left, right);
+            }
+        }
+        current ^= 1;
+    }
+
+    board_copy_rect(next, x, y, &scratch[current], halo, depth, width, height);
+}
+
+/**
+ * Room for the scratch tiles of the temporal blocking: two boards of
+ * (blockWidth + 2 * halo) x (blockHeight + 2 * depth) per thread
+ * @param game
+ */
+static size_t game_scratch_size(const GameContainer * game)
+{
+    const Uint32 depth = game->temporalDepth;
+    const Uint32 halo = game->format == BOARD_PACKED ? (depth + 63) & ~63U : depth;
+
+    return 2 * arena_round(board_size(game->blockWidth + 2 * halo, game->blockHeight + 2 * depth, game->format)) * omp_get_max_threads();
+}
+
+/**
+ * Do several generations per tile before writing back (temporal blocking).
+ * The board is swept once for game->temporalDepth generations instead of
+ * once per generation, the tiles and their halo stay in the cache.
+ * @param game
+ * @return The number of generations computed (game->temporalDepth)
+ */
+static Uint32 board_compute_temporal(GameContainer * game)
+{
+    const Board * board = game_board(game);
+    Board * next = game_next_board(game);
+    const Uint32 depth = game->temporalDepth;
+    const Uint32 blockWidth = game->blockWidth;
+    const Uint32 blockHeight = game->blockHeight;
+    const Uint32 halo = board->format == BOARD_PACKED ? (depth + 63) & ~63U : depth;
+    const int tilesX = (int)((board->width + blockWidth - 1) / blockWidth);
+    const int tiles = tilesX * (int)((board->height + blockHeight - 1) / blockHeight);
+    const size_t size = arena_round(board_size(blockWidth + 2 * halo, blockHeight + 2 * depth, board->format));
+
+    if ( ! depth)
+    {
+        return 0;
+    }
+
+    // Carved once, unless a later sweep is deeper
+    if (game_scratch_size(game) > game->scratchSize)
+    {
+        game->scratchSize = game_scratch_size(game);
+        game->scratch = (Uint8 *)arena_alloc(game->arena, game->scratchSize);
+        if ( ! game->scratch)
+        {
+            fprintf(stderr, "Not enough memory for the temporal blocking scratch tiles\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    if (openmp_serial())
+    {
+        int t;
+        Board scratch[2];
+        ThreadCounters * counters = counters_enter(game, 0);
+        board_init(&scratch[0], blockWidth + 2 * halo, blockHeight + 2 * depth, board->format, game->scratch);
+        board_init(&scratch[1], blockWidth + 2 * halo, blockHeight + 2 * depth, board->format, game->scratch + size);
+        for (t = 0; t < tiles; t++)
+        {
+            board_compute_temporal_tile(board, next, scratch, (t % tilesX) * blockWidth, (t / tilesX) * blockHeight,
+                                        blockWidth, blockHeight, depth);
+            counters_rect(counters, next, (t % tilesX) * blockWidth, (t / tilesX) * blockHeight, blockWidth, blockHeight);
+        }
+        counters_leave(counters);
+        return depth;
+    }
+    #pragma omp parallel
+    {
+        int t;
+        Board scratch[2];
+        Uint8 * memory = game->scratch + 2 * size * omp_get_thread_num();
+        ThreadCounters * counters = counters_enter(game, omp_get_thread_num());
+        board_init(&scratch[0], blockWidth + 2 * halo, blockHeight + 2 * depth, board->format, memory);
+        board_init(&scratch[1], blockWidth + 2 * halo, blockHeight + 2 * depth, board->format, memory + size);
+
+        #pragma omp for schedule(runtime) nowait
+        for (t = 0; t < tiles; t++)
+        {
+            board_compute_temporal_tile(board, next, scratch, (t % tilesX) * blockWidth, (t / tilesX) * blockHeight,
+                                        blockWidth, blockHeight, depth);
+            counters_rect(counters, next, (t % tilesX) * blockWidth, (t / tilesX) * blockHeight, blockWidth, blockHeight);
+        }
+        counters_leave(counters);
+    }
+    
+    return depth;
+}
+
+/**
+ * Tell if a tile of the next generation differs from the current one
+ * @param board The current generation
+ * @param next The next generation
+ * @param x First column (a multiple of 64)
+ * @param y First row
+ * @param width Number of columns, clipped to the board
+ * @param height Number of rows, clipped to the board
+ * @return 1 if at least a cell changed
+ */
+static int board_tile_changed(const Board * board, const Board * next, Uint32 x, Uint32 y, Uint32 width, Uint32 height)
+{
+    register Uint32 row;
+    const Uint32 right = x + width < board->width ? x + width : board->width;
+    const Uint32 bottom = y + height < board->height ? y + height : board->height;
+    const Uint32 offset = board->format == BOARD_PACKED ? x / 8 : x;
+    const Uint32 bytes = board->format == BOARD_PACKED ? (right + 63) / 64 * sizeof(Uint64) - offset : right - x;
+
+    for (row = y; row < bottom; row++)
+    {
+        if (memcmp(board_row(board, row) + offset, board_row(next, row) + offset, bytes))
+        {
+            return Yes;
+        }
+    }
+    return No;
+}
+
+/**
+ * Allocate the tile map of the active region tracking
+ * @param game
+ */
+static void game_create_activity(GameContainer * game)
+{
+    const Board * board = game_board(game);
+
+    game->tilesX = (board->width + kActiveTileSize - 1) / kActiveTileSize;
+    game->tilesY = (board->height + kActiveTileSize - 1) / kActiveTileSize;
+    game->changedTiles = (Uint8 *)arena_alloc(game->arena, (size_t)game->tilesX * game->tilesY);
+    game->activeList = (Uint32 *)arena_alloc(game->arena, sizeof(Uint32) * game->tilesX * game->tilesY);
+    if ( ! game->changedTiles || ! game->activeList)
+    {
+        fprintf(stderr, "Not enough memory for the tile map\n");
+        exit(EXIT_FAILURE);
+    }
+    memset(game->changedTiles, 0, (size_t)game->tilesX * game->tilesY);
+    game->activityReset = Yes;
+    // The counters follow the population tile by tile, from scratch
+    if (game->counters)
+    {
+        game->tilePopulation = (Uint32 *)arena_alloc(game->arena, sizeof(Uint32) * game->tilesX * game->tilesY);
+        if ( ! game->tilePopulation)
+        {
+            fprintf(stderr, "Not enough memory for the tile map\n");
+            exit(EXIT_FAILURE);
+        }
+        memset(game->tilePopulation, 0, sizeof(Uint32) * game->tilesX * game->tilesY);
+        game->population = 0;
+    }
+}
+
+/**
+ * Mix the bits of a 64-bit value (finalizer of splitmix64)
+ * @param x
+ */
+static inline Uint64 hash_mix(Uint64 x)
+{
+    x ^= x >> 30;
+    x *= 0xBF58476D1CE4E5B9ULL;
+    x ^= x >> 27;
+    x *= 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+/**
+ * Get 64 cells of a row as bits (cell x in bit 0), whatever the storage
+ * @param board
+ * @param x First cell, a multiple of 64
+ * @param y Row
+ */
+static inline Uint64 board_row_bits(const Board * board, Uint32 x, Uint32 y)
+{
+    Uint64 bits = 0;
+    Uint32 i;
+    
+    if (board->format == BOARD_PACKED)
+    {
+        return board_packed_row(board, y)[x >> 6];
+    }
+    else
+    {
+        const Uint8 * row = board_row(board, y) + x;
+        const Uint32 count = board->width - x < 64 ? board->width - x : 64;
+        for (i = 0; i < count; i++)
+        {
+            bits |= (Uint64)row[i] << i;
+        }
+    }
+    return bits;
+}
+
+/**
+ * Copy the cells of a board into another of the same size, whatever their
+ * storages. The halo is not copied.
+ * @param dst
+ * @param src
+ */
+static void board_convert(Board * dst, const Board * src)
+{
+    int y;
+    const int height = (int)src->height;
+    
+    #pragma omp parallel for schedule(static)
+    for (y = 0; y < height; y++)
+    {
+        Uint32 x, i;
+        
+        if (dst->format == src->format)
+        {
+            memcpy(board_row(dst, y), board_row(src, y), board_row_bytes(src));
+            continue;
+        }
+        for (x = 0; x < src->width; x += 64)
+        {
+            const Uint64 bits = board_row_bits(src, x, y);
+            if (dst->format == BOARD_PACKED)
+            {
+                board_packed_row(dst, y)[x >> 6] = bits;
+            }
+            else
+            {
+                Uint8 * cells = board_row(dst, y) + x;
+                const Uint32 count = src->width - x < 64 ? src->width - x : 64;
+                for (i = 0; i < count; i++)
+                {
+                    cells[i] = (bits >> i) & 1;
+                }
+            }
+        }
+    }
+}
+
+/**
+ * Hash of a 64x64 tile. Two boards holding the same cells give the same
+ * hashes, whatever their storage.
+ * @param board
+ * @param tx, ty Tile coordinates
+ */
+static Uint64 board_tile_hash(const Board * board, Uint32 tx, Uint32 ty)
+{
+    Uint32 y;
+    const Uint32 bottom = (ty + 1) * kActiveTileSize < board->height ? (ty + 1) * kActiveTileSize : board->height;
+    Uint64 hash = hash_mix((Uint64)ty << 32 | tx);
+    
+    for (y = ty * kActiveTileSize; y < bottom; y++)
+    {
+        hash = hash_mix(hash ^ board_row_bits(board, tx * kActiveTileSize, y));
+    }
+    return hash;
+}
+
+/**
+ * Hash every tile of a board
+ * @param board
+ * @param tiles One hash per tile, row by row
+ * @return The hash of the board: the sum of the tiles
+ */
+static Uint64 board_hash(const Board * board, Uint64 * tiles)
+{
+    int i;
+    const Uint32 tilesX = (board->width + kActiveTileSize - 1) / kActiveTileSize;
+    const int count = (int)(tilesX * ((board->height + kActiveTileSize - 1) / kActiveTileSize));
+    Uint64 sum = 0;
+    
+    if (openmp_serial())
+    {
+        for (i = 0; i < count; i++)
+        {
+            tiles[i] = board_tile_hash(board, i % tilesX, i / tilesX);
+            sum += tiles[i];
+        }
+        return sum;
+    }
+    #pragma omp parallel for schedule(static) reduction(+:sum)
+    for (i = 0; i < count; i++)
+    {
+        tiles[i] = board_tile_hash(board, i % tilesX, i / tilesX);
+        sum += tiles[i];
+    }
+    return sum;
+}
+
+/**
+ * Hash of the current board of the game, to compare boards or to find a
+ * cycle. When the active tracking says which tiles changed since the last
+ * call, one generation ago, only those are hashed again.
+ * @param game
+ */
+static Uint64 game_hash(GameContainer * game)
+{
+    const Board * board = game_board(game);
+    const Uint32 tilesX = (board->width + kActiveTileSize - 1) / kActiveTileSize;
+    const Uint32 count = tilesX * ((board->height + kActiveTileSize - 1) / kActiveTileSize);
+    Uint32 i;
+    
+    if ( ! game->tileHashes)
+    {
+        game->tileHashes = (Uint64 *)arena_alloc(game->arena, sizeof(Uint64) * count);
+        if ( ! game->tileHashes)
+        {
+            fprintf(stderr, "Not enough memory for the tile hashes\n");
+            exit(EXIT_FAILURE);
+        }
+        game->hashValid = No;
+    }
+    
+    if (game->hashValid && game->changedTiles && game->generation == game->hashGeneration + 1)
+    {
+        for (i = 0; i < count; i++)
+        {
+            if (game->changedTiles[i])
+            {
+                const Uint64 hash = board_tile_hash(board, i % tilesX, i / tilesX);
+                game->boardHash += hash - game->tileHashes[i];
+                game->tileHashes[i] = hash;
+            }
+        }
+    }
+    else if ( ! game->hashValid || game->generation != game->hashGeneration)
+    {
+        game->boardHash = board_hash(board, game->tileHashes);
+    }
+    game->hashGeneration = game->generation;
+    game->hashValid = Yes;
+    return game->boardHash;
+}
+
+/**
+ * Compute an active tile and tell if it changed
+ * @param game
+ * @param counters Counters of the thread, NULL when nothing is counted
+ * @param tile Index of the tile, row by row
+ */
+static void board_compute_active_tile(GameContainer * game, ThreadCounters * counters, Uint32 tile)
+{
+    const Board * board = game_board(game);
+    Board * next = game_next_board(game);
+    const Uint32 tx = (tile % game->tilesX) * kActiveTileSize;
+    const Uint32 ty = (tile / game->tilesX) * kActiveTileSize;
+
+    board_compute_tile(board, next, tx, ty, kActiveTileSize, kActiveTileSize);
+    game->changedTiles[tile] = board_tile_changed(board, next, tx, ty, kActiveTileSize, kActiveTileSize);
+    if (counters)
+    {
+        const Sint64 before = counters->population;
+        Uint32 population;
+        counters->counting = Yes;
+        counters_rect(counters, next, tx, ty, kActiveTileSize, kActiveTileSize);
+        population = (Uint32)(counters->population - before);
+        counters->population -= game->tilePopulation[tile];
+        game->tilePopulation[tile] = population;
+    }
+}
+
+/**
+ * Do the computation on the active tiles only. A tile is active when itself
+ * or one of its 8 neighbours changed during the last generation, any other
+ * tile can't change. A skipped tile is left as is in the back buffer: it
+ * did not change during the previous generation either, so the back buffer
+ * already holds the right cells.
+ * @param game
+ * @return 1, a single generation is computed
+ */
+static Uint32 board_compute_active(GameContainer * game)
+{
+    int i;
+    Uint32 x, y;
+    Uint8 * changed;
+    Uint32 * list;
+    int count = 0;
+
+    if ( ! game->changedTiles)
+    {
+        game_create_activity(game);
+    }
+    changed = game->changedTiles;
+    list = game->activeList;
+
+    // Collect the tiles to compute from what changed last time
+    for (y = 0; y < game->tilesY; y++)
+    {
+        const Uint8 * above = y ? changed + (y - 1) * game->tilesX : NULL;
+        const Uint8 * current = changed + y * game->tilesX;
+        const Uint8 * below = y + 1 < game->tilesY ? changed + (y + 1) * game->tilesX : NULL;
+
+        for (x = 0; x < game->tilesX; x++)
+        {
+            const Uint32 l = x ? x - 1 : x;
+            const Uint32 r = x + 1 < game->tilesX ? x + 1 : x;
+            int active = game->activityReset || current[l] | current[x] | current[r];
+
+            if (above)
+            {
+                active |= above[l] | above[x] | above[r];
+            }
+            if (below)
+            {
+                active |= below[l] | below[x] | below[r];
+            }
+            if (active)
+            {
+                list[count++] = y * game->tilesX + x;
+            }
+        }
+    }
+    game->activityReset = No;
+    game->activeCount = count;
+    memset(changed, 0, (size_t)game->tilesX * game->tilesY);
+
+    if (openmp_serial())
+    {
+        ThreadCounters * counters = game->tilePopulation ? counters_enter(game, 0) : NULL;
+        for (i = 0; i < count; i++)
+        {
+            board_compute_active_tile(game, counters, list[i]);
+        }
+        counters_leave(counters);
+        return 1;
+    }
+    #pragma omp parallel
+    {
+        // The tiles left out are the same in both boards: only the change of the population is counted
+        ThreadCounters * counters = game->tilePopulation ? counters_enter(game, omp_get_thread_num()) : NULL;
+        #pragma omp for schedule(dynamic, 16) nowait
+        for (i = 0; i < count; i++)
+        {
+            board_compute_active_tile(game, counters, list[i]);
+        }
+        counters_leave(counters);
+    }
+    
+    return 1;
+}
+
+/**
+ * Worker thread main loop: wait for a job, do its band, report, again.
+ * @param data The ThreadArg of the worker
+ */
+static void * worker_main(void * data)
+{
+    ThreadArg * arg = (ThreadArg *)data;
+    WorkerPool * pool = arg->pool;
+
+    for (;;)
+    {
+        pthread_barrier_wait(&pool->start);
+        if (pool->quit)
+        {
+            break;
+        }
+        pool->job(pool->game, arg->i);
+        pthread_barrier_wait(&pool->done);
+    }
+    return NULL;
+}
+
+/**
+ * Start the worker threads. They live until worker_pool_dispose.
+ * @param count Number of bands, the calling thread does one of them
+ * @return The pool, NULL if it could not be allocated or synchronized
+ */
+static WorkerPool * worker_pool_create(Uint32 count)
+{
+    Uint32 i;
+    WorkerPool * pool = (WorkerPool *)calloc(1, sizeof(WorkerPool));
+
+    if ( ! pool)
+    {
+        return NULL;
+    }
+    pool->count = count ? count : 1;
+    pool->workers = (ThreadArg *)calloc(pool->count, sizeof(ThreadArg));
+    if ( ! pool->workers || pthread_barrier_init(&pool->start, NULL, pool->count))
+    {
+        free(pool->workers);
+        free(pool);
+        return NULL;
+    }
+    if (pthread_barrier_init(&pool->done, NULL, pool->count))
+    {
+        pthread_barrier_destroy(&pool->start);
+        free(pool->workers);
+        free(pool);
+        return NULL;
+    }
+
+    // Worker 0 is the caller
+    for (i = 1; i < pool->count; i++)
+    {
+        pool->workers[i].pool = pool;
+        pool->workers[i].i = i;
+        if (pthread_create(&pool->workers[i].thread, NULL, worker_main, &pool->workers[i]))
+        {
+            fprintf(stderr, "Unable to start worker %u\n", i);
+            exit(EXIT_FAILURE);
+        }
+    }
+    return pool;
+}
+
+/**
+ * Run a job on all the bands and wait for its end
+ * @param pool
+ * @param job The function run on each band
+ * @param game
+ * @param rows Number of rows to split
+ */
+static void worker_pool_run(WorkerPool * pool, WorkerJobFunc job, GameContainer * game, Uint32 rows)
+{
+    pool->job = job;
+    pool->game = game;
+    pool->rows = rows;
+
+    pthread_barrier_wait(&pool->start);
+    job(game, 0);
+    pthread_barrier_wait(&pool->done);
+}
+
+/**
+ * Get the contiguous band of rows of a worker in the current job
+ * @param pool
+ * @param band Number of the worker
+ * @param first Out: first row
+ * @param last Out: last row (excluded)
+ */
+static void worker_pool_band(const WorkerPool * pool, Uint32 band, Uint32 * first, Uint32 * last)
+{
+    *first = (Uint32)((Uint64)pool->rows * band / pool->count);
+    *last = (Uint32)((Uint64)pool->rows * (band + 1) / pool->count);
+}
+
+/**
+ * Stop and join the worker threads
+ * @param pool
+ */
+static void worker_pool_dispose(WorkerPool * pool)
+{
+    Uint32 i;
+
+    pool->quit = Yes;
+    pthread_barrier_wait(&pool->start);
+    for (i = 1; i < pool->count; i++)
+    {
+        pthread_join(pool->workers[i].thread, NULL);
+    }
+    pthread_barrier_destroy(&pool->start);
+    pthread_barrier_destroy(&pool->done);
+    free(pool->workers);
+    free(pool);
+}
+
+/**
+ * Compute a band of rows with the row kernel of the game
+ * @param game
+ * @param band Number of the worker
+ */
+static void board_compute_band(GameContainer * game, Uint32 band)
+{
+    register Uint32 i;
+    Uint32 first, last;
+    const Board * board = game_board(game);
+    Board * next = game_next_board(game);
+    const ComputeRowFunc func = game->computeRowFunc;
+    ThreadCounters * counters = counters_enter(game, band);
+
+    worker_pool_band(game->pool, band, &first, &last);
+    for (i = first; i < last; i++)
+    {
+        func(board, next, i);
+        counters_rect(counters, next, 0, i, next->width, 1);
+    }
+    counters_leave(counters);
+}
+
+/**
+ * Do the computation with the persistent worker threads, each one on its
+ * own contiguous band of rows
+ * @param game
+ * @return 1, a single generation is computed
+ */
+static Uint32 board_compute_multithread(GameContainer * game)
+{
+    worker_pool_run(game->pool, board_compute_band, game, game_board(game)->height);
+    
+    return 1;
+}
+
+/*
+ * Live metrics (--metrics). The thread which steps the game keeps them up to
+ * date and, every kMetricsPublish nanoseconds, copies them under the lock for
+ * the server thread, which writes them in the Prometheus text format.
+ */
+const Uint64 kMetricsPublish = 100000000ULL;
+
+// Upper bounds in seconds of the buckets of the phase histograms, +Inf comes after
+static const double kMetricsBounds[] = { 1e-6, 3e-6, 1e-5, 3e-5, 1e-4, 3e-4, 1e-3, 3e-3, 1e-2, 3e-2, 0.1, 0.3, 1 };
+
+/**
+ * Latencies of a phase: a count per bucket (not cumulated), their sum and count
+ */
+typedef struct MetricsHistogram
+{
+    Uint64 buckets[sizeof(kMetricsBounds) / sizeof(kMetricsBounds[0]) + 1];
+    Uint64 sum;                         // Nanoseconds
+    Uint64 count;
+} MetricsHistogram;
+
+/**
+ * The values of the stepping thread, live or as published
+ */
+typedef struct MetricsValues
+{
+    Uint64 clock;                       // When they were taken, nanoseconds on the monotonic clock
+    Uint64 generations;
+    double rate;                        // Generations per second since the previous copy
+    Sint64 population;                  // -1 when the backend can't tell (--opengl)
+    Sint64 activeTiles;                 // -1 without the active tracking
+    Uint64 tiles;
+    Uint64 arenaSize;                   // Bytes of the simulation storage, reserved and handed out
+    Uint64 arenaUsed;
+} MetricsValues;
+
+struct Metrics
+{
+    pthread_mutex_t lock;               // Guards the published values
+    pthread_t thread;                   // The server
+    int listener;                       // Its socket
+    int quit;
+    char address[64];                   // As given to --metrics
+    Uint32 threads;                     // Thread counters (see ThreadCounters)
+    MetricsValues step;                 // Kept by the thread which steps the game
+    MetricsHistogram compute;           // Its generations
+    Uint64 * busy;                      // Nanoseconds of each thread, since the start
+    Uint64 * cells;                     // Cells computed by each thread
+    MetricsHistogram frame[PROFILE_SCOPES]; // Kept by the main loop, all the phases but the compute one
+    Uint64 framePublished;              // When the main loop copied them last
+    MetricsValues shown;                // The copies read by the server
+    MetricsHistogram phases[PROFILE_SCOPES];
+    Uint64 * shownBusy;
+    Uint64 * shownCells;
+    double * utilization;               // Busy part of each thread between the last two copies
+    char * response;                    // Room for the response, no allocation per request
+    size_t responseSize;
+};
+
+/**
+ * Add a latency to a histogram
+ * @param histogram
+ * @param nanoseconds
+ */
+static inline void metrics_observe(MetricsHistogram * histogram, Uint64 nanoseconds)
+{
+    Uint32 i = 0;
+
+    while (i < sizeof(kMetricsBounds) / sizeof(kMetricsBounds[0]) && nanoseconds > kMetricsBounds[i] * 1e9)
+    {
+        i++;
+    }
+    histogram->buckets[i]++;
+    histogram->sum += nanoseconds;
+    histogram->count++;
+}
+
+/**
+ * Copy the values of the stepping thread for the server
+ * @param metrics
+ * @param now
+ */
+static void metrics_publish(Metrics * metrics, Uint64 now)
+{
+    MetricsValues * step = &metrics->step;
+    const double elapsed = (now - metrics->shown.clock) * 1e-9;
+    Uint32 i;
+
+    step->clock = now;
+    pthread_mutex_lock(&metrics->lock);
+    step->rate = metrics->shown.clock ? (step->generations - metrics->shown.generations) / elapsed : 0;
+    for (i = 0; i < metrics->threads; i++)
+    {
+        metrics->utilization[i] = metrics->shown.clock ? (metrics->busy[i] - metrics->shownBusy[i]) * 1e-9 / elapsed : 0;
+    }
+    metrics->shown = *step;
+    metrics->phases[PROFILE_COMPUTE] = metrics->compute;
+    memcpy(metrics->shownBusy, metrics->busy, metrics->threads * sizeof(Uint64));
+    memcpy(metrics->shownCells, metrics->cells, metrics->threads * sizeof(Uint64));
+    pthread_mutex_unlock(&metrics->lock);
+}
+
+/**
+ * Merge the counters of the threads after a generation, and count it. On
+ * the generations which are published, the population comes from the
+ * counters when the backend keeps them, else from the board; --active keeps
+ * it on every generation from the changes of its tiles.
+ * @param game
+ * @param start Clock before the generation was computed
+ */
+static void metrics_step(GameContainer * game, Uint64 start)
+{
+    Metrics * metrics = game->metrics;
+    MetricsValues * step = &metrics->step;
+    const Uint64 now = profile_now();
+    Sint64 population = 0;
+    Uint64 cells = 0;
+    Uint32 i;
+
+    for (i = 0; i < game->counterCount; i++)
+    {
+        ThreadCounters * counters = &game->counters[i];
+        population += counters->population;
+        cells += counters->cells;
+        metrics->busy[i] += counters->busy;
+        metrics->cells[i] += counters->cells;
+        counters->population = 0;
+        counters->cells = 0;
+        counters->busy = 0;
+    }
+    if (game->tilePopulation && game->computeBoardFunc == board_compute_active)
+    {
+        game->population += population;
+    }
+    else if (game->countPopulation && cells)
+    {
+        game->population = population;
+    }
+    else if (game->countPopulation)
+    {
+        game->population = game->gpu ? -1 : (Sint64)board_population(game_board(game));
+    }
+
+    metrics_observe(&metrics->compute, now - start);
+    step->generations = game->generation;
+    step->population = game->population;
+    step->activeTiles = game->changedTiles ? (Sint64)game->activeCount : -1;
+    step->tiles = (Uint64)game->tilesX * game->tilesY;
+    step->arenaSize = game->arena ? game->arena->size : 0;
+    step->arenaUsed = game->arena ? game->arena->used : 0;
+    if (game->countPopulation)
+    {
+        metrics_publish(metrics, now);
+    }
+}
+
+/**
+ * Compute the next generation and make it the current one.
+ * No copy: the buffers are swapped.
+ * @param game
+ */
+static void game_step(GameContainer * game)
+{
+    const int previous = game->current;
+    const Uint64 start = game->metrics ? profile_now() : 0;
+    
+    // The generation which is published is counted in full
+    game->countPopulation = game->metrics && start - game->metrics->step.clock >= kMetricsPublish;
+    board_fill_halo(game_board(game), game->topology);
+    game->generation += game->computeBoardFunc(game);
+    game->current = game->next;
+    game->next = previous;
+    if (game->metrics)
+    {
+        metrics_step(game, start);
+    }
+}
+
+/**
+ * HashLife quadtree node. A node of level n is a square of 2^n cells. Level 3
+ * nodes are leaves holding 8x8 cells, the others have four children of
+ * level n - 1. Nodes are hash-consed: two equal squares are the same node,
+ * so a repeated area is stored (and computed) once.
+ */
+typedef struct LifeNode LifeNode;
+struct LifeNode
+{
+    LifeNode * nw, * ne, * sw, * se;    // Children, NULL for a leaf
+    LifeNode * result;                  // Memoized center after 2^resultStep generations
+    LifeNode * next;                    // Next node of the hash bucket (or of the free list)
+    Uint64 bits;                        // Leaf cells, bit y * 8 + x
+    Uint64 population;                  // Living cells in the square
+    Uint8 level;
+    Uint8 resultStep;
+    Uint8 mark;                         // Reachable flag of the garbage collector
+};
+
+#define LIFE_MAX_LEVEL 63               // Largest root: its coordinates still fit a Sint64
+
+/**
+ * HashLife universe: the node table, the node pool and the root.
+ * The root is centered on the origin and covers [-2^(level-1), 2^(level-1)).
+ */
+typedef struct HashLife
+{
+    LifeNode ** buckets;                // Hash table of every living node
+    Uint64 bucketCount;                 // Always a power of 2
+    Uint64 nodeCount;                   // Nodes in the hash table
+    LifeNode ** blocks;                 // The pool: nodes are allocated by blocks
+    Uint32 blockCount;
+    Uint32 blockUsed;                   // Nodes handed out from the last block
+    LifeNode * freeList;                // Nodes given back by the garbage collector
+    LifeNode * empty[LIFE_MAX_LEVEL + 1]; // Canonical empty node of each level
+    LifeNode * root;
+    Uint64 generation;
+    size_t memoryCap;                   // Collect the garbage beyond this amount of nodes
+    Uint32 collections;                 // Number of garbage collections
+    Uint64 survivors;                   // Nodes left by the last collection
+} HashLife;
+
+const Uint32 kLifeNodeBlock = 65536;    // Nodes per pool block
+const Uint32 kLifeLeafLevel = 3;        // Leaves are 8x8
+
+/**
+ * Hash of a node content
+ */
+static inline Uint64 hashlife_hash(const LifeNode * nw, const LifeNode * ne, const LifeNode * sw, const LifeNode * se, Uint64 bits)
+{
+    Uint64 h = bits * 0x9E3779B97F4A7C15ULL;
+    h ^= (Uint64)(uintptr_t)nw * 0xC2B2AE3D27D4EB4FULL;
+    h ^= ((Uint64)(uintptr_t)ne * 0x165667B19E3779F9ULL) >> 7;
+    h ^= ((Uint64)(uintptr_t)sw * 0xD6E8FEB86659FD93ULL) >> 13;
+    h ^= ((Uint64)(uintptr_t)se * 0xFF51AFD7ED558CCDULL) >> 19;
+    return h ^ (h >> 29);
+}
+
+/**
+ * Get a node from the pool
+ * @param life
+ * @return A cleared node
+ */
+static LifeNode * hashlife_alloc(HashLife * life)
+{
+    LifeNode * node;
+
+    if (life->freeList)
+    {
+        node = life->freeList;
+        life->freeList = node->next;
+    }
+    else
+    {
+        if ( ! life->blockCount || life->blockUsed == kLifeNodeBlock)
+        {
+            LifeNode ** blocks = (LifeNode **)realloc(life->blocks, sizeof(LifeNode *) * (life->blockCount + 1));
+            if ( ! blocks)
+            {
+                fprintf(stderr, "Not enough memory for the HashLife nodes\n");
+                exit(EXIT_FAILURE);
+            }
+            life->blocks = blocks;
+            life->blocks[life->blockCount] = (LifeNode *)malloc(sizeof(LifeNode) * kLifeNodeBlock);
+            if ( ! life->blocks[life->blockCount])
+            {
+                fprintf(stderr, "Not enough memory for the HashLife nodes\n");
+                exit(EXIT_FAILURE);
+            }
+            life->blockCount++;
+            life->blockUsed = 0;
+        }
+        node = &life->blocks[life->blockCount - 1][life->blockUsed++];
+    }
+    memset(node, 0, sizeof(LifeNode));
+    return node;
+}
+
+/**
+ * Double the hash table when it gets crowded
+ * @param life
+ */
+static void hashlife_grow(HashLife * life)
+{
+    Uint64 i;
+    const Uint64 count = life->bucketCount * 2;
+    LifeNode ** buckets = (LifeNode **)calloc(count, sizeof(LifeNode *));
+
+    if ( ! buckets)
+    {
+        return;
+    }
+    for (i = 0; i < life->bucketCount; i++)
+    {
+        LifeNode * node = life->buckets[i];
+        while (node)
+        {
+            LifeNode * next = node->next;
+            const Uint64 h = hashlife_hash(node->nw, node->ne, node->sw, node->se, node->bits) & (count - 1);
+            node->next = buckets[h];
+            buckets[h] = node;
+            node = next;
+        }
+    }
+    free(life->buckets);
+    life->buckets = buckets;
+    life->bucketCount = count;
+}
+
+/**
+ * Get the canonical node of a content, create it if needed
+ * @param life
+ * @param nw, ne, sw, se The children, NULL for a leaf
+ * @param bits The cells of a leaf
+ * @return The node
+ */
+static LifeNode * hashlife_find(HashLife * life, LifeNode * nw, LifeNode * ne, LifeNode * sw, LifeNode * se, Uint64 bits)
+{
+    const Uint64 h = hashlife_hash(nw, ne, sw, se, bits) & (life->bucketCount - 1);
+    LifeNode * node;
+
+    for (node = life->buckets[h]; node; node = node->next)
+    {
+        if (node->nw == nw && node->ne == ne && node->sw == sw && node->se == se && node->bits == bits)
+        {
+            return node;
+        }
+    }
+
+    node = hashlife_alloc(life);
+    node->nw = nw;
+    node->ne = ne;
+    node->sw = sw;
+    node->se = se;
+    node->bits = bits;
+    if (nw)
+    {
+        node->level = nw->level + 1;
+        node->population = nw->population + ne->population + sw->population + se->population;
+    }
+    else
+    {
+        node->level = kLifeLeafLevel;
+        node->population = __builtin_popcountll(bits);
+    }
+    node->next = life->buckets[h];
+    life->buckets[h] = node;
+
+    if (++life->nodeCount > life->bucketCount)
+    {
+        hashlife_grow(life);
+    }
+    return node;
+}
+
+/**
+ * Get the leaf of an 8x8 square
+ */
+static inline LifeNode * hashlife_leaf(HashLife * life, Uint64 bits)
+{
+    return hashlife_find(life, NULL, NULL, NULL, NULL, bits);
+}
+
+/**
+ * Get the node made of four children
+ */
+static inline LifeNode * hashlife_node(HashLife * life, LifeNode * nw, LifeNode * ne, LifeNode * sw, LifeNode * se)
+{
+    return hashlife_find(life, nw, ne, sw, se, 0);
+}
+
+/**
+ * Get the empty node of a level
+ */
+static LifeNode * hashlife_empty(HashLife * life, Uint32 level)
+{
+    if (level > LIFE_MAX_LEVEL)
+    {
+        fprintf(stderr, "The HashLife universe can't grow beyond level %d\n", LIFE_MAX_LEVEL);
+        exit(EXIT_FAILURE);
+    }
+    if ( ! life->empty[level])
+    {
+        life->empty[level] = level == kLifeLeafLevel ? hashlife_leaf(life, 0)
+            : hashlife_node(life, hashlife_empty(life, level - 1), hashlife_empty(life, level - 1),
+                                  hashlife_empty(life, level - 1), hashlife_empty(life, level - 1));
+    }
+    return life->empty[level];
+}
+
+/**
+ * Unpack a level 4 node (16x16 cells) into rows, bit x is column x
+ * @param node
+ * @param rows Receive the 16 rows
+ */
+static void hashlife_rows16(const LifeNode * node, Uint32 rows[16])
+{
+    Uint32 y;
+
+    for (y = 0; y < 8; y++)
+    {
+        rows[y] = (Uint32)((node->nw->bits >> (y * 8)) & 0xFF) | (Uint32)((node->ne->bits >> (y * 8)) & 0xFF) << 8;
+        rows[y + 8] = (Uint32)((node->sw->bits >> (y * 8)) & 0xFF) | (Uint32)((node->se->bits >> (y * 8)) & 0xFF) << 8;
+    }
+}
+
+/**
+ * Base case: advance a level 4 node by brute force and keep its center.
+ * Wrong cells come in from the border one cell per generation, after at
+ * most 4 generations the center 8x8 is still right.
+ * @param life
+ * @param node A level 4 node
+ * @param generations 0 to 4
+ * @return The center leaf
+ */
+static LifeNode * hashlife_base(HashLife * life, const LifeNode * node, Uint32 generations)
+{
+    Uint32 rows[16], next[16];
+    Uint32 g, y;
+    Uint64 bits = 0;
+
+    hashlife_rows16(node, rows);
+    for (g = 0; g < generations; g++)
+    {
+        for (y = 0; y < 16; y++)
+        {
+            const Uint32 a = y ? rows[y - 1] : 0;
+            const Uint32 c = rows[y];
+            const Uint32 b = y < 15 ? rows[y + 1] : 0;
+
+            next[y] = (Uint32)rule_packed_word(a << 1, a, a >> 1, c << 1, c, c >> 1, b << 1, b, b >> 1) & 0xFFFF;
+        }
+        memcpy(rows, next, sizeof(rows));
+    }
+
+    for (y = 0; y < 8; y++)
+    {
+        bits |= (Uint64)((rows[y + 4] >> 4) & 0xFF) << (y * 8);
+    }
+    return hashlife_leaf(life, bits);
+}
+
+/**
+ * Center of a node, one level down, without advancing time
+ */
+static LifeNode * hashlife_center(HashLife * life, LifeNode * node)
+{
+    if (node->level == kLifeLeafLevel + 1)
+    {
+        return hashlife_base(life, node, 0);
+    }
+    return hashlife_node(life, node->nw->se, node->ne->sw, node->sw->ne, node->se->nw);
+}
+
+/**
+ * RESULT of a node: its center, one level down, 2^step generations later.
+ * Nine overlapping sub-squares are advanced (or only centered when the
+ * step is below the natural size of the node), regrouped in four, and
+ * advanced again. Results are memoized in the node.
+ * @param life
+ * @param node A node of level 4 or more
+ * @param step log2 of the generations, at most level - 2
+ * @return The center node
+ */
+static LifeNode * hashlife_step(HashLife * life, LifeNode * node, Uint32 step)
+{
+    LifeNode * sub[9];
+    LifeNode * quad[9];
+    Uint32 i, second;
+
+    if ( ! node->population)
+    {
+        return hashlife_empty(life, node->level - 1);
+    }
+    if (node->result && node->resultStep == step)
+    {
+        return node->result;
+    }
+
+    if (node->level == kLifeLeafLevel + 1)
+    {
+        node->result = hashlife_base(life, node, 1U << step);
+        node->resultStep = step;
+        return node->result;
+    }
+
+    // The nine sub-squares of level - 1
+    quad[0] = node->nw;
+    quad[1] = hashlife_node(life, node->nw->ne, node->ne->nw, node->nw->se, node->ne->sw);
+    quad[2] = node->ne;
+    quad[3] = hashlife_node(life, node->nw->sw, node->nw->se, node->sw->nw, node->sw->ne);
+    quad[4] = hashlife_node(life, node->nw->se, node->ne->sw, node->sw->ne, node->se->nw);
+    quad[5] = hashlife_node(life, node->ne->sw, node->ne->se, node->se->nw, node->se->ne);
+    quad[6] = node->sw;
+    quad[7] = hashlife_node(life, node->sw->ne, node->se->nw, node->sw->se, node->se->sw);
+    quad[8] = node->se;
+
+    if (step == node->level - 2U)
+    {
+        // Full speed: half of the time now, half in the second stage
+        for (i = 0; i < 9; i++)
+        {
+            sub[i] = hashlife_step(life, quad[i], node->level - 3);
+        }
+        second = node->level - 3;
+    }
+    else
+    {
+        for (i = 0; i < 9; i++)
+        {
+            sub[i] = hashlife_center(life, quad[i]);
+        }
+        second = step;
+    }
+
+    node->result = hashlife_node(life,
+        hashlife_step(life, hashlife_node(life, sub[0], sub[1], sub[3], sub[4]), second),
+        hashlife_step(life, hashlife_node(life, sub[1], sub[2], sub[4], sub[5]), second),
+        hashlife_step(life, hashlife_node(life, sub[3], sub[4], sub[6], sub[7]), second),
+        hashlife_step(life, hashlife_node(life, sub[4], sub[5], sub[7], sub[8]), second));
+    node->resultStep = step;
+    return node->result;
+}
+
+/**
+ * Double the root around the origin, the pattern moves to the center
+ * @param life
+ */
+static void hashlife_expand(HashLife * life)
+{
+    LifeNode * root = life->root;
+    LifeNode * e;
+
+    if (root->level >= LIFE_MAX_LEVEL)
+    {
+        fprintf(stderr, "The HashLife universe can't grow beyond level %d\n", LIFE_MAX_LEVEL);
+        exit(EXIT_FAILURE);
+    }
+    e = hashlife_empty(life, root->level - 1);
+
+    life->root = hashlife_node(life, hashlife_node(life, e, e, e, root->nw), hashlife_node(life, e, e, root->ne, e),
+                                     hashlife_node(life, e, root->sw, e, e), hashlife_node(life, root->se, e, e, e));
+}
+
+/**
+ * Tell if all the living cells are in the inner half of the root
+ * @param life
+ */
+static int hashlife_is_centered(const HashLife * life)
+{
+    const LifeNode * root = life->root;
+
+    return root->nw->population == root->nw->se->population && root->ne->population == root->ne->sw->population &&
+           root->sw->population == root->sw->ne->population && root->se->population == root->se->nw->population;
+}
+
+/**
+ * Build the node covering a square of a dense board. Cells outside of the
+ * board are dead.
+ * @param life
+ * @param board
+ * @param x0, y0 Top left corner of the square, in board coordinates
+ * @param level Size of the square
+ */
+static LifeNode * hashlife_from_board(HashLife * life, const Board * board, Sint64 x0, Sint64 y0, Uint32 level)
+{
+    const Sint64 size = (Sint64)1 << level;
+
+    if (x0 >= board->width || y0 >= board->height || x0 + size <= 0 || y0 + size <= 0)
+    {
+        return hashlife_empty(life, level);
+    }
+    if (level == kLifeLeafLevel)
+    {
+        Uint64 bits = 0;
+        Sint64 x, y;
+        for (y = 0; y < 8; y++)
+        {
+            for (x = 0; x < 8; x++)
+            {
+                if (x0 + x >= 0 && y0 + y >= 0 && x0 + x < board->width && y0 + y < board->height &&
+                    board_get_cell(board, (Uint32)(x0 + x), (Uint32)(y0 + y)))
+                {
+                    bits |= (Uint64)1 << (y * 8 + x);
+                }
+            }
+        }
+        return hashlife_leaf(life, bits);
+    }
+    return hashlife_node(life, hashlife_from_board(life, board, x0, y0, level - 1),
+                               hashlife_from_board(life, board, x0 + size / 2, y0, level - 1),
+                               hashlife_from_board(life, board, x0, y0 + size / 2, level - 1),
+                               hashlife_from_board(life, board, x0 + size / 2, y0 + size / 2, level - 1));
+}
+
+/**
+ * Create a universe holding a dense board, its top left cell at the origin
+ * @param life
+ * @param board NULL for an empty universe
+ * @param memoryCap Bytes of nodes allowed before collecting the garbage
+ */
+static void hashlife_create(HashLife * life, const Board * board, size_t memoryCap)
+{
+    Uint32 level = kLifeLeafLevel + 2;
+    const Sint64 side = ! board ? 0 : board->width > board->height ? board->width : board->height;
+
+    memset(life, 0, sizeof(HashLife));
+    life->memoryCap = memoryCap;
+    life->bucketCount = 1 << 16;
+    life->buckets = (LifeNode **)calloc(life->bucketCount, sizeof(LifeNode *));
+    if ( ! life->buckets)
+    {
+        fprintf(stderr, "Not enough memory for the HashLife table\n");
+        exit(EXIT_FAILURE);
+    }
+
+    if ( ! board)
+    {
+        life->root = hashlife_empty(life, level);
+        return;
+    }
+    // The board goes in the south east quarter of the root
+    while (((Sint64)1 << (level - 1)) < side)
+    {
+        level++;
+    }
+    life->root = hashlife_from_board(life, board, -((Sint64)1 << (level - 1)), -((Sint64)1 << (level - 1)), level);
+}
+
+/**
+ * Mark a node and everything below it as reachable
+ */
+static void hashlife_mark(LifeNode * node)
+{
+    while (node && ! node->mark)
+    {
+        node->mark = Yes;
+        if ( ! node->nw)
+        {
+            return;
+        }
+        hashlife_mark(node->nw);
+        hashlife_mark(node->ne);
+        hashlife_mark(node->sw);
+        node = node->se;
+    }
+}
+
+/**
+ * Give back the nodes the root can't reach. Memoized results are kept when
+ * their node survives, the cache is what the memory cap evicts first.
+ * @param life
+ */
+static void hashlife_collect(HashLife * life)
+{
+    Uint32 b, i, level;
+
+    hashlife_mark(life->root);
+    for (level = 0; level <= LIFE_MAX_LEVEL; level++)
+    {
+        hashlife_mark(life->empty[level]);
+    }
+
+    memset(life->buckets, 0, sizeof(LifeNode *) * life->bucketCount);
+    life->nodeCount = 0;
+    life->freeList = NULL;
+    for (b = 0; b < life->blockCount; b++)
+    {
+        const Uint32 used = b + 1 == life->blockCount ? life->blockUsed : kLifeNodeBlock;
+        for (i = 0; i < used; i++)
+        {
+            LifeNode * node = &life->blocks[b][i];
+            if (node->mark)
+            {
+                const Uint64 h = hashlife_hash(node->nw, node->ne, node->sw, node->se, node->bits) & (life->bucketCount - 1);
+                if (node->result && ! node->result->mark)
+                {
+                    node->result = NULL;
+                }
+                node->next = life->buckets[h];
+                life->buckets[h] = node;
+                life->nodeCount++;
+            }
+            else
+            {
+                // Poison the free node so no stale result matches it
+                node->nw = node->ne = node->sw = node->se = node->result = NULL;
+                node->population = 0;
+                node->next = life->freeList;
+                life->freeList = node;
+            }
+        }
+    }
+    for (b = 0; b < life->blockCount; b++)
+    {
+        const Uint32 used = b + 1 == life->blockCount ? life->blockUsed : kLifeNodeBlock;
+        for (i = 0; i < used; i++)
+        {
+            life->blocks[b][i].mark = No;
+        }
+    }
+    life->survivors = life->nodeCount;
+    life->collections++;
+}
+
+/**
+ * Advance the universe by 2^step generations
+ * @param life
+ * @param step log2 of the number of generations
+ */
+static void hashlife_jump(HashLife * life, Uint32 step)
+{
+    // The pattern must sit in the inner quarter and the root must be big
+    // enough for the step: nothing can then escape the result
+    while (life->root->level < step + 3 || ! hashlife_is_centered(life))
+    {
+        hashlife_expand(life);
+    }
+    hashlife_expand(life);
+
+    life->root = hashlife_step(life, life->root, step);
+    life->generation += (Uint64)1 << step;
+
+    if (life->nodeCount * sizeof(LifeNode) > life->memoryCap)
+    {
+        hashlife_collect(life);
+    }
+}
+
+/**
+ * Advance the universe by any number of generations, as a sum of jumps
+ * @param life
+ * @param generations
+ */
+static void hashlife_advance(HashLife * life, Uint64 generations)
+{
+    int step;
+
+    for (step = 63; step >= 0; step--)
+    {
+        if (generations & ((Uint64)1 << step))
+        {
+            hashlife_jump(life, (Uint32)step);
+        }
+    }
+}
+
+/**
+ * Set living cells of a leaf, the nodes on its path are copied
+ * @param life
+ * @param node
+ * @param x, y Top left corner of the leaf, from the top left corner of the node
+ * @param bits Cells to set, bit y * 8 + x of the leaf
+ * @return The node with the cells set
+ */
+static LifeNode * hashlife_set_bits(HashLife * life, LifeNode * node, Uint64 x, Uint64 y, Uint64 bits)
+{
+    Uint64 half;
+
+    if ( ! node->nw)
+    {
+        return hashlife_leaf(life, node->bits | bits);
+    }
+    half = (Uint64)1 << (node->level - 1);
+    if (y < half)
+    {
+        return x < half ? hashlife_node(life, hashlife_set_bits(life, node->nw, x, y, bits), node->ne, node->sw, node->se)
+                        : hashlife_node(life, node->nw, hashlife_set_bits(life, node->ne, x - half, y, bits), node->sw, node->se);
+    }
+    return x < half ? hashlife_node(life, node->nw, node->ne, hashlife_set_bits(life, node->sw, x, y - half, bits), node->se)
+                    : hashlife_node(life, node->nw, node->ne, node->sw, hashlife_set_bits(life, node->se, x - half, y - half, bits));
+}
+
+/**
+ * Set consecutive cells of a row alive, a leaf at a time. The root grows
+ * until it holds them.
+ * @param life
+ * @param x, y First cell, both positive
+ * @param length Number of cells
+ */
+static void hashlife_set_run(HashLife * life, Uint64 x, Uint64 y, Uint64 length)
+{
+    Uint64 half = (Uint64)1 << (life->root->level - 1);
+
+    while (x + length > half || y >= half)
+    {
+        hashlife_expand(life);
+        half = (Uint64)1 << (life->root->level - 1);
+    }
+    while (length)
+    {
+        // From the top left corner of the root
+        const Uint64 cx = x + half, cy = y + half;
+        const Uint64 room = 8 - (cx & 7);
+        const Uint64 bits = room < length ? room : length;
+        life->root = hashlife_set_bits(life, life->root, cx & ~7ULL, cy & ~7ULL, (((1ULL << bits) - 1) << (cx & 7)) << ((cy & 7) * 8));
+        x += bits;
+        length -= bits;
+    }
+    // Each run leaves a copied path behind: collect once they outnumber the pattern
+    if (life->nodeCount * sizeof(LifeNode) > life->memoryCap && life->nodeCount > 2 * life->survivors)
+    {
+        hashlife_collect(life);
+    }
+}
+
+/**
+ * Release the universe
+ * @param life
+ */
+static void hashlife_dispose(HashLife * life)
+{
+    Uint32 b;
+
+    for (b = 0; b < life->blockCount; b++)
+    {
+        free(life->blocks[b]);
+    }
+    free(life->blocks);
+    free(life->buckets);
+    memset(life, 0, sizeof(HashLife));
+}
+
+/**
+ * Chunk of the sparse universe: 64x64 cells, one Uint64 per row, two
+ * generations. Bit x of a row is the column x of the chunk.
+ */
+typedef struct Chunk Chunk;
+struct Chunk
+{
+    Sint32 x, y;                        // Chunk coordinates (cell coordinates / 64)
+    Uint32 index;                       // Position in the chunk list
+    Chunk * next;                       // Next chunk of the hash bucket (or of the free list)
+    Uint64 rows[2][64];                 // Current and next generation
+};
+
+/**
+ * Sparse unbounded universe. Only the chunks holding living cells (and the
+ * ones around the edges where cells may be born) exist, memory follows the
+ * living area instead of the bounding box. Chunks come from a pool so the
+ * generations don't call malloc.
+ */
+typedef struct Sparse
+{
+    Chunk ** buckets;                   // Hash table keyed by the chunk coordinates
+    Uint32 bucketCount;                 // Always a power of 2
+    Chunk ** chunks;                    // Every chunk, to walk them
+    Uint32 chunkCount;
+    Uint32 chunkCapacity;
+    Chunk ** blocks;                    // The pool: chunks are allocated by blocks
+    Uint32 blockCount;
+    Uint32 blockUsed;                   // Chunks handed out from the last block
+    Chunk * freeList;                   // Chunks given back
+    int current;                        // Indice of the current generation in Chunk.rows
+    Uint64 generation;
+} Sparse;
+
+const Uint32 kChunkBlock = 1024;        // Chunks per pool block
+
+/**
+ * Hash of chunk coordinates
+ */
+static inline Uint32 sparse_hash(Sint32 x, Sint32 y)
+{
+    Uint64 h = ((Uint64)(Uint32)x << 32 | (Uint32)y) * 0x9E3779B97F4A7C15ULL;
+    return (Uint32)(h >> 32);
+}
+
+/**
+ * Find a chunk
+ * @param sparse
+ * @param x, y Chunk coordinates
+ * @return The chunk, NULL if it does not exist (its cells are dead)
+ */
+static Chunk * sparse_find(const Sparse * sparse, Sint32 x, Sint32 y)
+{
+    Chunk * chunk;
+
+    for (chunk = sparse->buckets[sparse_hash(x, y) & (sparse->bucketCount - 1)]; chunk; chunk = chunk->next)
+    {
+        if (chunk->x == x && chunk->y == y)
+        {
+            return chunk;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Double the hash table
+ * @param sparse
+ */
+static void sparse_grow(Sparse * sparse)
+{
+    Uint32 i;
+    const Uint32 count = sparse->bucketCount * 2;
+    Chunk ** buckets = (Chunk **)calloc(count, sizeof(Chunk *));
+
+    if ( ! buckets)
+    {
+        return;
+    }
+    for (i = 0; i < sparse->chunkCount; i++)
+    {
+        Chunk * chunk = sparse->chunks[i];
+        const Uint32 h = sparse_hash(chunk->x, chunk->y) & (count - 1);
+        chunk->next = buckets[h];
+        buckets[h] = chunk;
+    }
+    free(sparse->buckets);
+    sparse->buckets = buckets;
+    sparse->bucketCount = count;
+}
+
+/**
+ * Find a chunk, create an empty one if it does not exist
+ * @param sparse
+ * @param x, y Chunk coordinates
+ * @return The chunk
+ */
+static Chunk * sparse_get(Sparse * sparse, Sint32 x, Sint32 y)
+{
+    Chunk * chunk = sparse_find(sparse, x, y);
+    Uint32 h;
+
+    if (chunk)
+    {
+        return chunk;
+    }
+
+    if (sparse->freeList)
+    {
+        chunk = sparse->freeList;
+        sparse->freeList = chunk->next;
+    }
+    else
+    {
+        if ( ! sparse->blockCount || sparse->blockUsed == kChunkBlock)
+        {
+            Chunk ** blocks = (Chunk **)realloc(sparse->blocks, sizeof(Chunk *) * (sparse->blockCount + 1));
+            if ( ! blocks)
+            {
+                fprintf(stderr, "Not enough memory for the sparse chunks\n");
+                exit(EXIT_FAILURE);
+            }
+            sparse->blocks = blocks;
+            sparse->blocks[sparse->blockCount] = (Chunk *)malloc(sizeof(Chunk) * kChunkBlock);
+            if ( ! sparse->blocks[sparse->blockCount])
+            {
+                fprintf(stderr, "Not enough memory for the sparse chunks\n");
+                exit(EXIT_FAILURE);
+            }
+            sparse->blockCount++;
+            sparse->blockUsed = 0;
+        }
+        chunk = &sparse->blocks[sparse->blockCount - 1][sparse->blockUsed++];
+    }
+    memset(chunk, 0, sizeof(Chunk));
+    chunk->x = x;
+    chunk->y = y;
+
+    if (sparse->chunkCount == sparse->chunkCapacity)
+    {
+        Uint32 capacity = sparse->chunkCapacity ? sparse->chunkCapacity * 2 : 1024;
+        Chunk ** chunks = (Chunk **)realloc(sparse->chunks, sizeof(Chunk *) * capacity);
+        if ( ! chunks)
+        {
+            fprintf(stderr, "Not enough memory for the sparse chunk list\n");
+            exit(EXIT_FAILURE);
+        }
+        sparse->chunks = chunks;
+        sparse->chunkCapacity = capacity;
+    }
+    chunk->index = sparse->chunkCount;
+    sparse->chunks[sparse->chunkCount++] = chunk;
+
+    h = sparse_hash(x, y) & (sparse->bucketCount - 1);
+    chunk->next = sparse->buckets[h];
+    sparse->buckets[h] = chunk;
+
+    if (sparse->chunkCount > sparse->bucketCount)
+    {
+        sparse_grow(sparse);
+    }
+    return chunk;
+}
+
+/**
+ * Give a chunk back to the pool
+ * @param sparse
+ * @param chunk
+ */
+static void sparse_release(Sparse * sparse, Chunk * chunk)
+{
+    Chunk ** link = &sparse->buckets[sparse_hash(chunk->x, chunk->y) & (sparse->bucketCount - 1)];
+    Chunk * last = sparse->chunks[--sparse->chunkCount];
+
+    while (*link != chunk)
+    {
+        link = &(*link)->next;
+    }
+    *link = chunk->next;
+
+    last->index = chunk->index;
+    sparse->chunks[chunk->index] = last;
+
+    chunk->next = sparse->freeList;
+    sparse->freeList = chunk;
+}
+
+/**
+ * Create an empty universe
+ * @param sparse
+ */
+static void sparse_create(Sparse * sparse)
+{
+    memset(sparse, 0, sizeof(Sparse));
+    sparse->bucketCount = 1024;
+    sparse->buckets = (Chunk **)calloc(sparse->bucketCount, sizeof(Chunk *));
+    if ( ! sparse->buckets)
+    {
+        fprintf(stderr, "Not enough memory for the sparse chunk table\n");
+        exit(EXIT_FAILURE);
+    }
+}
+
+/**
+ * Copy the living cells of a dense board, its top left cell at the origin
+ * @param sparse
+ * @param board
+ */
+static void sparse_load_board(Sparse * sparse, const Board * board)
+{
+    Uint32 x, y, i;
+
+    for (y = 0; y < board->height; y++)
+    {
+        for (i = 0; i < board->words; i++)
+        {
+            Uint64 bits = 0;
+            if (board->format == BOARD_PACKED)
+            {
+                bits = board_packed_row(board, y)[i];
+            }
+            else
+            {
+                const Uint8 * row = board_row(board, y);
+                for (x = i * 64; x < board->width && x < i * 64 + 64; x++)
+                {
+                    bits |= (Uint64)row[x] << (x & 63);
+                }
+            }
+            if (bits)
+            {
+                sparse_get(sparse, (Sint32)i, (Sint32)(y / 64))->rows[sparse->current][y & 63] = bits;
+            }
+        }
+    }
+}
+
+/**
+ * Count the living cells
+ * @param sparse
+ */
+static Uint64 sparse_population(const Sparse * sparse)
+{
+    Uint32 i, y;
+    Uint64 population = 0;
+
+    for (i = 0; i < sparse->chunkCount; i++)
+    {
+        for (y = 0; y < 64; y++)
+        {
+            population += __builtin_popcountll(sparse->chunks[i]->rows[sparse->current][y]);
+        }
+    }
+    return population;
+}
+
+/**
+ * Compute the next generation of a chunk. The rows and columns around it
+ * are read from its neighbours, a missing neighbour is dead.
+ * @param sparse
+ * @param chunk
+ */
+static void sparse_compute_chunk(const Sparse * sparse, Chunk * chunk)
+{
+    int y;
+    const int cur = sparse->current;
+    const Chunk * n  = sparse_find(sparse, chunk->x,     chunk->y - 1);
+    const Chunk * s  = sparse_find(sparse, chunk->x,     chunk->y + 1);
+    const Chunk * w  = sparse_find(sparse, chunk->x - 1, chunk->y);
+    const Chunk * e  = sparse_find(sparse, chunk->x + 1, chunk->y);
+    const Chunk * nw = sparse_find(sparse, chunk->x - 1, chunk->y - 1);
+    const Chunk * ne = sparse_find(sparse, chunk->x + 1, chunk->y - 1);
+    const Chunk * sw = sparse_find(sparse, chunk->x - 1, chunk->y + 1);
+    const Chunk * se = sparse_find(sparse, chunk->x + 1, chunk->y + 1);
+    // Rows -1 to 64 of the chunk and of its west and east columns
+    Uint64 center[66], west[66], east[66];
+
+    for (y = 0; y < 64; y++)
+    {
+        center[y + 1] = chunk->rows[cur][y];
+        west[y + 1] = w ? w->rows[cur][y] : 0;
+        east[y + 1] = e ? e->rows[cur][y] : 0;
+    }
+    center[0] = n ? n->rows[cur][63] : 0;
+    west[0] = nw ? nw->rows[cur][63] : 0;
+    east[0] = ne ? ne->rows[cur][63] : 0;
+    center[65] = s ? s->rows[cur][0] : 0;
+    west[65] = sw ? sw->rows[cur][0] : 0;
+    east[65] = se ? se->rows[cur][0] : 0;
+
+    for (y = 1; y <= 64; y++)
+    {
+        const Uint64 aL = (center[y - 1] << 1) | (west[y - 1] >> 63);
+        const Uint64 aR = (center[y - 1] >> 1) | (east[y - 1] << 63);
+        const Uint64 cL = (center[y] << 1) | (west[y] >> 63);
+        const Uint64 cR = (center[y] >> 1) | (east[y] << 63);
+        const Uint64 bL = (center[y + 1] << 1) | (west[y + 1] >> 63);
+        const Uint64 bR = (center[y + 1] >> 1) | (east[y + 1] << 63);
+
+        chunk->rows[cur ^ 1][y - 1] = rule_packed_word(aL, center[y - 1], aR, cL, center[y], cR, bL, center[y + 1], bR);
+    }
+}
+
+/**
+ * Advance the universe by one generation
+ * @param sparse
+ */
+static void sparse_step(Sparse * sparse)
+{
+    int i;
+    Uint32 c, y;
+    const Uint32 count = sparse->chunkCount;
+    const int cur = sparse->current;
+    int next;
+
+    // Cells may be born next to a living border, make sure the chunk is there
+    for (c = 0; c < count; c++)
+    {
+        const Chunk * chunk = sparse->chunks[c];
+        const Sint32 cx = chunk->x, cy = chunk->y;
+        const Uint64 top = chunk->rows[cur][0], bottom = chunk->rows[cur][63];
+        Uint64 left = 0, right = 0;
+
+        for (y = 0; y < 64; y++)
+        {
+            left |= chunk->rows[cur][y] & 1;
+            right |= chunk->rows[cur][y] >> 63;
+        }
+        if (top)            sparse_get(sparse, cx, cy - 1);
+        if (bottom)         sparse_get(sparse, cx, cy + 1);
+        if (left)           sparse_get(sparse, cx - 1, cy);
+        if (right)          sparse_get(sparse, cx + 1, cy);
+        if (top & 1)        sparse_get(sparse, cx - 1, cy - 1);
+        if (top >> 63)      sparse_get(sparse, cx + 1, cy - 1);
+        if (bottom & 1)     sparse_get(sparse, cx - 1, cy + 1);
+        if (bottom >> 63)   sparse_get(sparse, cx + 1, cy + 1);
+    }
+
+    // sparse_get may not run from here on: the table is only read
+    #pragma omp parallel for schedule(dynamic, 16)
+    for (i = 0; i < (int)sparse->chunkCount; i++)
+    {
+        sparse_compute_chunk(sparse, sparse->chunks[i]);
+    }
+    sparse->current ^= 1;
+    sparse->generation++;
+
+    // The chunks which died go back to the pool
+    next = sparse->current;
+    for (c = sparse->chunkCount; c-- > 0; )
+    {
+        Chunk * chunk = sparse->chunks[c];
+        Uint64 alive = 0;
+        for (y = 0; y < 64; y++)
+        {
+            alive |= chunk->rows[next][y];
+        }
+        if ( ! alive)
+        {
+            sparse_release(sparse, chunk);
+        }
+    }
+}
+
+/**
+ * Release the universe
+ * @param sparse
+ */
+static void sparse_dispose(Sparse * sparse)
+{
+    Uint32 b;
+
+    for (b = 0; b < sparse->blockCount; b++)
+    {
+        free(sparse->blocks[b]);
+    }
+    free(sparse->blocks);
+    free(sparse->chunks);
+    free(sparse->buckets);
+    memset(sparse, 0, sizeof(Sparse));
+}
+
+/**
+ * Clear both buffers (respond to a click on "Reset Button")
+ * @param game
+ */
+static void board_reset(GameContainer * game)
+{
+    register Uint32 i, b;
+    
+    for (b = 0; b < 3; b++)
+    {
+        for (i = 0; game->boards[b].memory && i < game->boards[b].height; i++) 
+        {
+            memset(board_row(&game->boards[b], i), 0, board_row_bytes(&game->boards[b]));
+        }
+    }
+    if (game->ages)
+    {
+        memset(game->ages, 0, (size_t)game->width * game->height);
+    }
+    game->activityReset = Yes;
+    game->redrawAll = Yes;
+    game->hashValid = No;
+}
+
+/**
+ * Create the front and back boards. Both start empty.
+ * The program can't do anything without them, so it stops on failure.
+ * The arena of the game is sized for all its storage: the boards (the third
+ * one too for --sim-thread), the tile map and hashes, the scratch tiles of
+ * the temporal blocking and the buffers of the extended rules.
+ * @param game
+ */
+static void game_create_boards(GameContainer * game)
+{
+    const size_t tiles = (size_t)((game->width + kActiveTileSize - 1) / kActiveTileSize) *
+                         ((game->height + kActiveTileSize - 1) / kActiveTileSize);
+    const size_t ages = (size_t)game->width * game->height;
+    const size_t sums = (size_t)omp_get_max_threads() * (2 * gRule.range + 1) * (game->width + 1) * sizeof(Uint32);
+    size_t size = (game->simulationThread ? 3 : 2) * arena_round(board_size(game->width, game->height, game->format)) +
+                  arena_round(tiles) + arena_round(tiles * sizeof(Uint32)) + arena_round(tiles * sizeof(Uint64));
+
+    if (rule_is_extended(&gRule))
+    {
+        size += arena_round(ages) + arena_round(sums);
+    }
+    if (game->computeBoardFunc == board_compute_temporal && game->temporalDepth)
+    {
+        size += game_scratch_size(game);
+    }
+
+    game->current = 0;
+    game->next = 1;
+    game->generation = 0;
+    game->arena = arena_create(size);
+    if ( ! game->arena ||
+        arena_board(game->arena, &game->boards[0], game->width, game->height, game->format) ||
+        arena_board(game->arena, &game->boards[1], game->width, game->height, game->format))
+    {
+        fprintf(stderr, "Not enough memory for a %ux%u board\n", game->width, game->height);
+        exit(EXIT_FAILURE);
+    }
+    if (rule_is_extended(&gRule))
+    {
+        game->ages = (Uint8 *)arena_alloc(game->arena, ages);
+        game->ruleSums = (Uint32 *)arena_alloc(game->arena, sums);
+        if ( ! game->ages || ! game->ruleSums)
+        {
+            fprintf(stderr, "Not enough memory for a %ux%u board\n", game->width, game->height);
+            exit(EXIT_FAILURE);
+        }
+        memset(game->ages, 0, ages);
+    }
+}
+
+/**
+ * Release the front and back boards
+ * @param game
+ */
+static void game_dispose_boards(GameContainer * game)
+{
+    board_dispose(&game->boards[0]);
+    board_dispose(&game->boards[1]);
+    board_dispose(&game->boards[2]);
+    arena_dispose(game->arena);
+    game->arena = NULL;
+    game->scratch = NULL;
+    game->scratchSize = 0;
+    game->changedTiles = NULL;
+    game->activeList = NULL;
+    game->tilePopulation = NULL;
+    game->tileHashes = NULL;
+    game->ages = NULL;
+    game->ruleSums = NULL;
+}
+
+#ifdef USE_MPI
+
+// Directions of the 8 neighbours of a subdomain (dy, dx): d ^ 1 is the opposite of d
+static const int kMpiDirections[8][2] = { { -1, 0 }, { 1, 0 }, { 0, -1 }, { 0, 1 }, { -1, -1 }, { 1, 1 }, { -1, 1 }, { 1, -1 } };
+
+/**
+ * Subdomain of this rank in --mpi runs. The board is cut along a grid of
+ * ranks, and the cuts fall on tile boundaries. Each rank holds its part as a
+ * plain local board, so the kernels don't know about MPI at all. The halo
+ * of that board is refreshed from the 8 neighbour ranks every generation.
+ */
+struct MpiDomain
+{
+    MPI_Comm comm;                      // Cartesian communicator, periodic for a torus
+    int rank;
+    int size;
+    int dims[2];                        // Grid of ranks: rows, columns
+    int coords[2];                      // Position of this rank in the grid
+    int neighbours[8];                  // Rank in each of kMpiDirections, MPI_PROC_NULL past a border
+    Topology topology;                  // The global one, the local board itself has a dead halo
+    Uint32 width, height;               // The whole board
+    Uint32 * xs;                        // dims[1] + 1 column cuts
+    Uint32 * ys;                        // dims[0] + 1 row cuts
+    Uint8 * columns[4];                 // Send west, send east, receive from the east, receive from the west
+    Uint8 corners[8];                   // Send, then receive, one cell per diagonal
+    Uint64 * tileWork;                  // Generations each local tile was computed since the last rebalancing
+    Uint64 rebalance;                   // Generations between two rebalancings, 0 for none
+    Uint64 nextRebalance;
+};
+
+/**
+ * Make the local board match the cuts. The boards themselves are (re)created
+ * by the caller.
+ * @param game
+ */
+static void mpi_set_local(GameContainer * game)
+{
+    MpiDomain * mpi = game->mpi;
+    int i;
+
+    game->width = mpi->xs[mpi->coords[1] + 1] - mpi->xs[mpi->coords[1]];
+    game->height = mpi->ys[mpi->coords[0] + 1] - mpi->ys[mpi->coords[0]];
+    for (i = 0; i < 4; i++)
+    {
+        free(mpi->columns[i]);
+        mpi->columns[i] = (Uint8 *)malloc(game->height);
+        if ( ! mpi->columns[i])
+        {
+            fprintf(stderr, "Not enough memory for the MPI halo\n");
+            MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+        }
+    }
+    free(mpi->tileWork);
+    mpi->tileWork = NULL;
+}
+
+/**
+ * Start MPI. The other ranks are silent: only rank 0 prints its report.
+ * @param argc
+ * @param argv
+ */
+static void mpi_start(int * argc, char *** argv)
+{
+    int provided, rank;
+
+    // Only the main thread talks to MPI, the OpenMP threads compute
+    MPI_Init_thread(argc, argv, MPI_THREAD_FUNNELED, &provided);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    if (rank && ! freopen("/dev/null", "w", stdout))
+    {
+        fprintf(stderr, "Can't silence rank %d\n", rank);
+    }
+}
+
+/**
+ * Cut the board between the ranks, evenly by tiles
+ * @param game The game of the whole board, it becomes the game of the subdomain
+ * @param rebalance Generations between two rebalancings, 0 for none
+ */
+static void mpi_domain_create(GameContainer * game, Uint64 rebalance)
+{
+    MpiDomain * mpi = (MpiDomain *)calloc(1, sizeof(MpiDomain));
+    const Uint32 tilesX = (game->width + kActiveTileSize - 1) / kActiveTileSize;
+    const Uint32 tilesY = (game->height + kActiveTileSize - 1) / kActiveTileSize;
+    int periods[2], c[2], d, i;
+
+    MPI_Comm_size(MPI_COMM_WORLD, &mpi->size);
+    MPI_Dims_create(mpi->size, 2, mpi->dims);
+    if (tilesX < (Uint32)mpi->dims[1] || tilesY < (Uint32)mpi->dims[0])
+    {
+        fprintf(stderr, "A %ux%u board is too small for a %dx%d grid of ranks (a tile of %u cells each at least)\n",
+                game->width, game->height, mpi->dims[0], mpi->dims[1], kActiveTileSize);
+        MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+    }
+    periods[0] = periods[1] = game->topology == TOPOLOGY_TORUS;
+    MPI_Cart_create(MPI_COMM_WORLD, 2, mpi->dims, periods, Yes, &mpi->comm);
+    MPI_Comm_rank(mpi->comm, &mpi->rank);
+    MPI_Cart_coords(mpi->comm, mpi->rank, 2, mpi->coords);
+
+    for (d = 0; d < 8; d++)
+    {
+        c[0] = mpi->coords[0] + kMpiDirections[d][0];
+        c[1] = mpi->coords[1] + kMpiDirections[d][1];
+        if (periods[0])
+        {
+            c[0] = (c[0] + mpi->dims[0]) % mpi->dims[0];
+            c[1] = (c[1] + mpi->dims[1]) % mpi->dims[1];
+        }
+        if (c[0] < 0 || c[0] >= mpi->dims[0] || c[1] < 0 || c[1] >= mpi->dims[1])
+        {
+            mpi->neighbours[d] = MPI_PROC_NULL;
+        }
+        else
+        {
+            MPI_Cart_rank(mpi->comm, c, &mpi->neighbours[d]);
+        }
+    }
+
+    mpi->width = game->width;
+    mpi->height = game->height;
+    mpi->xs = (Uint32 *)malloc(sizeof(Uint32) * (mpi->dims[1] + 1));
+    mpi->ys = (Uint32 *)malloc(sizeof(Uint32) * (mpi->dims[0] + 1));
+    for (i = 0; i <= mpi->dims[1]; i++)
+    {
+        const Uint32 x = (Uint32)((Uint64)tilesX * i / mpi->dims[1]) * kActiveTileSize;
+        mpi->xs[i] = x < mpi->width ? x : mpi->width;
+    }
+    for (i = 0; i <= mpi->dims[0]; i++)
+    {
+        const Uint32 y = (Uint32)((Uint64)tilesY * i / mpi->dims[0]) * kActiveTileSize;
+        mpi->ys[i] = y < mpi->height ? y : mpi->height;
+    }
+    mpi->topology = game->topology;
+    mpi->rebalance = rebalance;
+    mpi->nextRebalance = rebalance;
+
+    // The exchange brings what lies beyond the local edges, game_step must not wrap the local board
+    game->topology = TOPOLOGY_DEAD;
+    game->mpi = mpi;
+    mpi_set_local(game);
+    printf("Using MPI on %d ranks, a %dx%d grid of subdomains (%ux%u cells on rank 0), OpenMP inside (%d cores)\n",
+           mpi->size, mpi->dims[0], mpi->dims[1], game->width, game->height, omp_get_num_procs());
+}
+
+/**
+ * Stop MPI
+ * @param game
+ */
+static void mpi_domain_dispose(GameContainer * game)
+{
+    MpiDomain * mpi = game->mpi;
+    int i;
+
+    for (i = 0; i < 4; i++)
+    {
+        free(mpi->columns[i]);
+    }
+    free(mpi->tileWork);
+    free(mpi->xs);
+    free(mpi->ys);
+    MPI_Comm_free(&mpi->comm);
+    free(mpi);
+    game->mpi = NULL;
+    MPI_Finalize();
+}
+
+/**
+ * Fill the local board with a random start. Each cell is drawn from its
+ * global coordinates, so the board is the same whatever the number of ranks.
+ * @param game
+ * @param seed
+ * @param density Percentage of living cells
+ */
+static void mpi_populate(GameContainer * game, Uint64 seed, Uint32 density)
+{
+    register Uint32 x, y;
+    const MpiDomain * mpi = game->mpi;
+    Board * board = game_board(game);
+    const Uint64 threshold = (Uint64)density * (0xFFFFFFFFULL / 100);
+    const Uint32 left = mpi->xs[mpi->coords[1]];
+    const Uint32 top = mpi->ys[mpi->coords[0]];
+
+    for (y = 0; y < board->height; y++)
+    {
+        for (x = 0; x < board->width; x++)
+        {
+            const Uint64 cell = (Uint64)(top + y) * mpi->width + left + x;
+            board_set_cell(board, x, y, (hash_mix(seed * 0x9E3779B97F4A7C15ULL + cell) >> 32) < threshold);
+        }
+    }
+}
+
+/**
+ * Cut a profile of costs in parts of about the same cost, one tile each at least
+ * @param cost Cost of each tile row (or column)
+ * @param count Number of tile rows
+ * @param parts Number of parts
+ * @param cuts Receive parts + 1 cuts, in cells
+ * @param size Size of the board in cells, the last cut
+ */
+static void mpi_split(const Uint64 * cost, Uint32 count, int parts, Uint32 * cuts, Uint32 size)
+{
+    Uint64 total = 0, sum = 0;
+    Uint32 t = 0;
+    int p;
+
+    for (t = 0; t < count; t++)
+    {
+        total += cost[t];
+    }
+    t = 0;
+    cuts[0] = 0;
+    for (p = 1; p < parts; p++)
+    {
+        const Uint64 target = total * p / parts;
+        const Uint32 previous = cuts[p - 1] / kActiveTileSize;
+
+        // Take the tile while it brings the part closer to its target, leave one for each remaining part
+        while (t < count - (Uint32)(parts - p) && (t <= previous || sum + cost[t] / 2 < target))
+        {
+            sum += cost[t++];
+        }
+        cuts[p] = t * kActiveTileSize;
+    }
+    cuts[parts] = size;
+}
+
+/**
+ * Subdomain of a rank for a set of cuts, as [x0, x1) x [y0, y1)
+ * @param xs Column cuts
+ * @param ys Row cuts
+ * @param coords Position of the rank in the grid
+ * @param rect Receive x0, x1, y0 and y1
+ */
+static void mpi_rect(const Uint32 * xs, const Uint32 * ys, const int * coords, Uint32 * rect)
+{
+    rect[0] = xs[coords[1]];
+    rect[1] = xs[coords[1] + 1];
+    rect[2] = ys[coords[0]];
+    rect[3] = ys[coords[0] + 1];
+}
+
+/**
+ * Intersection of two rectangles [x0, x1) x [y0, y1)
+ * @param a
+ * @param b
+ * @param out Receive the intersection
+ * @return Its number of cells
+ */
+static Uint64 mpi_intersect(const Uint32 * a, const Uint32 * b, Uint32 * out)
+{
+    out[0] = a[0] > b[0] ? a[0] : b[0];
+    out[1] = a[1] < b[1] ? a[1] : b[1];
+    out[2] = a[2] > b[2] ? a[2] : b[2];
+    out[3] = a[3] < b[3] ? a[3] : b[3];
+    return out[0] < out[1] && out[2] < out[3] ? (Uint64)(out[1] - out[0]) * (out[3] - out[2]) : 0;
+}
+
+/**
+ * Move the cuts so each rank gets about the same number of computed tiles,
+ * and move the cells accordingly. The tiles are weighed by how often they
+ * were computed since the last time, plus an eighth of the period so the
+ * still areas are shared too (they still need memory). The grid of ranks
+ * cuts whole rows and columns, so the costs are summed by tile row and by
+ * tile column over the ranks.
+ * @param game
+ */
+static void mpi_rebalance(GameContainer * game)
+{
+    MpiDomain * mpi = game->mpi;
+    const Uint32 tilesX = (mpi->width + kActiveTileSize - 1) / kActiveTileSize;
+    const Uint32 tilesY = (mpi->height + kActiveTileSize - 1) / kActiveTileSize;
+    const Uint32 firstX = mpi->xs[mpi->coords[1]] / kActiveTileSize;
+    const Uint32 firstY = mpi->ys[mpi->coords[0]] / kActiveTileSize;
+    const Uint64 generation = game->generation;
+    Uint64 * cost = (Uint64 *)calloc(tilesX + tilesY, sizeof(Uint64));
+    Uint32 * xs = (Uint32 *)malloc(sizeof(Uint32) * (mpi->dims[1] + 1));
+    Uint32 * ys = (Uint32 *)malloc(sizeof(Uint32) * (mpi->dims[0] + 1));
+    int * counts = (int *)calloc(4 * mpi->size, sizeof(int));   // Sent, received, then their offsets
+    Uint32 before[4], after[4], other[4], cut[4];
+    Uint32 * oldXs, * oldYs;
+    Uint8 * out, * in;
+    Uint64 sent = 0, received = 0;
+    Uint32 x, y, i;
+    int r, c[2];
+
+    if ( ! cost || ! xs || ! ys || ! counts)
+    {
+        fprintf(stderr, "Not enough memory to rebalance the ranks\n");
+        MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+    }
+    for (i = 0; mpi->tileWork && i < game->tilesX * game->tilesY; i++)
+    {
+        cost[firstX + i % game->tilesX] += mpi->tileWork[i];
+        cost[tilesX + firstY + i / game->tilesX] += mpi->tileWork[i];
+    }
+    MPI_Allreduce(MPI_IN_PLACE, cost, (int)(tilesX + tilesY), MPI_UINT64_T, MPI_SUM, mpi->comm);
+    for (i = 0; i < tilesX + tilesY; i++)
+    {
+        cost[i] += (mpi->rebalance + 7) / 8 * (i < tilesX ? tilesY : tilesX);
+    }
+    mpi_split(cost, tilesX, mpi->dims[1], xs, mpi->width);
+    mpi_split(cost + tilesX, tilesY, mpi->dims[0], ys, mpi->height);
+    free(cost);
+    if (mpi->tileWork)
+    {
+        memset(mpi->tileWork, 0, sizeof(Uint64) * game->tilesX * game->tilesY);
+    }
+    if ( ! memcmp(xs, mpi->xs, sizeof(Uint32) * (mpi->dims[1] + 1)) && ! memcmp(ys, mpi->ys, sizeof(Uint32) * (mpi->dims[0] + 1)))
+    {
+        free(xs);
+        free(ys);
+        free(counts);
+        return;
+    }
+
+    // Each rank sends to each other one the part of its old subdomain lying in their new one
+    mpi_rect(mpi->xs, mpi->ys, mpi->coords, before);
+    mpi_rect(xs, ys, mpi->coords, after);
+    for (r = 0; r < mpi->size; r++)
+    {
+        MPI_Cart_coords(mpi->comm, r, 2, c);
+        mpi_rect(xs, ys, c, other);
+        counts[r] = (int)mpi_intersect(before, other, cut);
+        counts[2 * mpi->size + r] = (int)sent;
+        sent += counts[r];
+        mpi_rect(mpi->xs, mpi->ys, c, other);
+        counts[mpi->size + r] = (int)mpi_intersect(other, after, cut);
+        counts[3 * mpi->size + r] = (int)received;
+        received += counts[mpi->size + r];
+    }
+    out = (Uint8 *)malloc(sent ? sent : 1);
+    in = (Uint8 *)malloc(received ? received : 1);
+    if ( ! out || ! in)
+    {
+        fprintf(stderr, "Not enough memory to rebalance the ranks\n");
+        MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+    }
+    for (r = 0, sent = 0; r < mpi->size; r++)
+    {
+        MPI_Cart_coords(mpi->comm, r, 2, c);
+        mpi_rect(xs, ys, c, other);
+        if (mpi_intersect(before, other, cut))
+        {
+            for (y = cut[2]; y < cut[3]; y++)
+            {
+                for (x = cut[0]; x < cut[1]; x++)
+                {
+                    out[sent++] = board_get_cell(game_board(game), x - before[0], y - before[2]);
+                }
+            }
+        }
+    }
+    MPI_Alltoallv(out, counts, counts + 2 * mpi->size, MPI_BYTE, in, counts + mpi->size, counts + 3 * mpi->size, MPI_BYTE, mpi->comm);
+    free(out);
+
+    // New boards: every tile is computed again, the back buffer holds nothing right
+    oldXs = mpi->xs;
+    oldYs = mpi->ys;
+    mpi->xs = xs;
+    mpi->ys = ys;
+    game_dispose_boards(game);
+    mpi_set_local(game);
+    game_create_boards(game);
+    game->generation = generation;
+    for (r = 0, received = 0; r < mpi->size; r++)
+    {
+        MPI_Cart_coords(mpi->comm, r, 2, c);
+        mpi_rect(oldXs, oldYs, c, other);
+        if (mpi_intersect(other, after, cut))
+        {
+            for (y = cut[2]; y < cut[3]; y++)
+            {
+                for (x = cut[0]; x < cut[1]; x++)
+                {
+                    board_set_cell(game_board(game), x - after[0], y - after[2], in[received++]);
+                }
+            }
+        }
+    }
+    free(in);
+    free(counts);
+    free(oldXs);
+    free(oldYs);
+    printf("Generation %llu: rebalanced, %ux%u cells on rank 0\n", (unsigned long long)generation, game->width, game->height);
+}
+
+/**
+ * Where a halo message of a direction lands: the message going north is
+ * the top row of the sender and the bottom halo row of the receiver
+ * @param board
+ * @param d Direction the message travels in
+ * @param x, y Receive the first halo cell
+ */
+static void mpi_halo_cell(const Board * board, int d, int * x, int * y)
+{
+    *y = kMpiDirections[d][0] < 0 ? (int)board->height : kMpiDirections[d][0] > 0 ? -1 : 0;
+    *x = kMpiDirections[d][1] < 0 ? (int)board->width : kMpiDirections[d][1] > 0 ? -1 : 0;
+}
+
+/**
+ * Do the computation of the subdomain. The halo exchange goes on while the
+ * inner tiles are computed: they don't read the halo. Those tiles are only
+ * computed when they or a neighbour changed, like --active; the ring of
+ * tiles along the edges always is, once the halo arrived, since a change
+ * on another rank is not tracked. Each tile is computed with the kernel of
+ * the tiled backend.
+ * @param game
+ * @return 1, a single generation is computed
+ */
+static Uint32 board_compute_mpi(GameContainer * game)
+{
+    MpiDomain * mpi = game->mpi;
+    MPI_Request requests[16];
+    Board * board;
+    Uint8 * changed;
+    Uint32 * list;
+    Uint32 x, y, inner, count = 0;
+    int d, i, hx, hy;
+
+    if (mpi->rebalance && game->generation >= mpi->nextRebalance)
+    {
+        mpi_rebalance(game);
+        mpi->nextRebalance = game->generation + mpi->rebalance;
+    }
+    if ( ! game->changedTiles)
+    {
+        game_create_activity(game);
+    }
+    if ( ! mpi->tileWork)
+    {
+        mpi->tileWork = (Uint64 *)calloc((size_t)game->tilesX * game->tilesY, sizeof(Uint64));
+        if ( ! mpi->tileWork)
+        {
+            fprintf(stderr, "Not enough memory for the tile map\n");
+            MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+        }
+    }
+    board = game_board(game);
+    changed = game->changedTiles;
+    list = game->activeList;
+
+    // Post the halo exchange: rows straight from the board, columns and corners through buffers
+    for (d = 0; d < 8; d++)
+    {
+        const int from = mpi->neighbours[d ^ 1];
+        mpi_halo_cell(board, d, &hx, &hy);
+        if ( ! kMpiDirections[d][1])
+        {
+            MPI_Irecv(board_row(board, hy), (int)board_row_bytes(board), MPI_BYTE, from, d, mpi->comm, &requests[d]);
+        }
+        else if ( ! kMpiDirections[d][0])
+        {
+            MPI_Irecv(mpi->columns[2 + (d & 1)], (int)board->height, MPI_BYTE, from, d, mpi->comm, &requests[d]);
+        }
+        else
+        {
+            MPI_Irecv(&mpi->corners[4 + (d & 3)], 1, MPI_BYTE, from, d, mpi->comm, &requests[d]);
+        }
+    }
+    for (d = 0; d < 8; d++)
+    {
+        const int to = mpi->neighbours[d];
+        const Uint32 sx = kMpiDirections[d][1] > 0 ? board->width - 1 : 0;
+        const Uint32 sy = kMpiDirections[d][0] > 0 ? board->height - 1 : 0;
+        if ( ! kMpiDirections[d][1])
+        {
+            MPI_Isend(board_row(board, sy), (int)board_row_bytes(board), MPI_BYTE, to, d, mpi->comm, &requests[8 + d]);
+        }
+        else if ( ! kMpiDirections[d][0])
+        {
+            for (y = 0; y < board->height; y++)
+            {
+                mpi->columns[d & 1][y] = board_get_cell(board, sx, y);
+            }
+            MPI_Isend(mpi->columns[d & 1], (int)board->height, MPI_BYTE, to, d, mpi->comm, &requests[8 + d]);
+        }
+        else
+        {
+            mpi->corners[d & 3] = board_get_cell(board, sx, sy);
+            MPI_Isend(&mpi->corners[d & 3], 1, MPI_BYTE, to, d, mpi->comm, &requests[8 + d]);
+        }
+    }
+
+    // The inner tiles to compute from what changed last time, then the ring
+    for (y = 1; y + 1 < game->tilesY; y++)
+    {
+        for (x = 1; x + 1 < game->tilesX; x++)
+        {
+            const Uint8 * around = changed + (y - 1) * game->tilesX + x - 1;
+            const Uint32 w = game->tilesX;
+            if (game->activityReset || around[0] | around[1] | around[2] | around[w] | around[w + 1] | around[w + 2] |
+                around[2 * w] | around[2 * w + 1] | around[2 * w + 2])
+            {
+                list[count++] = y * game->tilesX + x;
+            }
+        }
+    }
+    inner = count;
+    for (y = 0; y < game->tilesY; y++)
+    {
+        for (x = 0; x < game->tilesX; x++)
+        {
+            if ( ! y || ! x || y + 1 == game->tilesY || x + 1 == game->tilesX)
+            {
+                list[count++] = y * game->tilesX + x;
+            }
+        }
+    }
+    game->activityReset = No;
+    game->activeCount = count;
+    memset(changed, 0, (size_t)game->tilesX * game->tilesY);
+
+    if (openmp_serial())
+    {
+        for (i = 0; i < (int)inner; i++)
+        {
+            board_compute_active_tile(game, NULL, list[i]);
+        }
+    }
+    else
+    {
+        #pragma omp parallel for schedule(dynamic, 16)
+        for (i = 0; i < (int)inner; i++)
+        {
+            board_compute_active_tile(game, NULL, list[i]);
+        }
+    }
+
+    // The halo is complete once the columns and the corners are in place
+    MPI_Waitall(16, requests, MPI_STATUSES_IGNORE);
+    for (d = 0; d < 8; d++)
+    {
+        mpi_halo_cell(board, d, &hx, &hy);
+        for (y = 0; kMpiDirections[d][1] && ! kMpiDirections[d][0] && y < board->height; y++)
+        {
+            board_set_halo(board, hx, y, mpi->neighbours[d ^ 1] == MPI_PROC_NULL ? mpi->topology == TOPOLOGY_ALIVE : mpi->columns[2 + (d & 1)][y]);
+        }
+        if (kMpiDirections[d][1] && kMpiDirections[d][0])
+        {
+            board_set_halo(board, hx, hy, mpi->neighbours[d ^ 1] == MPI_PROC_NULL ? mpi->topology == TOPOLOGY_ALIVE : mpi->corners[4 + (d & 3)]);
+        }
+        for (x = 0; ! kMpiDirections[d][1] && mpi->neighbours[d ^ 1] == MPI_PROC_NULL && mpi->topology == TOPOLOGY_ALIVE && x < board->width; x++)
+        {
+            board_set_halo(board, x, hy, 1);
+        }
+    }
+
+    if (openmp_serial())
+    {
+        for (i = (int)inner; i < (int)count; i++)
+        {
+            board_compute_active_tile(game, NULL, list[i]);
+        }
+    }
+    else
+    {
+        #pragma omp parallel for schedule(dynamic, 4)
+        for (i = (int)inner; i < (int)count; i++)
+        {
+            board_compute_active_tile(game, NULL, list[i]);
+        }
+    }
+    for (i = 0; i < (int)count; i++)
+    {
+        mpi->tileWork[list[i]]++;
+    }
+
+    return 1;
+}
+
+#endif
+
+/**
+ * Sum a count over the ranks of an --mpi run
+ * @param game
+ * @param value The count of this rank
+ * @return The total, or value itself without MPI
+ */
+static Uint64 game_sum(const GameContainer * game, Uint64 value)
+{
+#ifdef USE_MPI
+    if (game->mpi)
+    {
+        MPI_Allreduce(MPI_IN_PLACE, &value, 1, MPI_UINT64_T, MPI_SUM, game->mpi->comm);
+    }
+#else
+    (void)game;
+#endif
+    return value;
+}
+
+/**
+ * Receives the living cells of a pattern file while it is read, one run of
+ * consecutive cells at a time
+ * @param ctx
+ * @param x, y First cell of the run, from the top left corner of the pattern
+ * @param length Number of cells
+ */
+typedef void (*PatternRunFunc)(void * ctx, Sint64 x, Sint64 y, Uint64 length);
+
+const Uint64 kPatternMaxSide = 1 << 24; // Largest pattern side, as for a board: keeps the loaders in range
+
+/**
+ * Read a Golly RLE or a plaintext (.cells) pattern, the format is guessed
+ * from the first line which is not a comment. Nothing is stored: the living
+ * runs go straight to the callback.
+ * @param file
+ * @param run Callback, NULL to only measure the pattern: an RLE header is then enough
+ * @param ctx Passed to the callback
+ * @param width, height Out: size of the pattern
+ * @return 0 on success, -1 if the file is not a pattern or is larger than kPatternMaxSide
+ */
+static int pattern_read(FILE * file, PatternRunFunc run, void * ctx, Uint64 * width, Uint64 * height)
+{
+    int c;
+    int rle = -1;                       // Unknown until the first line which is not a comment
+    int lineStart = Yes;
+    Uint64 x = 0, y = 0, count = 0;
+    Uint64 runStart = 0, runLength = 0; // Plaintext run not given to the callback yet
+    char line[256];
+
+    *width = 0;
+    *height = 0;
+    while ((c = getc(file)) != EOF)
+    {
+        if (lineStart && ((c == '#' && rle != No) || (c == '!' && rle != Yes)))
+        {
+            // Comment line: "#N name" in RLE, "!Name: name" in plaintext
+            rle = c == '#';
+            while ((c = getc(file)) != EOF && c != '\n');
+            continue;
+        }
+        if (lineStart && c == 'x' && rle != No)
+        {
+            // RLE header: x = 3, y = 3, rule = B3/S23
+            unsigned long long w, h;
+            const char * rule;
+            char name[64];
+            Rule patternRule;
+            if ( ! fgets(line, sizeof(line), file) || sscanf(line, " = %llu , y = %llu", &w, &h) != 2 ||
+                w > kPatternMaxSide || h > kPatternMaxSide)
+            {
+                return -1;
+            }
+            rule = strstr(line, "rule");
+            // Measuring first then reading warns once
+            if (run && rule && sscanf(rule, "rule = %63[^ \t\r\n]", name) == 1 &&
+                ( ! rule_parse(name, &patternRule) || ! rule_equal(&patternRule, &gRule)))
+            {
+                fprintf(stderr, "The pattern is for the rule %s, it runs as %s\n", name, gRule.name);
+            }
+            *width = w;
+            *height = h;
+            rle = Yes;
+            x = 0;
+            y = 0;
+            if ( ! run)
+            {
+                return 0;
+            }
+            continue;
+        }
+        lineStart = c == '\n';
+        if (rle < 0 && c != '\n' && c != '\r')
+        {
+            rle = c != '.' && c != 'O' && c != '*';
+        }
+        
+        if (rle == Yes)
+        {
+            // <count><tag>: b dead cells, o (or any other letter) living cells, $ ends the row, ! the pattern
+            if (c >= '0' && c <= '9')
+            {
+                count = count * 10 + (c - '0');
+                if (count > kPatternMaxSide)
+                {
+                    return -1;
+                }
+                continue;
+            }
+            if (count == 0)
+            {
+                count = 1;
+            }
+            if (c == 'b' || c == '.')
+            {
+                if (x + count > kPatternMaxSide)
+                {
+                    return -1;
+                }
+                x += count;
+            }
+            else if ((c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z'))
+            {
+                if (x + count > kPatternMaxSide || y >= kPatternMaxSide)
+                {
+                    return -1;
+                }
+                if (run)
+                {
+                    run(ctx, x, y, count);
+                }
+                x += count;
+                *width = x > *width ? x : *width;
+                *height = y + 1 > *height ? y + 1 : *height;
+            }
+            else if (c == '$')
+            {
+                if (y + count > kPatternMaxSide)
+                {
+                    return -1;
+                }
+                y += count;
+                x = 0;
+            }
+            else if (c == '!')
+            {
+                return 0;
+            }
+            else if (c != '\n' && c != '\r' && c != ' ' && c != '\t')
+            {
+                return -1;
+            }
+            count = 0;
+        }
+        else if ((c == 'O' || c == '*') && (x >= kPatternMaxSide || y >= kPatternMaxSide))
+        {
+            return -1;
+        }
+        else if (c == 'O' || c == '*')
+        {
+            if ( ! runLength)
+            {
+                runStart = x;
+            }
+            runLength++;
+            x++;
+            *width = x > *width ? x : *width;
+            *height = y + 1 > *height ? y + 1 : *height;
+        }
+        else if (c == '.' || c == '\n')
+        {
+            if (runLength && run)
+            {
+                run(ctx, runStart, y, runLength);
+            }
+            runLength = 0;
+            x++;
+            if (c == '\n')
+            {
+                x = 0;
+                y++;
+            }
+        }
+        else if (c != '\r' && c != ' ' && c != '\t')
+        {
+            return -1;
+        }
+    }
+    if (runLength && run)
+    {
+        run(ctx, runStart, y, runLength);
+    }
+    return 0;
+}
+
+/**
+ * Set consecutive cells of a row alive, a word at a time on packed boards
+ * @param board
+ * @param x, y First cell
+ * @param length Number of cells, they must fit in the row
+ */
+static void board_set_run(Board * board, Uint32 x, Uint32 y, Uint32 length)
+{
+    if (board->format == BOARD_PACKED)
+    {
+        Uint64 * row = board_packed_row(board, y);
+        while (length)
+        {
+            const Uint32 bits = 64 - (x & 63) < length ? 64 - (x & 63) : length;
+            row[x >> 6] |= (bits == 64 ? ~0ULL : ((1ULL << bits) - 1)) << (x & 63);
+            x += bits;
+            length -= bits;
+        }
+    }
+    else
+    {
+        memset(board_row(board, y) + x, 1, length);
+    }
+}
+
+/**
+ * Where the runs of a pattern go on a dense board
+ */
+typedef struct PatternTarget
+{
+    Board * board;
+    Sint64 left, top;                   // Cell of the board receiving the top left corner of the pattern
+    Uint64 clipped;                     // Living cells falling outside of the board
+} PatternTarget;
+
+/**
+ * PatternRunFunc writing to a dense board, the cells out of it are dropped
+ */
+static void pattern_board_run(void * ctx, Sint64 x, Sint64 y, Uint64 length)
+{
+    PatternTarget * target = (PatternTarget *)ctx;
+    const Sint64 width = target->board->width;
+    Sint64 left = target->left + x, right = left + (Sint64)length;
+    
+    y += target->top;
+    if (y < 0 || y >= (Sint64)target->board->height)
+    {
+        target->clipped += length;
+        return;
+    }
+    left = left < 0 ? 0 : left;
+    right = right > width ? width : right;
+    if (left >= right)
+    {
+        target->clipped += length;
+        return;
+    }
+    target->clipped += length - (Uint64)(right - left);
+    board_set_run(target->board, (Uint32)left, (Uint32)y, (Uint32)(right - left));
+}
+
+/**
+ * PatternRunFunc writing to a sparse universe, the top left corner of the
+ * pattern at the origin
+ */
+static void pattern_sparse_run(void * ctx, Sint64 x, Sint64 y, Uint64 length)
+{
+    Sparse * sparse = (Sparse *)ctx;
+    
+    while (length)
+    {
+        const Uint64 room = 64 - (Uint64)(x & 63);
+        const Uint64 bits = room < length ? room : length;
+        Chunk * chunk = sparse_get(sparse, (Sint32)(x >> 6), (Sint32)(y >> 6));
+        chunk->rows[sparse->current][y & 63] |= (bits == 64 ? ~0ULL : ((1ULL << bits) - 1)) << (x & 63);
+        x += bits;
+        length -= bits;
+    }
+}
+
+/**
+ * PatternRunFunc writing to a HashLife universe, the top left corner of the
+ * pattern at the origin
+ */
+static void pattern_hashlife_run(void * ctx, Sint64 x, Sint64 y, Uint64 length)
+{
+    hashlife_set_run((HashLife *)ctx, (Uint64)x, (Uint64)y, length);
+}
+
+/**
+ * Find the next cell of a row in a given state, a word at a time
+ * @param board
+ * @param x First cell to look at
+ * @param y Row
+ * @param alive State looked for
+ * @return Its column, the width of the board if there is none
+ */
+static Uint32 board_next_cell(const Board * board, Uint32 x, Uint32 y, int alive)
+{
+    Uint64 bits;
+    
+    if (x >= board->width)
+    {
+        return board->width;
+    }
+    bits = (alive ? board_row_bits(board, x & ~63u, y) : ~board_row_bits(board, x & ~63u, y)) & (~0ULL << (x & 63));
+    x &= ~63u;
+    while ( ! bits)
+    {
+        x += 64;
+        if (x >= board->width)
+        {
+            return board->width;
+        }
+        bits = alive ? board_row_bits(board, x, y) : ~board_row_bits(board, x, y);
+    }
+    x += __builtin_ctzll(bits);
+    return x < board->width ? x : board->width;
+}
+
+/**
+ * Append an item to an RLE file, lines are kept under 70 characters
+ * @param file
+ * @param count Repeat count, not written when 1
+ * @param tag 'b', 'o', '$' or '!'
+ * @param column In/out: length of the current line
+ */
+static void rle_write_item(FILE * file, Uint64 count, char tag, int * column)
+{
+    char item[32];
+    const int length = count > 1 ? sprintf(item, "%llu%c", (unsigned long long)count, tag) : sprintf(item, "%c", tag);
+    
+    if (*column + length > 70)
+    {
+        putc('\n', file);
+        *column = 0;
+    }
+    fputs(item, file);
+    *column += length;
+}
+
+/**
+ * Write the cells of a board as RLE
+ * @param board
+ * @param file
+ * @return 0 on success, -1 on a write error
+ */
+static int board_write_rle(const Board * board, FILE * file)
+{
+    Uint32 x, y, start, end;
+    Uint64 rows = 0;                    // Row ends not written yet: the empty rows at the bottom are left out
+    int column = 0;
+    
+    fprintf(file, "x = %u, y = %u, rule = %s\n", board->width, board->height, gRule.name);
+    for (y = 0; y < board->height; y++)
+    {
+        for (x = 0; (start = board_next_cell(board, x, y, Yes)) < board->width; x = end)
+        {
+            end = board_next_cell(board, start, y, No);
+            if (rows)
+            {
+                rle_write_item(file, rows, '$', &column);
+                rows = 0;
+            }
+            if (start > x)
+            {
+                rle_write_item(file, start - x, 'b', &column);
+            }
+            rle_write_item(file, end - start, 'o', &column);
+        }
+        rows++;
+    }
+    rle_write_item(file, 1, '!', &column);
+    putc('\n', file);
+    return ferror(file) ? -1 : 0;
+}
+
+/**
+ * Write the cells of a board as plaintext, the trailing dead cells of each
+ * row left out
+ * @param board
+ * @param generation Written in the comment line
+ * @param file
+ * @return 0 on success, -1 on a write error
+ */
+static int board_write_cells(const Board * board, Uint64 generation, FILE * file)
+{
+    Uint32 x, y, start, end;
+    
+    fprintf(file, "!Name: generation %llu\n", (unsigned long long)generation);
+    for (y = 0; y < board->height; y++)
+    {
+        for (x = 0; (start = board_next_cell(board, x, y, Yes)) < board->width; x = end)
+        {
+            end = board_next_cell(board, start, y, No);
+            for (; x < start; x++)
+            {
+                putc('.', file);
+            }
+            for (; x < end; x++)
+            {
+                putc('O', file);
+            }
+        }
+        putc('\n', file);
+    }
+    return ferror(file) ? -1 : 0;
+}
+
+/**
+ * Header of a snapshot. It is followed, at kSnapshotData, by the block of a
+ * packed board as board_create lays it out: the halo rows and columns
+ * included and cleared, in the byte order of the host. A host with the same
+ * alignment maps it as is (see board_load_snapshot).
+ */
+typedef struct SnapshotHeader
+{
+    char magic[8];                      // kSnapshotMagic
+    Uint32 version;
+    Uint32 width;
+    Uint32 height;
+    Uint32 stride;                      // Distance in bytes between two rows
+    Uint32 alignment;                   // kBoardAlignment of the writer
+    Uint32 unused;
+    Uint64 generation;
+} SnapshotHeader;
+
+const char kSnapshotMagic[8] = { 'G', 'O', 'L', 'S', 'N', 'A', 'P', '1' };
+const Uint32 kSnapshotData = 4096;      // Offset of the board: one page, so the mapping is page aligned
+
+/**
+ * Read the header of a snapshot file
+ * @param path
+ * @param header Out
+ * @return 0 if the file is a snapshot, -1 otherwise (a pattern, or not readable)
+ */
+static int snapshot_read_header(const char * path, SnapshotHeader * header)
+{
+    FILE * file = fopen(path, "rb");
+    int found;
+    
+    if ( ! file)
+    {
+        return -1;
+    }
+    found = fread(header, sizeof(SnapshotHeader), 1, file) == 1 && ! memcmp(header->magic, kSnapshotMagic, sizeof(kSnapshotMagic)) &&
+            header->version == 1 && header->stride == board_stride(header->width, BOARD_PACKED);
+    fclose(file);
+    return found ? 0 : -1;
+}
+
+/**
+ * Write a board as a snapshot, packed whatever its storage
+ * @param board
+ * @param generation
+ * @param file
+ * @return 0 on success, -1 on a write error
+ */
+static int board_write_snapshot(const Board * board, Uint64 generation, FILE * file)
+{
+    SnapshotHeader header;
+    const Uint32 words = (board->width + 63) / 64;
+    Uint8 * row;
+    Uint32 y, i;
+    int status = 0;
+    
+    memset(&header, 0, sizeof(SnapshotHeader));
+    memcpy(header.magic, kSnapshotMagic, sizeof(kSnapshotMagic));
+    header.version = 1;
+    header.width = board->width;
+    header.height = board->height;
+    header.stride = board_stride(board->width, BOARD_PACKED);
+    header.alignment = kBoardAlignment;
+    header.generation = generation;
+    
+    row = (Uint8 *)calloc(header.stride > kSnapshotData ? header.stride : kSnapshotData, 1);
+    if ( ! row)
+    {
+        fprintf(stderr, "Not enough memory to write the snapshot\n");
+        exit(EXIT_FAILURE);
+    }
+    memcpy(row, &header, sizeof(SnapshotHeader));
+    status |= fwrite(row, kSnapshotData, 1, file) != 1;
+    memset(row, 0, kSnapshotData);
+    
+    // The halo rows around the playable ones
+    status |= fwrite(row, header.stride, 1, file) != 1;
+    for (y = 0; y < board->height && ! status; y++)
+    {
+        Uint64 * bits = (Uint64 *)(row + kBoardAlignment);
+        for (i = 0; i < words; i++)
+        {
+            bits[i] = board_row_bits(board, i * 64, y);
+        }
+        if (board->width & 63)
+        {
+            bits[words - 1] &= (1ULL << (board->width & 63)) - 1;
+        }
+        status |= fwrite(row, header.stride, 1, file) != 1;
+    }
+    memset(row, 0, header.stride);
+    status |= fwrite(row, header.stride, 1, file) != 1;
+    
+    free(row);
+    return status ? -1 : 0;
+}
+
+/**
+ * Load a snapshot in a board which is not allocated yet. A packed board with
+ * the alignment of the file maps it privately: nothing is read before the
+ * cells are used, and the pages written by the game are copied on write.
+ * Otherwise the cells are copied from the mapping into a new board.
+ * @param board
+ * @param path
+ * @param format Storage of the board
+ * @param generation Out: generation of the snapshot
+ * @return 0 on success, -1 if the file can't be loaded
+ */
+static int board_load_snapshot(Board * board, const char * path, BoardFormat format, Uint64 * generation)
+{
+    SnapshotHeader header;
+    struct stat info;
+    size_t size;
+    Uint8 * map;
+    Uint32 y, i;
+    int fd;
+    
+    if (snapshot_read_header(path, &header))
+    {
+        return -1;
+    }
+    size = (size_t)header.stride * (header.height + 2);
+    fd = open(path, O_RDONLY);
+    if (fd < 0 || fstat(fd, &info) || (Uint64)info.st_size < kSnapshotData + size)
+    {
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+        return -1;
+    }
+    map = (Uint8 *)mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, kSnapshotData);
+    close(fd);
+    if (map == MAP_FAILED)
+    {
+        return -1;
+    }
+    *generation = header.generation;
+    
+    if (format == BOARD_PACKED && header.alignment == kBoardAlignment)
+    {
+        board->width = header.width;
+        board->height = header.height;
+        board->format = BOARD_PACKED;
+        board->words = (header.width + 63) / 64;
+        board->stride = header.stride;
+        board->memory = map;
+        board->cells = map + header.stride + header.alignment;
+        board->mapped = size;
+        return 0;
+    }
+    
+    if (board_create(board, header.width, header.height, format))
+    {
+        munmap(map, size);
+        return -1;
+    }
+    madvise(map, size, MADV_SEQUENTIAL);
+    for (y = 0; y < header.height; y++)
+    {
+        const Uint64 * bits = (const Uint64 *)(map + (size_t)(y + 1) * header.stride + header.alignment);
+        for (i = 0; i < board->words; i++)
+        {
+            Uint64 word = bits[i];
+            while (word)
+            {
+                board_set_cell(board, i * 64 + __builtin_ctzll(word), y, 1);
+                word &= word - 1;
+            }
+        }
+    }
+    munmap(map, size);
+    return 0;
+}
+
+/**
+ * Replace the current board by the content of a file: a snapshot, which must
+ * have the size of the board, or a pattern, centered on it
+ * @param game
+ * @param path
+ */
+static void game_load(GameContainer * game, const char * path)
+{
+    SnapshotHeader header;
+    PatternTarget target;
+    Uint64 width, height;
+    FILE * file;
+    
+    if ( ! snapshot_read_header(path, &header))
+    {
+        board_dispose(game_board(game));
+        if (header.width != game->width || header.height != game->height ||
+            board_load_snapshot(game_board(game), path, game->format, &game->generation))
+        {
+            fprintf(stderr, "Can't load the %ux%u snapshot %s in a %ux%u board\n", header.width, header.height, path, game->width, game->height);
+            exit(EXIT_FAILURE);
+        }
+        if (game->ages)
+        {
+            memset(game->ages, 0, (size_t)game->width * game->height);
+        }
+    }
+    else
+    {
+        file = fopen(path, "r");
+        if ( ! file || pattern_read(file, NULL, NULL, &width, &height))
+        {
+            fprintf(stderr, "Can't read the pattern %s\n", path);
+            exit(EXIT_FAILURE);
+        }
+        rewind(file);
+        target.board = game_board(game);
+        target.left = ((Sint64)game->width - (Sint64)width) / 2;
+        target.top = ((Sint64)game->height - (Sint64)height) / 2;
+        target.clipped = 0;
+        board_reset(game);
+        if (pattern_read(file, pattern_board_run, &target, &width, &height))
+        {
+            fprintf(stderr, "Invalid pattern %s\n", path);
+            exit(EXIT_FAILURE);
+        }
+        fclose(file);
+        if (target.clipped)
+        {
+            fprintf(stderr, "%llu living cells of the %llux%llu pattern %s are out of the %ux%u board\n",
+                    (unsigned long long)target.clipped, (unsigned long long)width, (unsigned long long)height, path, game->width, game->height);
+        }
+    }
+    game->activityReset = Yes;
+    game->redrawAll = Yes;
+    game->hashValid = No;
+}
+
+/**
+ * Fill the current board of a headless run: the --load file, or at random
+ * @param game
+ * @param seed Seed of the random board
+ * @param density Percentage of living cells
+ */
+static void game_populate(GameContainer * game, Uint64 seed, Uint32 density)
+{
+    if (game->loadPath)
+    {
+        game_load(game, game->loadPath);
+    }
+#ifdef USE_MPI
+    else if (game->mpi)
+    {
+        mpi_populate(game, seed, density);
+    }
+#endif
+    else
+    {
+        board_randomize(game_board(game), seed, density);
+    }
+}
+
+/**
+ * Save the current board: RLE for a .rle path, plaintext for .cells, a
+ * snapshot otherwise
+ * @param game
+ * @param path
+ * @return 0 on success, -1 on failure (reported)
+ */
+static int game_save(const GameContainer * game, const char * path)
+{
+    const size_t length = strlen(path);
+    FILE * file = fopen(path, "wb");
+    int status;
+    
+    if ( ! file)
+    {
+        fprintf(stderr, "Can't create %s\n", path);
+        return -1;
+    }
+    if (length > 4 && ! strcmp(path + length - 4, ".rle"))
+    {
+        status = board_write_rle(game_board(game), file);
+    }
+    else if (length > 6 && ! strcmp(path + length - 6, ".cells"))
+    {
+        status = board_write_cells(game_board(game), game->generation, file);
+    }
+    else
+    {
+        status = board_write_snapshot(game_board(game), game->generation, file);
+    }
+    if (fclose(file) || status)
+    {
+        fprintf(stderr, "Can't write %s\n", path);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * Load a file in a sparse universe, without any dense board: the pattern runs
+ * or the words of the snapshot go straight to their chunks
+ * @param sparse
+ * @param path
+ */
+static void sparse_load(Sparse * sparse, const char * path)
+{
+    SnapshotHeader header;
+    Uint64 width, height;
+    Board board;
+    FILE * file;
+    Uint32 y, i;
+    
+    if ( ! snapshot_read_header(path, &header))
+    {
+        if (board_load_snapshot(&board, path, BOARD_PACKED, &sparse->generation))
+        {
+            fprintf(stderr, "Can't load the snapshot %s\n", path);
+            exit(EXIT_FAILURE);
+        }
+        for (y = 0; y < board.height; y++)
+        {
+            const Uint64 * row = board_packed_row(&board, y);
+            for (i = 0; i < board.words; i++)
+            {
+                if (row[i])
+                {
+                    sparse_get(sparse, (Sint32)i, (Sint32)(y / 64))->rows[sparse->current][y & 63] = row[i];
+                }
+            }
+        }
+        board_dispose(&board);
+        return;
+    }
+    
+    file = fopen(path, "r");
+    if ( ! file || pattern_read(file, pattern_sparse_run, sparse, &width, &height))
+    {
+        fprintf(stderr, "Can't read the pattern %s\n", path);
+        exit(EXIT_FAILURE);
+    }
+    fclose(file);
+}
+
+/**
+ * Create a HashLife universe from a file. The runs of a pattern are set in
+ * the quadtree as they are read, without any dense board; a snapshot is a
+ * dense board already.
+ * @param life
+ * @param path
+ * @param memoryCap Bytes of nodes allowed before collecting the garbage
+ */
+static void hashlife_load(HashLife * life, const char * path, size_t memoryCap)
+{
+    SnapshotHeader header;
+    Uint64 width, height, generation = 0;
+    Board board;
+    FILE * file;
+    
+    if ( ! snapshot_read_header(path, &header))
+    {
+        if (board_load_snapshot(&board, path, BOARD_PACKED, &generation))
+        {
+            fprintf(stderr, "Can't load the snapshot %s\n", path);
+            exit(EXIT_FAILURE);
+        }
+        hashlife_create(life, &board, memoryCap);
+        life->generation = generation;
+        board_dispose(&board);
+        return;
+    }
+    
+    hashlife_create(life, NULL, memoryCap);
+    file = fopen(path, "r");
+    if ( ! file || pattern_read(file, pattern_hashlife_run, life, &width, &height))
+    {
+        fprintf(stderr, "Can't read the pattern %s\n", path);
+        exit(EXIT_FAILURE);
+    }
+    fclose(file);
+}
+
+/**
+ * GPU state of --opengl. The generations live in two textures, one byte per
+ * cell, and a fragment shader pass renders the next one in the other texture
+ * through its framebuffer. The window samples the current texture directly:
+ * nothing comes back to the CPU while the game runs.
+ * The GL 2.0/3.0 entry points are not exported by every libGL, they are
+ * fetched once with SDL_GL_GetProcAddress.
+ */
+struct GpuLife
+{
+    GLuint textures[2];                 // Indexed like GameContainer.boards (game->current)
+    GLuint framebuffers[2];             // framebuffers[i] renders into textures[i]
+    GLuint stepProgram;                 // Computes a generation
+    GLuint drawProgram;                 // Shows a generation
+    GLint stepTexel;                    // Uniform: size of a cell in texture coordinates
+    GLuint overlay;                     // Texture of the buttons and timings
+    float zoom;                         // Pixels per cell
+    float viewX, viewY;                 // Cell shown at the top left corner of the window
+    PFNGLCREATESHADERPROC createShader;
+    PFNGLSHADERSOURCEPROC shaderSource;
+    PFNGLCOMPILESHADERPROC compileShader;
+    PFNGLGETSHADERIVPROC getShaderiv;
+    PFNGLGETSHADERINFOLOGPROC getShaderInfoLog;
+    PFNGLDELETESHADERPROC deleteShader;
+    PFNGLCREATEPROGRAMPROC createProgram;
+    PFNGLATTACHSHADERPROC attachShader;
+    PFNGLLINKPROGRAMPROC linkProgram;
+    PFNGLGETPROGRAMIVPROC getProgramiv;
+    PFNGLGETPROGRAMINFOLOGPROC getProgramInfoLog;
+    PFNGLDELETEPROGRAMPROC deleteProgram;
+    PFNGLUSEPROGRAMPROC useProgram;
+    PFNGLUNIFORM1FVPROC uniform1fv;
+    PFNGLGETUNIFORMLOCATIONPROC getUniformLocation;
+    PFNGLUNIFORM1IPROC uniform1i;
+    PFNGLUNIFORM2FPROC uniform2f;
+    PFNGLGENFRAMEBUFFERSPROC genFramebuffers;
+    PFNGLBINDFRAMEBUFFERPROC bindFramebuffer;
+    PFNGLFRAMEBUFFERTEXTURE2DPROC framebufferTexture2D;
+    PFNGLCHECKFRAMEBUFFERSTATUSPROC checkFramebufferStatus;
+    PFNGLDELETEFRAMEBUFFERSPROC deleteFramebuffers;
+};
+
+const float kMinZoom = 1.0f / 16;       // Pixels per cell when zoomed out the most
+const float kMaxZoom = 64;
+
+static const char * kGpuVertexShader =
+    "#version 120\n"
+    "void main()\n"
+    "{\n"
+    "    gl_TexCoord[0] = gl_MultiTexCoord0;\n"
+    "    gl_Position = ftransform();\n"
+    "}\n";
+
+// Outside the board the texture border is black: the same dead halo as the CPU boards.
+// rule[count + 9 * alive] is the next state, set once from gRule by gpu_create.
+static const char * kGpuStepShader =
+    "#version 120\n"
+    "uniform sampler2D board;\n"
+    "uniform vec2 texel;\n"
+    "uniform float rule[18];\n"
+    "void main()\n"
+    "{\n"
+    "    vec2 p = gl_TexCoord[0].xy;\n"
+    "    float count = texture2D(board, p + vec2(-texel.x, -texel.y)).r\n"
+    "                + texture2D(board, p + vec2(      0.0, -texel.y)).r\n"
+    "                + texture2D(board, p + vec2( texel.x, -texel.y)).r\n"
+    "                + texture2D(board, p + vec2(-texel.x,       0.0)).r\n"
+    "                + texture2D(board, p + vec2( texel.x,       0.0)).r\n"
+    "                + texture2D(board, p + vec2(-texel.x,  texel.y)).r\n"
+    "                + texture2D(board, p + vec2(      0.0,  texel.y)).r\n"
+    "                + texture2D(board, p + vec2( texel.x,  texel.y)).r;\n"
+    "    float alive = texture2D(board, p).r;\n"
+    "    gl_FragColor = vec4(rule[int(count + 9.0 * step(0.5, alive) + 0.5)]);\n"
+    "}\n";
+
+static const char * kGpuDrawShader =
+    "#version 120\n"
+    "uniform sampler2D board;\n"
+    "void main()\n"
+    "{\n"
+    "    float alive = texture2D(board, gl_TexCoord[0].xy).r;\n"
+    "    gl_FragColor = vec4(alive, alive, alive, 1.0);\n"
+    "}\n";
+
+/**
+ * Fetch a GL entry point. The game can't run --opengl without it.
+ * @param name
+ */
+static void * gpu_proc(const char * name)
+{
+    void * proc = SDL_GL_GetProcAddress(name);
+    
+    if ( ! proc)
+    {
+        fprintf(stderr, "OpenGL function %s is not available\n", name);
+        exit(EXIT_FAILURE);
+    }
+    return proc;
+}
+
+/**
+ * Compile one shader
+ * @param gpu
+ * @param type GL_VERTEX_SHADER or GL_FRAGMENT_SHADER
+ * @param source
+ */
+static GLuint gpu_shader(GpuLife * gpu, GLenum type, const char * source)
+{
+    GLint status = 0;
+    char log[1024];
+    GLuint shader = gpu->createShader(type);
+    
+    gpu->shaderSource(shader, 1, &source, NULL);
+    gpu->compileShader(shader);
+    gpu->getShaderiv(shader, GL_COMPILE_STATUS, &status);
+    if ( ! status)
+    {
+        gpu->getShaderInfoLog(shader, sizeof(log), NULL, log);
+        fprintf(stderr, "Can't compile a shader: %s\n", log);
+        exit(EXIT_FAILURE);
+    }
+    return shader;
+}
+
+/**
+ * Build a program from the shared vertex shader and a fragment shader
+ * @param gpu
+ * @param fragment Source of the fragment shader
+ */
+static GLuint gpu_program(GpuLife * gpu, const char * fragment)
+{
+    GLint status = 0;
+    char log[1024];
+    GLuint vs = gpu_shader(gpu, GL_VERTEX_SHADER, kGpuVertexShader);
+    GLuint fs = gpu_shader(gpu, GL_FRAGMENT_SHADER, fragment);
+    GLuint program = gpu->createProgram();
+    
+    gpu->attachShader(program, vs);
+    gpu->attachShader(program, fs);
+    gpu->linkProgram(program);
+    gpu->deleteShader(vs);
+    gpu->deleteShader(fs);
+    gpu->getProgramiv(program, GL_LINK_STATUS, &status);
+    if ( ! status)
+    {
+        gpu->getProgramInfoLog(program, sizeof(log), NULL, log);
+        fprintf(stderr, "Can't link a shader program: %s\n", log);
+        exit(EXIT_FAILURE);
+    }
+    gpu->useProgram(program);
+    gpu->uniform1i(gpu->getUniformLocation(program, "board"), 0);
+    gpu->useProgram(0);
+    return program;
+}
+
+/**
+ * Copy the current board of the game into the current texture
+ * @param game
+ */
+static void gpu_upload(GameContainer * game)
+{
+    const Board * board = game_board(game);
+    Uint32 x, y;
+    
+    glBindTexture(GL_TEXTURE_2D, game->gpu->textures[game->current]);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    if (board->format == BOARD_BYTES)
+    {
+        // One byte per cell already, only the padding is skipped.
+        // The cells hold 0 or 1, the shaders expect 0 or 255.
+        glPixelTransferf(GL_RED_SCALE, 255);
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, board->stride);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, board->width, board->height, GL_RED, GL_UNSIGNED_BYTE, board->cells);
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    }
+    else
+    {
+        Uint8 * row = (Uint8 *)malloc(board->width);
+        for (y = 0; y < board->height; y++)
+        {
+            const Uint64 * words = board_packed_row(board, y);
+            for (x = 0; x < board->width; x++)
+            {
+                row[x] = (words[x >> 6] >> (x & 63)) & 1 ? 0xFF : 0;
+            }
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, y, board->width, 1, GL_RED, GL_UNSIGNED_BYTE, row);
+        }
+        free(row);
+    }
+    glPixelTransferf(GL_RED_SCALE, 1);
+}
+
+/**
+ * Create the textures, framebuffers and shaders of the game board
+ * @param game
+ * @return The GPU state
+ */
+static GpuLife * gpu_create(GameContainer * game)
+{
+    GpuLife * gpu = (GpuLife *)calloc(1, sizeof(GpuLife));
+    // The texture border plays the halo: living cells, or the other side with GL_REPEAT for a torus
+    const GLfloat alive = game->topology == TOPOLOGY_ALIVE;
+    const GLfloat border[4] = { alive, alive, alive, alive };
+    const GLint wrap = game->topology == TOPOLOGY_TORUS ? GL_REPEAT : GL_CLAMP_TO_BORDER;
+    GLint maxSize = 0;
+    GLfloat rule[18];
+    int i;
+    
+    gpu->createShader = (PFNGLCREATESHADERPROC)gpu_proc("glCreateShader");
+    gpu->shaderSource = (PFNGLSHADERSOURCEPROC)gpu_proc("glShaderSource");
+    gpu->compileShader = (PFNGLCOMPILESHADERPROC)gpu_proc("glCompileShader");
+    gpu->getShaderiv = (PFNGLGETSHADERIVPROC)gpu_proc("glGetShaderiv");
+    gpu->getShaderInfoLog = (PFNGLGETSHADERINFOLOGPROC)gpu_proc("glGetShaderInfoLog");
+    gpu->deleteShader = (PFNGLDELETESHADERPROC)gpu_proc("glDeleteShader");
+    gpu->createProgram = (PFNGLCREATEPROGRAMPROC)gpu_proc("glCreateProgram");
+    gpu->attachShader = (PFNGLATTACHSHADERPROC)gpu_proc("glAttachShader");
+    gpu->linkProgram = (PFNGLLINKPROGRAMPROC)gpu_proc("glLinkProgram");
+    gpu->getProgramiv = (PFNGLGETPROGRAMIVPROC)gpu_proc("glGetProgramiv");
+    gpu->getProgramInfoLog = (PFNGLGETPROGRAMINFOLOGPROC)gpu_proc("glGetProgramInfoLog");
+    gpu->deleteProgram = (PFNGLDELETEPROGRAMPROC)gpu_proc("glDeleteProgram");
+    gpu->useProgram = (PFNGLUSEPROGRAMPROC)gpu_proc("glUseProgram");
+    gpu->getUniformLocation = (PFNGLGETUNIFORMLOCATIONPROC)gpu_proc("glGetUniformLocation");
+    gpu->uniform1i = (PFNGLUNIFORM1IPROC)gpu_proc("glUniform1i");
+    gpu->uniform2f = (PFNGLUNIFORM2FPROC)gpu_proc("glUniform2f");
+    gpu->uniform1fv = (PFNGLUNIFORM1FVPROC)gpu_proc("glUniform1fv");
+    gpu->genFramebuffers = (PFNGLGENFRAMEBUFFERSPROC)gpu_proc("glGenFramebuffers");
+    gpu->bindFramebuffer = (PFNGLBINDFRAMEBUFFERPROC)gpu_proc("glBindFramebuffer");
+    gpu->framebufferTexture2D = (PFNGLFRAMEBUFFERTEXTURE2DPROC)gpu_proc("glFramebufferTexture2D");
+    gpu->checkFramebufferStatus = (PFNGLCHECKFRAMEBUFFERSTATUSPROC)gpu_proc("glCheckFramebufferStatus");
+    gpu->deleteFramebuffers = (PFNGLDELETEFRAMEBUFFERSPROC)gpu_proc("glDeleteFramebuffers");
+    
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxSize);
+    if (game->width > (Uint32)maxSize || game->height > (Uint32)maxSize)
+    {
+        fprintf(stderr, "The GPU can't hold a %ux%u board (textures up to %d)\n", game->width, game->height, maxSize);
+        exit(EXIT_FAILURE);
+    }
+    
+    glGenTextures(2, gpu->textures);
+    gpu->genFramebuffers(2, gpu->framebuffers);
+    for (i = 0; i < 2; i++)
+    {
+        glBindTexture(GL_TEXTURE_2D, gpu->textures[i]);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, game->width, game->height, 0, GL_RED, GL_UNSIGNED_BYTE, NULL);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrap);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrap);
+        glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, border);
+        
+        gpu->bindFramebuffer(GL_FRAMEBUFFER, gpu->framebuffers[i]);
+        gpu->framebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, gpu->textures[i], 0);
+        if (gpu->checkFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        {
+            fprintf(stderr, "The GPU can't render into a board texture\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    gpu->bindFramebuffer(GL_FRAMEBUFFER, 0);
+    
+    glGenTextures(1, &gpu->overlay);
+    glBindTexture(GL_TEXTURE_2D, gpu->overlay);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, game->screen->w, game->screen->h, 0, GL_BGRA, GL_UNSIGNED_BYTE, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    
+    gpu->stepProgram = gpu_program(gpu, kGpuStepShader);
+    gpu->drawProgram = gpu_program(gpu, kGpuDrawShader);
+    gpu->stepTexel = gpu->getUniformLocation(gpu->stepProgram, "texel");
+    for (i = 0; i <= 8; i++)
+    {
+        rule[i] = (float)((gRule.birth >> i) & 1);
+        rule[i + 9] = (float)((gRule.survival >> i) & 1);
+    }
+    gpu->useProgram(gpu->stepProgram);
+    gpu->uniform1fv(gpu->getUniformLocation(gpu->stepProgram, "rule"), 18, rule);
+    gpu->useProgram(0);
+    gpu->zoom = (float)game->tileSize / game->cellsPerPixel;
+    
+    game->gpu = gpu;
+    gpu_upload(game);
+    return gpu;
+}
+
+/**
+ * Release the textures, framebuffers and shaders
+ * @param gpu
+ */
+static void gpu_dispose(GpuLife * gpu)
+{
+    gpu->deleteFramebuffers(2, gpu->framebuffers);
+    glDeleteTextures(2, gpu->textures);
+    glDeleteTextures(1, &gpu->overlay);
+    gpu->deleteProgram(gpu->stepProgram);
+    gpu->deleteProgram(gpu->drawProgram);
+    free(gpu);
+}
+
+/**
+ * Draw a textured rectangle
+ * @param x0, y0, x1, y1 Corners in the current projection
+ * @param u0, v0, u1, v1 Matching texture coordinates
+ */
+static void gpu_quad(float x0, float y0, float x1, float y1, float u0, float v0, float u1, float v1)
+{
+    glBegin(GL_QUADS);
+        glTexCoord2f(u0, v0);   glVertex2f(x0, y0);
+        glTexCoord2f(u1, v0);   glVertex2f(x1, y0);
+        glTexCoord2f(u1, v1);   glVertex2f(x1, y1);
+        glTexCoord2f(u0, v1);   glVertex2f(x0, y1);
+    glEnd();
+}
+
+/**
+ * Make a cell alive in the current texture
+ * @param game
+ * @param x, y Cell coordinates
+ */
+static void gpu_set_cell(GameContainer * game, Uint32 x, Uint32 y)
+{
+    const Uint8 alive = 0xFF;
+    
+    glBindTexture(GL_TEXTURE_2D, game->gpu->textures[game->current]);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, 1, 1, GL_RED, GL_UNSIGNED_BYTE, &alive);
+}
+
+/**
+ * Compute one generation on the GPU: the current texture is drawn through
+ * the step shader into the framebuffer of the other one. The CPU boards
+ * are left untouched.
+ * @param game
+ * @return 1 generation
+ */
+static Uint32 board_compute_gpu(GameContainer * game)
+{
+    GpuLife * gpu = game->gpu;
+    
+    gpu->bindFramebuffer(GL_FRAMEBUFFER, gpu->framebuffers[game->next]);
+    glViewport(0, 0, game->width, game->height);
+    glMatrixMode(GL_PROJECTION);
+    glLoadIdentity();
+    glOrtho(0, 1, 0, 1, -1, 1);
+    glMatrixMode(GL_MODELVIEW);
+    glLoadIdentity();
+    glDisable(GL_BLEND);
+    glEnable(GL_TEXTURE_2D);
+    
+    gpu->useProgram(gpu->stepProgram);
+    gpu->uniform2f(gpu->stepTexel, 1.0f / game->width, 1.0f / game->height);
+    glBindTexture(GL_TEXTURE_2D, gpu->textures[game->current]);
+    gpu_quad(0, 0, 1, 1, 0, 0, 1, 1);
+    gpu->useProgram(0);
+    
+    gpu->bindFramebuffer(GL_FRAMEBUFFER, 0);
+    return 1;
+}
+
+/**
+ * Set the projection of the window: one unit per pixel, y going down
+ */
+static void gpu_window_projection(void)
+{
+    const SDL_Surface * window = SDL_GetVideoSurface();
+    
+    glViewport(0, 0, window->w, window->h);
+    glMatrixMode(GL_PROJECTION);
+    glLoadIdentity();
+    glOrtho(0, window->w, window->h, 0, -1, 1);
+    glMatrixMode(GL_MODELVIEW);
+    glLoadIdentity();
+}
+
+/**
+ * Draw the current texture in the window, zoomed around the view
+ * @param game
+ */
+static void draw_board_gpu(GameContainer * game)
+{
+    GpuLife * gpu = game->gpu;
+    const SDL_Surface * window = SDL_GetVideoSurface();
+    const float cols = window->w / gpu->zoom;
+    const float rows = window->h / gpu->zoom;
+    
+    gpu_window_projection();
+    glDisable(GL_BLEND);
+    glEnable(GL_TEXTURE_2D);
+    gpu->useProgram(gpu->drawProgram);
+    glBindTexture(GL_TEXTURE_2D, gpu->textures[game->current]);
+    gpu_quad(0, 0, window->w, window->h,
+             gpu->viewX / game->width, gpu->viewY / game->height,
+             (gpu->viewX + cols) / game->width, (gpu->viewY + rows) / game->height);
+    gpu->useProgram(0);
+}
+
+/**
+ * Upload the overlay (buttons and timings), draw it over the board and show
+ * the frame. Black pixels of the overlay are transparent.
+ * @param game
+ */
+static void gpu_present(GameContainer * game)
+{
+    SDL_Surface * overlay = game->screen;
+    int x, y;
+    
+    for (y = 0; y < overlay->h; y++)
+    {
+        Uint32 * pixel = (Uint32 *)((Uint8 *)overlay->pixels + y * overlay->pitch);
+        for (x = 0; x < overlay->w; x++)
+        {
+            pixel[x] = pixel[x] & 0x00FFFFFF ? pixel[x] | 0xFF000000 : 0;
+        }
+    }
+    
+    gpu_window_projection();
+    glEnable(GL_TEXTURE_2D);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glBindTexture(GL_TEXTURE_2D, game->gpu->overlay);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, overlay->pitch / 4);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, overlay->w, overlay->h, GL_BGRA, GL_UNSIGNED_BYTE, overlay->pixels);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    gpu_quad(0, 0, overlay->w, overlay->h, 0, 0, 1, 1);
+    glDisable(GL_BLEND);
+    
+    SDL_GL_SwapBuffers();
+}
+
+/**
+ * Zoom with the mouse wheel (around the pointer) and move the view with the
+ * arrow keys
+ * @param game
+ * @param evt
+ * @return Yes if the event was used
+ */
+static int gpu_handle_event(GameContainer * game, const SDL_Event * evt)
+{
+    GpuLife * gpu = game->gpu;
+    const SDL_Surface * window = SDL_GetVideoSurface();
+    
+    if (evt->type == SDL_MOUSEBUTTONDOWN &&
+        (evt->button.button == SDL_BUTTON_WHEELUP || evt->button.button == SDL_BUTTON_WHEELDOWN))
+    {
+        // Keep the cell under the pointer in place
+        const float cellX = gpu->viewX + evt->button.x / gpu->zoom;
+        const float cellY = gpu->viewY + evt->button.y / gpu->zoom;
+        
+        gpu->zoom *= evt->button.button == SDL_BUTTON_WHEELUP ? 1.25f : 0.8f;
+        gpu->zoom = gpu->zoom < kMinZoom ? kMinZoom : gpu->zoom > kMaxZoom ? kMaxZoom : gpu->zoom;
+        gpu->viewX = cellX - evt->button.x / gpu->zoom;
+        gpu->viewY = cellY - evt->button.y / gpu->zoom;
+        return Yes;
+    }
+    if (evt->type == SDL_KEYDOWN)
+    {
+        const float stepX = window->w / gpu->zoom / 8;
+        const float stepY = window->h / gpu->zoom / 8;
+        
+        switch (evt->key.keysym.sym)
+        {
+            case SDLK_LEFT:     gpu->viewX -= stepX; return Yes;
+            case SDLK_RIGHT:    gpu->viewX += stepX; return Yes;
+            case SDLK_UP:       gpu->viewY -= stepY; return Yes;
+            case SDLK_DOWN:     gpu->viewY += stepY; return Yes;
+            default:            break;
+        }
+    }
+    return No;
+}
+
+/**
+ * Render the glyphs and labels of the overlay
+ * @param font
+ * @return The overlay
+ */
+static Overlay * overlay_create(TTF_Font * font)
+{
+    static const char * kLabels[OVERLAY_LINES][2] = {
+        { "", " fps" },
+        { "Compute: ", " microsec" },
+        { "Draw: ", " microsec" }
+    };
+    Overlay * overlay = (Overlay *)calloc(1, sizeof(Overlay));
+    char glyph[2] = { 0, 0 };
+    Uint16 digitWidth = 0, height = 0;
+    int i;
+    
+    for (i = 0; i < 11; i++)
+    {
+        glyph[0] = i < 10 ? '0' + i : '-';
+        overlay->digits[i] = TTF_RenderText_Blended(font, glyph, kWhite);
+        digitWidth = overlay->digits[i]->w > digitWidth ? overlay->digits[i]->w : digitWidth;
+        height = overlay->digits[i]->h > height ? overlay->digits[i]->h : height;
+    }
+    for (i = 0; i < OVERLAY_LINES; i++)
+    {
+        OverlayText * text = &overlay->lines[i];
+        // TTF can't render an empty string
+        text->label = kLabels[i][0][0] ? TTF_RenderText_Blended(font, kLabels[i][0], kWhite) : NULL;
+        text->unit = TTF_RenderText_Blended(font, kLabels[i][1], kWhite);
+        // Room for the 20 digits of a Sint64 and its sign
+        text->surf = SDL_CreateRGBSurface(SDL_SWSURFACE, (text->label ? text->label->w : 0) + 21 * digitWidth + text->unit->w,
+                                          height, 32, 0x00FF0000, 0x0000FF00, 0x000000FF, 0);
+        SDL_SetColorKey(text->surf, SDL_SRCCOLORKEY, 0);
+    }
+    return overlay;
+}
+
+/**
+ * Release the overlay surfaces
+ * @param overlay
+ */
+static void overlay_dispose(Overlay * overlay)
+{
+    int i;
+    
+    for (i = 0; i < 11; i++)
+    {
+        SDL_FreeSurface(overlay->digits[i]);
+    }
+    for (i = 0; i < OVERLAY_LINES; i++)
+    {
+        if (overlay->lines[i].label)
+        {
+            SDL_FreeSurface(overlay->lines[i].label);
+        }
+        SDL_FreeSurface(overlay->lines[i].unit);
+        SDL_FreeSurface(overlay->lines[i].surf);
+    }
+    free(overlay);
+}
+
+/**
+ * Draw a line of the overlay at the right of the screen. The line is
+ * composed again only when its number changed.
+ * @param screen
+ * @param overlay
+ * @param line
+ * @param value The number to show
+ * @param posY
+ */
+static void overlay_draw(SDL_Surface * screen, Overlay * overlay, OverlayLine line, Sint64 value, const int posY)
+{
+    OverlayText * text = &overlay->lines[line];
+    SDL_Rect pos = { 0, posY, 0, 0 };
+    
+    if ( ! text->valid || text->value != value)
+    {
+        char str[24];
+        const char * c;
+        SDL_Rect at = { 0, 0, 0, 0 };
+        
+        sprintf(str, "%lld", (long long)value);
+        SDL_FillRect(text->surf, NULL, 0);
+        if (text->label)
+        {
+            SDL_BlitSurface(text->label, NULL, text->surf, &at);
+            at.x += text->label->w;
+        }
+        for (c = str; *c; c++)
+        {
+            SDL_Surface * glyph = overlay->digits[*c == '-' ? 10 : *c - '0'];
+            SDL_BlitSurface(glyph, NULL, text->surf, &at);
+            at.x += glyph->w;
+        }
+        SDL_BlitSurface(text->unit, NULL, text->surf, &at);
+        text->width = at.x + text->unit->w;
+        text->value = value;
+        text->valid = Yes;
+    }
+    
+    {
+        SDL_Rect area = { 0, 0, text->width, text->surf->h };
+        pos.x = screen->w - text->width - 10;
+        SDL_BlitSurface(text->surf, &area, screen, &pos);
+    }
+}
+
+/**
+ * Draw the FPS on the screen, from the cached glyphs
+ * @param screen
+ * @param overlay
+ * @param fps
+ */
+static void draw_fps(SDL_Surface * screen, Overlay * overlay, Uint32 fps)
+{
+    overlay_draw(screen, overlay, OVERLAY_FPS, fps, 10);
+}
+
+/**
+ * Draw a timing on the screen, from the cached glyphs
+ * @param screen
+ * @param overlay
+ * @param line OVERLAY_COMPUTE or OVERLAY_DRAW
+ * @param time In microseconds
+ * @param posY
+ */
+static void draw_time(SDL_Surface * screen, Overlay * overlay, OverlayLine line, const Sint64 time, const int posY)
+{
+    overlay_draw(screen, overlay, line, time, posY);
+}
+
+const Uint32 kProfileFrames = 1024;     // Frames kept by the ring buffer, the percentiles are computed over them
+
+/**
+ * Timings of one frame, in nanoseconds from the start of the profiler
+ */
+typedef struct ProfileFrame
+{
+    Uint64 start;
+    Uint64 begin[PROFILE_SCOPES];
+    Uint64 duration[PROFILE_SCOPES];
+    Uint64 allocations;                 // Heap allocations during the frame
+} ProfileFrame;
+
+/**
+ * Frame profiler: each frame is cut in named scopes timed with the monotonic
+ * clock, the last kProfileFrames frames are kept in a ring buffer.
+ */
+struct Profiler
+{
+    ProfileFrame * frames;              // The ring buffer
+    Uint64 count;                       // Frames started since the beginning
+    Uint64 origin;                      // Clock at the creation
+    Uint64 * scratch;                   // Room for the percentiles, no allocation per frame
+    Uint64 allocations;                 // Heap allocations at the start of the current frame
+};
+
+/**
+ * Create a profiler, its first frame is started
+ */
+static Profiler * profiler_create(void)
+{
+    Profiler * prof = (Profiler *)calloc(1, sizeof(Profiler));
+    
+    prof->frames = (ProfileFrame *)calloc(kProfileFrames, sizeof(ProfileFrame));
+    prof->scratch = (Uint64 *)malloc(kProfileFrames * sizeof(Uint64));
+    if ( ! prof->frames || ! prof->scratch)
+    {
+        fprintf(stderr, "Not enough memory for the profiler\n");
+        exit(EXIT_FAILURE);
+    }
+    prof->origin = profile_now();
+    prof->allocations = heap_allocations();
+    return prof;
+}
+
+/**
+ * Get the frame being recorded
+ * @param prof
+ */
+static inline ProfileFrame * profile_frame(Profiler * prof)
+{
+    return &prof->frames[prof->count % kProfileFrames];
+}
+
+/**
+ * Start a new frame
+ * @param prof
+ */
+static void profile_next_frame(Profiler * prof)
+{
+    ProfileFrame * frame;
+    const Uint64 allocations = heap_allocations();
+    
+    profile_frame(prof)->allocations = allocations - prof->allocations;
+    prof->allocations = allocations;
+    prof->count++;
+    frame = profile_frame(prof);
+    memset(frame, 0, sizeof(ProfileFrame));
+    frame->start = profile_now() - prof->origin;
+}
+
+/**
+ * Enter a scope of the current frame
+ * @param prof
+ * @param scope
+ */
+static inline void profile_begin(Profiler * prof, ProfileScope scope)
+{
+    profile_frame(prof)->begin[scope] = profile_now() - prof->origin;
+}
+
+/**
+ * Leave a scope of the current frame
+ * @param prof
+ * @param scope
+ */
+static inline void profile_end(Profiler * prof, ProfileScope scope)
+{
+    ProfileFrame * frame = profile_frame(prof);
+    frame->duration[scope] = profile_now() - prof->origin - frame->begin[scope];
+}
+
+/**
+ * Number of complete frames in the ring buffer (the current one is not)
+ * @param prof
+ */
+static Uint32 profile_frames(const Profiler * prof)
+{
+    return prof->count < kProfileFrames ? (Uint32)prof->count : kProfileFrames - 1;
+}
+
+/**
+ * Percentile of a scope over the frames of the ring buffer
+ * @param prof
+ * @param scope
+ * @param percent 50 for the median, 99...
+ * @return Nanoseconds
+ */
+static Uint64 profile_percentile(Profiler * prof, ProfileScope scope, Uint32 percent)
+{
+    const Uint32 count = profile_frames(prof);
+    Uint32 i;
+    int left = 0, right = (int)count - 1, k;
+    Uint64 * v = prof->scratch;
+    
+    if ( ! count)
+    {
+        return 0;
+    }
+    for (i = 0; i < count; i++)
+    {
+        v[i] = prof->frames[(prof->count - 1 - i) % kProfileFrames].duration[scope];
+    }
+    
+    // Quickselect: no need to sort everything
+    k = (int)((Uint64)(count - 1) * percent / 100);
+    while (left < right)
+    {
+        const Uint64 pivot = v[(left + right) / 2];
+        int a = left, b = right;
+        while (a <= b)
+        {
+            while (v[a] < pivot) a++;
+            while (v[b] > pivot) b--;
+            if (a <= b)
+            {
+                const Uint64 t = v[a];
+                v[a++] = v[b];
+                v[b--] = t;
+            }
+        }
+        if (k <= b)
+        {
+            right = b;
+        }
+        else if (k >= a)
+        {
+            left = a;
+        }
+        else
+        {
+            break;
+        }
+    }
+    return v[k];
+}
+
+/**
+ * Frames per second over the ring buffer
+ * @param prof
+ */
+static Uint32 profile_fps(const Profiler * prof)
+{
+    const Uint32 count = profile_frames(prof);
+    Uint64 elapsed;
+    
+    if ( ! count)
+    {
+        return 0;
+    }
+    elapsed = profile_frame((Profiler *)prof)->start - prof->frames[(prof->count - count) % kProfileFrames].start;
+    return elapsed ? (Uint32)(count * 1000000000ULL / elapsed) : 0;
+}
+
+/**
+ * Print the median and 99th percentile of each scope
+ * @param prof
+ */
+static void profile_print(Profiler * prof)
+{
+    const Uint32 count = profile_frames(prof);
+    int scope;
+    
+    printf("Profile of the last %u frames (microseconds):\n", count);
+    for (scope = 0; scope < PROFILE_SCOPES; scope++)
+    {
+        printf("  %-8s p50 %8.1f  p99 %8.1f\n", kProfileScopeNames[scope],
+               profile_percentile(prof, scope, 50) / 1e3, profile_percentile(prof, scope, 99) / 1e3);
+    }
+#ifdef COUNT_ALLOCATIONS
+    {
+        Uint64 allocations = 0;
+        Uint32 i, allocating = 0;
+        
+        for (i = 0; i < count; i++)
+        {
+            const Uint64 n = prof->frames[(prof->count - 1 - i) % kProfileFrames].allocations;
+            allocations += n;
+            allocating += n > 0;
+        }
+        printf("  heap allocations %llu, in %u frames\n", (unsigned long long)allocations, allocating);
+    }
+#else
+    (void)count;
+#endif
+}
+
+/**
+ * Dump the frames of the ring buffer, one line per frame
+ * @param prof
+ * @param path
+ */
+static void profile_write_csv(const Profiler * prof, const char * path)
+{
+    const Uint32 count = profile_frames(prof);
+    FILE * file = fopen(path, "w");
+    Uint32 i;
+    int scope;
+    
+    if ( ! file)
+    {
+        fprintf(stderr, "Can't write the profile to %s\n", path);
+        return;
+    }
+    fprintf(file, "frame,start_us");
+    for (scope = 0; scope < PROFILE_SCOPES; scope++)
+    {
+        fprintf(file, ",%s_us", kProfileScopeNames[scope]);
+    }
+    fprintf(file, ",allocations\n");
+    for (i = 0; i < count; i++)
+    {
+        const Uint64 n = prof->count - count + i;
+        const ProfileFrame * frame = &prof->frames[n % kProfileFrames];
+        fprintf(file, "%llu,%.3f", (unsigned long long)n, frame->start / 1e3);
+        for (scope = 0; scope < PROFILE_SCOPES; scope++)
+        {
+            fprintf(file, ",%.3f", frame->duration[scope] / 1e3);
+        }
+        fprintf(file, ",%llu\n", (unsigned long long)frame->allocations);
+    }
+    fclose(file);
+}
+
+/**
+ * Dump the frames of the ring buffer in the Chrome trace format (open it
+ * in chrome://tracing or Perfetto): one complete event per scope
+ * @param prof
+ * @param path
+ */
+static void profile_write_trace(const Profiler * prof, const char * path)
+{
+    const Uint32 count = profile_frames(prof);
+    FILE * file = fopen(path, "w");
+    const char * separator = "";
+    Uint32 i;
+    int scope;
+    
+    if ( ! file)
+    {
+        fprintf(stderr, "Can't write the trace to %s\n", path);
+        return;
+    }
+    fprintf(file, "{\"traceEvents\":[\n");
+    for (i = 0; i < count; i++)
+    {
+        const ProfileFrame * frame = &prof->frames[(prof->count - count + i) % kProfileFrames];
+        for (scope = 0; scope < PROFILE_SCOPES; scope++)
+        {
+            fprintf(file, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f}",
+                    separator, kProfileScopeNames[scope], frame->begin[scope] / 1e3, frame->duration[scope] / 1e3);
+            separator = ",\n";
+        }
+    }
+    fprintf(file, "\n],\"displayTimeUnit\":\"ms\"}\n");
+    fclose(file);
+}
+
+/**
+ * Release the profiler
+ * @param prof
+ */
+static void profiler_dispose(Profiler * prof)
+{
+    free(prof->frames);
+    free(prof->scratch);
+    free(prof);
+}
+
+/**
+ * Add the phases of a frame of the main loop to the metrics. The compute
+ * phase is left to metrics_step, which sees every generation.
+ * @param metrics
+ * @param frame The frame just ended
+ */
+static void metrics_frame(Metrics * metrics, const ProfileFrame * frame)
+{
+    const Uint64 now = profile_now();
+    int scope;
+
+    for (scope = 0; scope < PROFILE_SCOPES; scope++)
+    {
+        if (scope != PROFILE_COMPUTE)
+        {
+            metrics_observe(&metrics->frame[scope], frame->duration[scope]);
+        }
+    }
+    if (now - metrics->framePublished >= kMetricsPublish)
+    {
+        pthread_mutex_lock(&metrics->lock);
+        for (scope = 0; scope < PROFILE_SCOPES; scope++)
+        {
+            if (scope != PROFILE_COMPUTE)
+            {
+                metrics->phases[scope] = metrics->frame[scope];
+            }
+        }
+        pthread_mutex_unlock(&metrics->lock);
+        metrics->framePublished = now;
+    }
+}
+
+/**
+ * Append to the response, nothing once it is full
+ * @param out The response
+ * @param size Its room
+ * @param length Its length, moved past what is appended
+ * @param format As for printf
+ */
+static void metrics_append(char * out, size_t size, size_t * length, const char * format, ...)
+{
+    va_list args;
+    int written;
+
+    va_start(args, format);
+    written = vsnprintf(out + *length, size - *length, format, args);
+    va_end(args);
+    if (written > 0)
+    {
+        *length = *length + written < size ? *length + written : size - 1;
+    }
+}
+
+/**
+ * Write the published metrics in the Prometheus text format
+ * @param metrics
+ * @param out
+ * @param size Room of out
+ * @return The length written
+ */
+static size_t metrics_render(Metrics * metrics, char * out, size_t size)
+{
+    const Uint32 bounds = sizeof(kMetricsBounds) / sizeof(kMetricsBounds[0]);
+    const MetricsValues * shown = &metrics->shown;
+    size_t length = 0;
+    Uint64 resident = 0;
+    Uint32 i, b;
+    int scope, statm;
+    char line[128];
+
+    // No stdio: it would allocate
+    statm = open("/proc/self/statm", O_RDONLY);
+    if (statm >= 0)
+    {
+        const ssize_t got = read(statm, line, sizeof(line) - 1);
+        unsigned long long pages;
+        line[got > 0 ? got : 0] = '\0';
+        if (sscanf(line, "%*s %llu", &pages) == 1)
+        {
+            resident = pages * (Uint64)sysconf(_SC_PAGESIZE);
+        }
+        close(statm);
+    }
+
+    pthread_mutex_lock(&metrics->lock);
+    metrics_append(out, size, &length, "# HELP gamelive_generations_total Generations computed since the start.\n"
+                                       "# TYPE gamelive_generations_total counter\n"
+                                       "gamelive_generations_total %llu\n", (unsigned long long)shown->generations);
+    metrics_append(out, size, &length, "# HELP gamelive_generations_per_second Generations per second over the last period.\n"
+                                       "# TYPE gamelive_generations_per_second gauge\n"
+                                       "gamelive_generations_per_second %.6g\n", shown->rate);
+    if (shown->population >= 0)
+    {
+        metrics_append(out, size, &length, "# HELP gamelive_population Living cells.\n"
+                                           "# TYPE gamelive_population gauge\n"
+                                           "gamelive_population %lld\n", (long long)shown->population);
+    }
+    if (shown->activeTiles >= 0)
+    {
+        metrics_append(out, size, &length, "# HELP gamelive_active_tiles 64x64 tiles computed by the last generation.\n"
+                                           "# TYPE gamelive_active_tiles gauge\n"
+                                           "gamelive_active_tiles %lld\n"
+                                           "# HELP gamelive_tiles 64x64 tiles of the board.\n"
+                                           "# TYPE gamelive_tiles gauge\n"
+                                           "gamelive_tiles %llu\n", (long long)shown->activeTiles, (unsigned long long)shown->tiles);
+    }
+    metrics_append(out, size, &length, "# HELP gamelive_arena_bytes Simulation storage, reserved and handed out.\n"
+                                       "# TYPE gamelive_arena_bytes gauge\n"
+                                       "gamelive_arena_bytes{state=\"reserved\"} %llu\n"
+                                       "gamelive_arena_bytes{state=\"used\"} %llu\n",
+                   (unsigned long long)shown->arenaSize, (unsigned long long)shown->arenaUsed);
+    if (resident)
+    {
+        metrics_append(out, size, &length, "# HELP gamelive_resident_bytes Resident memory of the process.\n"
+                                           "# TYPE gamelive_resident_bytes gauge\n"
+                                           "gamelive_resident_bytes %llu\n", (unsigned long long)resident);
+    }
+#ifdef COUNT_ALLOCATIONS
+    metrics_append(out, size, &length, "# HELP gamelive_heap_allocations_total Heap allocations of the process.\n"
+                                       "# TYPE gamelive_heap_allocations_total counter\n"
+                                       "gamelive_heap_allocations_total %llu\n", (unsigned long long)heap_allocations());
+#endif
+
+    metrics_append(out, size, &length, "# HELP gamelive_phase_seconds Latency of the phases of a frame, compute is per generation.\n"
+                                       "# TYPE gamelive_phase_seconds histogram\n");
+    for (scope = 0; scope < PROFILE_SCOPES; scope++)
+    {
+        const MetricsHistogram * histogram = &metrics->phases[scope];
+        Uint64 count = 0;
+        for (b = 0; b <= bounds; b++)
+        {
+            count += histogram->buckets[b];
+            if (b < bounds)
+            {
+                metrics_append(out, size, &length, "gamelive_phase_seconds_bucket{phase=\"%s\",le=\"%g\"} %llu\n",
+                               kProfileScopeNames[scope], kMetricsBounds[b], (unsigned long long)count);
+            }
+            else
+            {
+                metrics_append(out, size, &length, "gamelive_phase_seconds_bucket{phase=\"%s\",le=\"+Inf\"} %llu\n",
+                               kProfileScopeNames[scope], (unsigned long long)count);
+            }
+        }
+        metrics_append(out, size, &length, "gamelive_phase_seconds_sum{phase=\"%s\"} %.9f\n"
+                                           "gamelive_phase_seconds_count{phase=\"%s\"} %llu\n",
+                       kProfileScopeNames[scope], histogram->sum * 1e-9, kProfileScopeNames[scope], (unsigned long long)histogram->count);
+    }
+
+    metrics_append(out, size, &length, "# HELP gamelive_thread_busy_seconds_total Time each thread spent computing.\n"
+                                       "# TYPE gamelive_thread_busy_seconds_total counter\n");
+    for (i = 0; i < metrics->threads; i++)
+    {
+        metrics_append(out, size, &length, "gamelive_thread_busy_seconds_total{thread=\"%u\"} %.9f\n", i, metrics->shownBusy[i] * 1e-9);
+    }
+    metrics_append(out, size, &length, "# HELP gamelive_thread_cells_total Cells computed by each thread.\n"
+                                       "# TYPE gamelive_thread_cells_total counter\n");
+    for (i = 0; i < metrics->threads; i++)
+    {
+        metrics_append(out, size, &length, "gamelive_thread_cells_total{thread=\"%u\"} %llu\n", i, (unsigned long long)metrics->shownCells[i]);
+    }
+    metrics_append(out, size, &length, "# HELP gamelive_thread_utilization Part of the last period each thread spent computing.\n"
+                                       "# TYPE gamelive_thread_utilization gauge\n");
+    for (i = 0; i < metrics->threads; i++)
+    {
+        metrics_append(out, size, &length, "gamelive_thread_utilization{thread=\"%u\"} %.4f\n", i, metrics->utilization[i]);
+    }
+    pthread_mutex_unlock(&metrics->lock);
+    return length;
+}
+
+/**
+ * Send a whole buffer, or give up on the client
+ * @param client
+ * @param data
+ * @param length
+ */
+static void metrics_send(int client, const char * data, size_t length)
+{
+    while (length)
+    {
+        const ssize_t sent = send(client, data, length, MSG_NOSIGNAL);
+        if (sent <= 0)
+        {
+            return;
+        }
+        data += sent;
+        length -= sent;
+    }
+}
+
+/**
+ * Server thread: one client at a time, GET /metrics is the only page
+ * @param data The Metrics
+ */
+static void * metrics_serve(void * data)
+{
+    Metrics * metrics = (Metrics *)data;
+    const struct timeval timeout = { 1, 0 };
+    char request[1024], header[160];
+
+    while ( ! __atomic_load_n(&metrics->quit, __ATOMIC_ACQUIRE))
+    {
+        struct pollfd listener = { metrics->listener, POLLIN, 0 };
+        size_t length = 0;
+        ssize_t got;
+        int client;
+
+        // Wake up now and then to see if the run is over
+        if (poll(&listener, 1, 250) <= 0 || (client = accept(metrics->listener, NULL, NULL)) < 0)
+        {
+            continue;
+        }
+        setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+        request[0] = '\0';
+        while (length < sizeof(request) - 1 && ! strstr(request, "\r\n\r\n") &&
+               (got = recv(client, request + length, sizeof(request) - 1 - length, 0)) > 0)
+        {
+            length += got;
+            request[length] = '\0';
+        }
+
+        if ( ! strncmp(request, "GET /metrics", 12) && (request[12] == ' ' || request[12] == '?'))
+        {
+            const size_t body = metrics_render(metrics, metrics->response, metrics->responseSize);
+            const int size = snprintf(header, sizeof(header), "HTTP/1.1 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\n"
+                                                              "Content-Length: %lu\r\nConnection: close\r\n\r\n", (unsigned long)body);
+            metrics_send(client, header, size);
+            metrics_send(client, metrics->response, body);
+        }
+        else
+        {
+            const char * missing = "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+            metrics_send(client, missing, strlen(missing));
+        }
+        close(client);
+    }
+    return NULL;
+}
+
+/**
+ * Start serving the metrics of a game, and give the kernels their counters
+ * @param game
+ * @param address [HOST:]PORT, the host is 127.0.0.1 by default
+ * @return The metrics, the process exits if they can't be served
+ */
+static Metrics * metrics_create(GameContainer * game, const char * address)
+{
+    Metrics * metrics = (Metrics *)calloc(1, sizeof(Metrics));
+    const char * colon = strrchr(address, ':');
+    const char * port = colon ? colon + 1 : address;
+    struct sockaddr_in where;
+    char host[16] = "127.0.0.1";
+    char * end = NULL;
+    const unsigned long number = strtoul(port, &end, 10);
+    const int yes = 1;
+    Uint32 threads = (Uint32)omp_get_max_threads();
+
+    memset(&where, 0, sizeof(where));
+    where.sin_family = AF_INET;
+    where.sin_port = htons((Uint16)number);
+    if (colon && (size_t)(colon - address) < sizeof(host))
+    {
+        memcpy(host, address, colon - address);
+        host[colon - address] = '\0';
+    }
+    if ( ! metrics || end == port || *end != '\0' || ! number || number > 65535 || inet_pton(AF_INET, host, &where.sin_addr) != 1)
+    {
+        fprintf(stderr, "Invalid metrics address: %s ([HOST:]PORT, HOST being an IPv4 address)\n", address);
+        exit(EXIT_FAILURE);
+    }
+    metrics->listener = socket(AF_INET, SOCK_STREAM, 0);
+    setsockopt(metrics->listener, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+    if (metrics->listener < 0 || bind(metrics->listener, (struct sockaddr *)&where, sizeof(where)) || listen(metrics->listener, 8))
+    {
+        fprintf(stderr, "Can't serve the metrics on %s: %s\n", address, strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+    snprintf(metrics->address, sizeof(metrics->address), "%s:%lu", host, number);
+
+    // A counter for every thread which may compute: OpenMP or the pool of --thread
+    if (game->pool && game->pool->count > threads)
+    {
+        threads = game->pool->count;
+    }
+    metrics->threads = threads;
+    metrics->busy = (Uint64 *)calloc(threads, sizeof(Uint64));
+    metrics->cells = (Uint64 *)calloc(threads, sizeof(Uint64));
+    metrics->shownBusy = (Uint64 *)calloc(threads, sizeof(Uint64));
+    metrics->shownCells = (Uint64 *)calloc(threads, sizeof(Uint64));
+    metrics->utilization = (double *)calloc(threads, sizeof(double));
+    metrics->responseSize = 4096 + (PROFILE_SCOPES * (sizeof(kMetricsBounds) / sizeof(kMetricsBounds[0]) + 3) + threads * 3) * 96;
+    metrics->response = (char *)malloc(metrics->responseSize);
+    if (posix_memalign((void **)&game->counters, kBoardAlignment, threads * sizeof(ThreadCounters)) ||
+        ! metrics->busy || ! metrics->cells || ! metrics->shownBusy || ! metrics->shownCells || ! metrics->utilization || ! metrics->response)
+    {
+        fprintf(stderr, "Not enough memory for the metrics\n");
+        exit(EXIT_FAILURE);
+    }
+    memset(game->counters, 0, threads * sizeof(ThreadCounters));
+    metrics->step.population = metrics->shown.population = -1;
+    metrics->step.activeTiles = metrics->shown.activeTiles = -1;
+    game->counterCount = threads;
+    game->metrics = metrics;
+
+    pthread_mutex_init(&metrics->lock, NULL);
+    if (pthread_create(&metrics->thread, NULL, metrics_serve, metrics))
+    {
+        fprintf(stderr, "Unable to start the metrics server\n");
+        exit(EXIT_FAILURE);
+    }
+    return metrics;
+}
+
+/**
+ * Stop serving the metrics of a game
+ * @param game
+ */
+static void metrics_dispose(GameContainer * game)
+{
+    Metrics * metrics = game->metrics;
+
+    __atomic_store_n(&metrics->quit, Yes, __ATOMIC_RELEASE);
+    pthread_join(metrics->thread, NULL);
+    close(metrics->listener);
+    pthread_mutex_destroy(&metrics->lock);
+    free(metrics->busy);
+    free(metrics->cells);
+    free(metrics->shownBusy);
+    free(metrics->shownCells);
+    free(metrics->utilization);
+    free(metrics->response);
+    free(metrics);
+    free(game->counters);
+    game->metrics = NULL;
+    game->counters = NULL;
+    game->counterCount = 0;
+}
+
+/**
+ * Initialize the game board.
+ * @param game
+ */
+static void initialize_game(GameContainer * game)
+{
+    // Store the video surface. We don't have to call this routine each time.
+    // OpenGL owns the window: the buttons and timings go to an overlay uploaded each frame
+    game->screen = SDL_GetVideoSurface();
+    if (game->useOpenGL)
+    {
+        game->screen = SDL_CreateRGBSurface(SDL_SWSURFACE, game->screen->w, kOverlayHeight, 32,
+                                            0x00FF0000, 0x0000FF00, 0x000000FF, 0xFF000000);
+    }
+    
+    // Clean up default vars
+    game->playing = No;
+    game->quit = No;
+    
+    // Get the font
+    game->defaultFont = TTF_OpenFont("FreeSans.ttf", 16);
+    game->overlay = overlay_create(game->defaultFont);
+    game->profiler = profiler_create();
+    
+    // Create Start button
+    game->startBtn = button_create(game->defaultFont, "Start");
+    button_set_position(game->startBtn, 5, 5);
+    button_set_active(game->startBtn, 1);
+    
+    // Create Stop button
+    game->stopBtn  = button_create(game->defaultFont, "Stop");
+    button_set_position(game->stopBtn, game->startBtn->surf[INACTIVE]->clip_rect.w + 10, 5);
+    button_set_active(game->stopBtn, 0);
+    
+    // Create Reset button
+    game->resetBtn = button_create(game->defaultFont, "Reset");        
+    button_set_position(game->resetBtn, game->startBtn->surf[INACTIVE]->clip_rect.w + game->stopBtn->surf[INACTIVE]->clip_rect.w + 15, 5);
+    button_set_active(game->resetBtn, 1);
+        
+    // Create the two boards. 
+    game_create_boards(game);
+    if (game->loadPath)
+    {
+        game_load(game, game->loadPath);
+    }
+
+    
+    if (game->useOpenGL)
+    {
+        game->gpu = gpu_create(game);
+    }
+}
+
+/**
+ * Be nice with the system on exiting (Old MacOS classic habit)
+ * @param game
+ */
+static void dispose_game(GameContainer * game)
+{
+    game_dispose_boards(game);
+    overlay_dispose(game->overlay);
+    profile_print(game->profiler);
+    if (game->profileCsv)
+    {
+        profile_write_csv(game->profiler, game->profileCsv);
+    }
+    if (game->profileTrace)
+    {
+        profile_write_trace(game->profiler, game->profileTrace);
+    }
+    profiler_dispose(game->profiler);
+    TTF_CloseFont(game->defaultFont);
+    button_dispose(game->startBtn);
+    button_dispose(game->stopBtn);
+    button_dispose(game->resetBtn);
+    if (game->gpu)
+    {
+        gpu_dispose(game->gpu);
+        SDL_FreeSurface(game->screen);
+        game->gpu = NULL;
+    }
+}
+
+/**
+ * Get how many cells fit in the window. Big boards are larger than the screen,
+ * there's no need to walk the hidden part.
+ * @param game
+ * @param cols Number of visible columns
+ * @param rows Number of visible rows
+ */
+static void game_visible_cells(const GameContainer * game, Uint32 * cols, Uint32 * rows)
+{
+    *cols = (game->screen->w * game->cellsPerPixel + game->tileSize - 1) / game->tileSize;
+    *rows = (game->screen->h * game->cellsPerPixel + game->tileSize - 1) / game->tileSize;
+    if (*cols > game_board(game)->width)
+    {
+        *cols = game_board(game)->width;
+    }
+    if (*rows > game_board(game)->height)
+    {
+        *rows = game_board(game)->height;
+    }
+}
+
+/**
+ * Tell if any cell of a rectangle is alive
+ * @param board
+ * @param x, y Top left cell
+ * @param w, h Size in cells, clipped to the board
+ */
+static int board_any_alive(const Board * board, Uint32 x, Uint32 y, Uint32 w, Uint32 h)
+{
+    Uint32 i, j;
+    const Uint32 right = x + w < board->width ? x + w : board->width;
+    const Uint32 bottom = y + h < board->height ? y + h : board->height;
+    
+    for (i = y; i < bottom; i++)
+    {
+        if (board->format == BOARD_PACKED)
+        {
+            const Uint64 * words = board_packed_row(board, i);
+            for (j = x; j < right; j = (j | 63) + 1)
+            {
+                // Bits j to the end of the span in the word j >> 6
+                const Uint32 end = (j | 63) + 1 < right ? 64 : ((right - 1) & 63) + 1;
+                const Uint64 mask = (end == 64 ? ~0ULL : (1ULL << end) - 1) & (~0ULL << (j & 63));
+                if (words[j >> 6] & mask)
+                {
+                    return Yes;
+                }
+            }
+        }
+        else
+        {
+            const Uint8 * cells = board_row(board, i);
+            for (j = x; j < right; j++)
+            {
+                if (cells[j])
+                {
+                    return Yes;
+                }
+            }
+        }
+    }
+    return No;
+}
+
+/**
+ * Rasterize a rectangle of the screen straight into its pixels: no blit, no
+ * shared state, so disjoint rectangles may be drawn at the same time. When
+ * zoomed out a pixel shows the OR of the cells it covers, a lonely cell never
+ * vanishes. The screen must be locked and 32 bits.
+ * @param game
+ * @param left, top First pixel
+ * @param right, bottom Last pixel (excluded)
+ */
+static void draw_pixels(const GameContainer * game, Uint32 left, Uint32 top, Uint32 right, Uint32 bottom)
+{
+    register Uint32 x, y;
+    const Board * board = game_board(game);
+    const Uint32 white = SDL_MapRGB(game->screen->format, 0xFF, 0xFF, 0xFF);
+    const Uint32 zoom = game->tileSize;
+    const Uint32 shrink = game->cellsPerPixel;
+    
+    right = right < (Uint32)game->screen->w ? right : (Uint32)game->screen->w;
+    bottom = bottom < (Uint32)game->screen->h ? bottom : (Uint32)game->screen->h;
+    if (left >= right)
+    {
+        return;
+    }
+    
+    for (y = top; y < bottom; y++)
+    {
+        Uint32 * pixels = (Uint32 *)((Uint8 *)game->screen->pixels + (size_t)y * game->screen->pitch);
+        const Uint32 cy = y * shrink / zoom;
+        
+        if (cy >= board->height)
+        {
+            memset(pixels + left, 0, (right - left) * sizeof(Uint32));
+        }
+        else if (shrink > 1)
+        {
+            for (x = left; x < right; x++)
+            {
+                pixels[x] = board_any_alive(board, x * shrink, cy, shrink, shrink) ? white : 0;
+            }
+        }
+        else if (y > top && y % zoom)
+        {
+            // Same cells as the scanline above
+            const Uint32 * above = (const Uint32 *)((const Uint8 *)pixels - game->screen->pitch);
+            memcpy(pixels + left, above + left, (right - left) * sizeof(Uint32));
+        }
+        else
+        {
+            for (x = left; x < right; x++)
+            {
+                const Uint32 cx = x / zoom;
+                pixels[x] = cx < board->width && board_get_cell(board, cx, cy) ? white : 0;
+            }
+        }
+    }
+}
+
+/**
+ * Lock the screen around draw_pixels if needed
+ * @param game
+ * @param left, top First pixel
+ * @param right, bottom Last pixel (excluded)
+ */
+static void draw_rect(const GameContainer * game, Uint32 left, Uint32 top, Uint32 right, Uint32 bottom)
+{
+    if (SDL_MUSTLOCK(game->screen))
+    {
+        SDL_LockSurface(game->screen);
+    }
+    draw_pixels(game, left, top, right, bottom);
+    if (SDL_MUSTLOCK(game->screen))
+    {
+        SDL_UnlockSurface(game->screen);
+    }
+}
+
+/**
+ * Draw the board in usual way
+ * @param game
+ */
+static void draw_board(GameContainer * game)
+{
+    draw_rect(game, 0, 0, game->screen->w, game->screen->h);
+}
+
+/**
+ * Draw only the tiles which changed during the last generation, plus the
+ * ones under the buttons and timings which are painted over each frame.
+ * The rest of the screen is kept from the previous frame.
+ * @param game
+ */
+static void draw_board_active(GameContainer * game)
+{
+    register Uint32 tx, ty;
+    Uint32 rows, cols;
+
+    // A pixel may not cover several tiles
+    if (game->redrawAll || ! game->changedTiles || game->cellsPerPixel > kActiveTileSize)
+    {
+        draw_board(game);
+        return;
+    }
+
+    if (SDL_MUSTLOCK(game->screen))
+    {
+        SDL_LockSurface(game->screen);
+    }
+    game_visible_cells(game, &cols, &rows);
+    for (ty = 0; ty * kActiveTileSize < rows; ty++)
+    {
+        for (tx = 0; tx * kActiveTileSize < cols; tx++)
+        {
+            const Uint32 top = ty * kActiveTileSize * game->tileSize / game->cellsPerPixel;
+            const Uint32 bottom = (ty + 1) * kActiveTileSize * game->tileSize / game->cellsPerPixel;
+
+            if ( ! game->changedTiles[ty * game->tilesX + tx] && top >= kOverlayHeight)
+            {
+                continue;
+            }
+            draw_pixels(game, tx * kActiveTileSize * game->tileSize / game->cellsPerPixel, top,
+                        (tx + 1) * kActiveTileSize * game->tileSize / game->cellsPerPixel, bottom);
+        }
+    }
+    if (SDL_MUSTLOCK(game->screen))
+    {
+        SDL_UnlockSurface(game->screen);
+    }
+}
+
+/**
+ * Draw the board with OpenMP. Each thread rasterizes its own band of
+ * scanlines, so no two threads ever write the same pixel.
+ * @param game
+ */
+static void draw_board_openmp(GameContainer * game)
+{
+    const Uint32 height = game->screen->h;
+    
+    if (SDL_MUSTLOCK(game->screen))
+    {
+        SDL_LockSurface(game->screen);
+    }
+    if (openmp_serial())
+    {
+        draw_pixels(game, 0, 0, game->screen->w, height);
+    }
+    else
+    {
+        #pragma omp parallel
+        {
+            const Uint32 count = omp_get_num_threads();
+            const Uint32 band = omp_get_thread_num();
+            draw_pixels(game, 0, height * band / count, game->screen->w, height * (band + 1) / count);
+        }
+    }
+    if (SDL_MUSTLOCK(game->screen))
+    {
+        SDL_UnlockSurface(game->screen);
+    }
+}
+
+/**
+ * Draw a band of scanlines straight into the screen pixels. Each worker owns
+ * its scanlines, nothing is shared. The screen must be locked.
+ * @param game
+ * @param band Number of the worker
+ */
+static void draw_thread(GameContainer * game, Uint32 band)
+{
+    Uint32 first, last;
+
+    worker_pool_band(game->pool, band, &first, &last);
+    draw_pixels(game, 0, first, game->screen->w, last);
+}
+
+/**
+ * Draw the board with the persistent worker threads, one band of scanlines each
+ * @param game
+ */
+static void draw_board_multithread(GameContainer * game)
+{
+    if (SDL_MUSTLOCK(game->screen))
+    {
+        SDL_LockSurface(game->screen);
+    }
+    worker_pool_run(game->pool, draw_thread, game, game->screen->h);
+    if (SDL_MUSTLOCK(game->screen))
+    {
+        SDL_UnlockSurface(game->screen);
+    }
+}
+
+
+/**
+ * Make a cell alive from a position on the screen
+ * @param game
+ * @param x Horizontal position in pixels
+ * @param y Vertical position in pixels
+ */
+static void game_paint_cell(GameContainer * game, Uint32 x, Uint32 y)
+{
+    if (game->gpu)
+    {
+        const float cellX = game->gpu->viewX + x / game->gpu->zoom;
+        const float cellY = game->gpu->viewY + y / game->gpu->zoom;
+        if (cellX >= 0 && cellY >= 0 && cellX < game->width && cellY < game->height)
+        {
+            gpu_set_cell(game, (Uint32)cellX, (Uint32)cellY);
+        }
+        return;
+    }
+    
+    x = x * game->cellsPerPixel / game->tileSize;
+    y = y * game->cellsPerPixel / game->tileSize;
+    if (x < game_board(game)->width && y < game_board(game)->height)
+    {
+        board_set_cell(game_board(game), x, y, 1);
+        game->activityReset = Yes;
+        game->redrawAll = Yes;
+        game->hashValid = No;
+    }
+}
+
+/**
+ * Zoom in or out with the mouse wheel. Zooming in grows the cells up to
+ * kTileSize pixels, zooming out shows up to a whole board in the window.
+ * @param game
+ * @param in Yes to zoom in
+ */
+static void game_zoom(GameContainer * game, int in)
+{
+    if (in && game->cellsPerPixel > 1)
+    {
+        game->cellsPerPixel /= 2;
+    }
+    else if (in && game->tileSize < kTileSize)
+    {
+        game->tileSize++;
+    }
+    else if ( ! in && game->tileSize > 1)
+    {
+        game->tileSize--;
+    }
+    else if ( ! in && (game->width > game->screen->w * game->cellsPerPixel || game->height > game->screen->h * game->cellsPerPixel))
+    {
+        game->cellsPerPixel *= 2;
+    }
+    game->redrawAll = Yes;
+}
+
+/**
+ * Seconds elapsed on a monotonic clock, for measures longer than a second
+ */
+static double get_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/**
+ * Simulation thread of --sim-thread. It computes generations at its own pace
+ * on a private copy of the game, and hands them to the renderer through a
+ * lock-free triple buffer over GameContainer.boards:
+ * - state holds the latest completed board (bits 0-1) and the board shown
+ *   by the renderer (bits 2-3);
+ * - the thread writes into the board which is neither, so it never writes
+ *   what is read, and reads the latest one (the renderer only reads it too);
+ * - it publishes by swapping the latest board with a CAS, the renderer
+ *   takes the latest one the same way before each frame.
+ * The lock only parks the thread while the game is stopped, so the board
+ * can be edited.
+ */
+struct Simulation
+{
+    GameContainer game;                 // Compute state owned by the thread
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t wake;                // running or quit changed
+    pthread_cond_t parked;              // The thread stopped computing
+    int running;                        // The renderer wants generations
+    int idle;                           // The thread waits for running
+    int quit;
+    Uint32 state;                       // Latest and shown boards, see above
+    Uint32 stepUsec;                    // Compute time of the last generation
+};
+
+#define SIM_LATEST(state) ((state) & 3)
+#define SIM_SHOWN(state) (((state) >> 2) & 3)
+#define SIM_STATE(latest, shown) ((latest) | (shown) << 2)
+
+/**
+ * Body of the simulation thread
+ * @param arg The simulation
+ */
+static void * simulation_thread(void * arg)
+{
+    Simulation * sim = (Simulation *)arg;
+    GameContainer * game = &sim->game;
+    Uint64 done = 0;
+    double start = 0;
+    
+    for (;;)
+    {
+        Uint32 state, published;
+        double begin;
+        int i;
+        
+        pthread_mutex_lock(&sim->lock);
+        if ( ! sim->running && ! sim->quit)
+        {
+            sim->idle = Yes;
+            pthread_cond_broadcast(&sim->parked);
+            while ( ! sim->running && ! sim->quit)
+            {
+                pthread_cond_wait(&sim->wake, &sim->lock);
+            }
+            sim->idle = No;
+            done = 0;
+            start = get_seconds();
+        }
+        pthread_mutex_unlock(&sim->lock);
+        if (sim->quit)
+        {
+            break;
+        }
+        
+        // Prefer the board of the previous generation: the active tracking
+        // expects it there. The renderer may hold it, then no tile is skipped.
+        state = __atomic_load_n(&sim->state, __ATOMIC_ACQUIRE);
+        if ((Uint32)game->next == SIM_SHOWN(state))
+        {
+            for (i = 0; i == game->current || i == (int)SIM_SHOWN(state); i++);
+            game->next = i;
+            game->activityReset = Yes;
+        }
+        
+        begin = get_seconds();
+        game_step(game);
+        __atomic_store_n(&sim->stepUsec, (Uint32)((get_seconds() - begin) * 1e6), __ATOMIC_RELAXED);
+        
+        // Publish, the renderer may have taken the previous one meanwhile
+        do
+        {
+            published = SIM_STATE((Uint32)game->current, SIM_SHOWN(state));
+        }
+        while ( ! __atomic_compare_exchange_n(&sim->state, &state, published, Yes, __ATOMIC_RELEASE, __ATOMIC_ACQUIRE));
+        
+        // Wait for the target rate
+        if (game->targetRate > 0)
+        {
+            const double wait = start + ++done / game->targetRate - get_seconds();
+            if (wait > 0)
+            {
+                struct timespec ts = { (time_t)wait, (long)((wait - (time_t)wait) * 1e9) };
+                nanosleep(&ts, NULL);
+            }
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Start the simulation thread, parked until simulation_resume. The third
+ * board of the triple buffer is created here.
+ * @param game
+ */
+static Simulation * simulation_create(GameContainer * game)
+{
+    Simulation * sim = (Simulation *)calloc(1, sizeof(Simulation));
+    
+    if (arena_board(game->arena, &game->boards[2], game->width, game->height, game->format))
+    {
+        fprintf(stderr, "Not enough memory for a %ux%u board\n", game->width, game->height);
+        exit(EXIT_FAILURE);
+    }
+    sim->game = *game;
+    sim->state = SIM_STATE((Uint32)game->current, (Uint32)game->current);
+    sim->idle = No;
+    pthread_mutex_init(&sim->lock, NULL);
+    pthread_cond_init(&sim->wake, NULL);
+    pthread_cond_init(&sim->parked, NULL);
+    if (pthread_create(&sim->thread, NULL, simulation_thread, sim))
+    {
+        fprintf(stderr, "Can't create the simulation thread\n");
+        exit(EXIT_FAILURE);
+    }
+    return sim;
+}
+
+/**
+ * Let the simulation thread compute from the current board of the game
+ * @param game
+ */
+static void simulation_resume(GameContainer * game)
+{
+    Simulation * sim = game->simulation;
+    
+    pthread_mutex_lock(&sim->lock);
+    sim->game.current = game->current;
+    sim->game.next = game->next;
+    sim->game.activityReset |= game->activityReset;
+    game->activityReset = No;
+    __atomic_store_n(&sim->state, SIM_STATE((Uint32)game->current, (Uint32)game->current), __ATOMIC_RELEASE);
+    sim->running = Yes;
+    pthread_cond_signal(&sim->wake);
+    pthread_mutex_unlock(&sim->lock);
+}
+
+/**
+ * Wait for the simulation thread to stop between two generations, then bring
+ * its state back in the game so the board can be edited
+ * @param game
+ */
+static void simulation_pause(GameContainer * game)
+{
+    Simulation * sim = game->simulation;
+    
+    pthread_mutex_lock(&sim->lock);
+    sim->running = No;
+    while ( ! sim->idle)
+    {
+        pthread_cond_wait(&sim->parked, &sim->lock);
+    }
+    game->current = sim->game.current;
+    game->next = sim->game.next;
+    game->generation = sim->game.generation;
+    game->changedTiles = sim->game.changedTiles;
+    game->activeList = sim->game.activeList;
+    game->activeCount = sim->game.activeCount;
+    game->tilePopulation = sim->game.tilePopulation;
+    game->population = sim->game.population;
+    game->tilesX = sim->game.tilesX;
+    game->tilesY = sim->game.tilesY;
+    __atomic_store_n(&sim->state, SIM_STATE((Uint32)game->current, (Uint32)game->current), __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&sim->lock);
+}
+
+/**
+ * Take the latest completed generation for the renderer. It stays valid
+ * until the next call.
+ * @param sim
+ * @return Indice of the board to show
+ */
+static int simulation_acquire(Simulation * sim)
+{
+    Uint32 state = __atomic_load_n(&sim->state, __ATOMIC_ACQUIRE);
+    
+    while ( ! __atomic_compare_exchange_n(&sim->state, &state, SIM_STATE(SIM_LATEST(state), SIM_LATEST(state)),
+                                          Yes, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));
+    return SIM_LATEST(state);
+}
+
+/**
+ * Stop and join the simulation thread
+ * @param game
+ */
+static void simulation_dispose(GameContainer * game)
+{
+    Simulation * sim = game->simulation;
+    
+    simulation_pause(game);
+    pthread_mutex_lock(&sim->lock);
+    sim->quit = Yes;
+    pthread_cond_signal(&sim->wake);
+    pthread_mutex_unlock(&sim->lock);
+    pthread_join(sim->thread, NULL);
+    pthread_mutex_destroy(&sim->lock);
+    pthread_cond_destroy(&sim->wake);
+    pthread_cond_destroy(&sim->parked);
+    free(sim);
+    game->simulation = NULL;
+}
+
+/**
+ * Process the main loop
+ * @param game
+ */
+static void do_main_loop(GameContainer * game)
+{
+    SDL_Event evt;
+    char mouseButtonDown = 0;
+    Profiler * prof = game->profiler;
+    
+    memset(&evt, 0, sizeof(SDL_Event));
+
+    while ( ! game->quit )
+    {
+        profile_next_frame(prof);
+        profile_begin(prof, PROFILE_EVENTS);
+        while (SDL_PollEvent(&evt)) 
+        {
+            game->quit = evt.type == SDL_QUIT;
+            
+            if (game->gpu && gpu_handle_event(game, &evt))
+            {
+                continue;
+            }
+            if (evt.type == SDL_MOUSEBUTTONDOWN &&
+                (evt.button.button == SDL_BUTTON_WHEELUP || evt.button.button == SDL_BUTTON_WHEELDOWN))
+            {
+                game_zoom(game, evt.button.button == SDL_BUTTON_WHEELUP);
+                continue;
+            }
+            
+            if ( ! game->playing)
+            {
+                switch (evt.type)
+                {
+                    case SDL_MOUSEBUTTONDOWN:
+                        
+                        if (evt.button.button == SDL_BUTTON_LEFT)
+                        {
+                            if (button_is_clicked(game->startBtn, evt.button.x, evt.button.y))
+                            {
+                                game->playing = Yes;
+                                if (game->simulation)
+                                {
+                                    simulation_resume(game);
+                                }
+                                button_set_active(game->resetBtn, 0);
+                                button_set_active(game->startBtn, 0);
+                                button_set_active(game->stopBtn, 1);
+                            }
+                            else if (button_is_clicked(game->resetBtn, evt.button.x, evt.button.y))
+                            {
+                                board_reset(game);
+                                if (game->gpu)
+                                {
+                                    gpu_upload(game);
+                                }
+                            }
+                            else 
+                            {
+                                mouseButtonDown = Yes;
+                                game_paint_cell(game, evt.button.x, evt.button.y);
+                            }
+                            
+                        }
+                        break;
+                        
+                    case SDL_MOUSEBUTTONUP:
+                        if ( ! game->playing)
+                        {
+                                mouseButtonDown = evt.button.button != SDL_BUTTON_LEFT;
+                        }
+                        break;
+                        
+                    case SDL_MOUSEMOTION:
+                        if (mouseButtonDown)
+                        {
+                            game_paint_cell(game, evt.motion.x, evt.motion.y);
+                        }
+                        break;
+                        
+                    case SDL_KEYDOWN:
+                        if (evt.key.keysym.sym == SDLK_s && game->savePath && ! game_save(game, game->savePath))
+                        {
+                            printf("Saved generation %llu to %s\n", (unsigned long long)game->generation, game->savePath);
+                        }
+                        break;
+                }
+            } 
+            else
+            {
+                if (evt.type == SDL_MOUSEBUTTONDOWN)
+                {
+                    game->playing = ! button_is_clicked(game->stopBtn, evt.button.x, evt.button.y);
+                    if (game->simulation && ! game->playing)
+                    {
+                        simulation_pause(game);
+                    }
+                    button_set_active(game->resetBtn, !game->playing);
+                    button_set_active(game->startBtn, !game->playing);
+                    button_set_active(game->stopBtn,   game->playing);
+                }
+            }
+        }
+        profile_end(prof, PROFILE_EVENTS);
+        
+        profile_begin(prof, PROFILE_COMPUTE);
+        if ( ! game->simulation && game->playing == Yes)
+        {
+            game_step(game);
+        } 
+        profile_end(prof, PROFILE_COMPUTE);
+        
+        profile_begin(prof, PROFILE_DRAW);
+        if (game->useOpenGL || ! game->partialDraw || game->redrawAll)
+        {
+            SDL_FillRect(game->screen, NULL, 0);
+        }
+        if (game->simulation)
+        {
+            // Show the latest completed generation
+            GameContainer view = *game;
+            view.current = simulation_acquire(game->simulation);
+            game->drawBoardFunc(&view);
+        }
+        else
+        {
+            game->drawBoardFunc(game);
+        }
+        game->redrawAll = No;
+        
+        button_draw(game->startBtn, game->screen);
+        button_draw(game->stopBtn,  game->screen);
+        button_draw(game->resetBtn, game->screen);
+        profile_end(prof, PROFILE_DRAW);
+        
+        // Medians over the last frames. The simulation thread computes on its own, show the cost of its last generation.
+        profile_begin(prof, PROFILE_OVERLAY);
+        draw_fps(game->screen, game->overlay, profile_fps(prof));
+        draw_time(game->screen, game->overlay, OVERLAY_COMPUTE, game->simulation ?
+                  (Sint64)__atomic_load_n(&game->simulation->stepUsec, __ATOMIC_RELAXED) :
+                  (Sint64)(profile_percentile(prof, PROFILE_COMPUTE, 50) / 1000), 30);
+        draw_time(game->screen, game->overlay, OVERLAY_DRAW, profile_percentile(prof, PROFILE_DRAW, 50) / 1000, 50);
+        profile_end(prof, PROFILE_OVERLAY);
+
+        profile_begin(prof, PROFILE_FLIP);
+        if ( ! game->useOpenGL)
+        {
+            SDL_Flip(game->screen);
+        }
+        else
+        {
+            gpu_present(game);
+        }
+        profile_end(prof, PROFILE_FLIP);
+        if (game->metrics)
+        {
+            metrics_frame(game->metrics, profile_frame(prof));
+        }
+    }
+}
+
+/**
+ * Board hashes seen so far, to find a cycle: open addressing, the hash is
+ * the key
+ */
+typedef struct CycleTable
+{
+    struct { Uint64 hash; Uint64 generation; } * entries;
+    Uint64 count;
+    Uint64 capacity;                    // Always a power of 2
+} CycleTable;
+
+const Uint64 kCycleReserve = 1 << 20;   // Largest table carved before a run (16 MB), a longer one grows it
+
+/**
+ * Move the hashes to a larger table
+ * @param table
+ * @param capacity The new capacity, a power of 2
+ */
+static void cycle_table_grow(CycleTable * table, Uint64 capacity)
+{
+    Uint64 i;
+    CycleTable grown;
+    
+    grown.capacity = capacity;
+    grown.count = 0;
+    grown.entries = calloc(grown.capacity, sizeof(*grown.entries));
+    if ( ! grown.entries)
+    {
+        fprintf(stderr, "Not enough memory for the cycle detection\n");
+        exit(EXIT_FAILURE);
+    }
+    for (i = 0; i < table->capacity; i++)
+    {
+        if (table->entries[i].generation)
+        {
+            Uint64 j = table->entries[i].hash & (grown.capacity - 1);
+            while (grown.entries[j].generation)
+            {
+                j = (j + 1) & (grown.capacity - 1);
+            }
+            grown.entries[j] = table->entries[i];
+            grown.count++;
+        }
+    }
+    free(table->entries);
+    *table = grown;
+}
+
+/**
+ * Record the hash of a generation
+ * @param table
+ * @param hash
+ * @param generation
+ * @param first Out: the first generation with this hash, when found
+ * @return Yes if the hash was already seen: the board is in a cycle
+ */
+static int cycle_table_add(CycleTable * table, Uint64 hash, Uint64 generation, Uint64 * first)
+{
+    Uint64 i;
+    
+    if (table->count * 2 >= table->capacity)
+    {
+        cycle_table_grow(table, table->capacity ? table->capacity * 2 : 1024);
+    }
+    
+    // Generations are stored + 1, 0 marks a free entry
+    for (i = hash & (table->capacity - 1); table->entries[i].generation; i = (i + 1) & (table->capacity - 1))
+    {
+        if (table->entries[i].hash == hash)
+        {
+            *first = table->entries[i].generation - 1;
+            return Yes;
+        }
+    }
+    table->entries[i].hash = hash;
+    table->entries[i].generation = generation + 1;
+    table->count++;
+    return No;
+}
+
+/**
+ * Check a backend against board_compute_reference: both run from the
+ * same random boards, their tile hashes are compared after each step.
+ * @param game The backend to check, set up by the command line
+ * @param generations Number of generations per seed
+ * @param seed First seed
+ * @param seeds Number of seeds
+ * @param density Percentage of living cells at start
+ * @return EXIT_SUCCESS if the backend agrees everywhere
+ */
+static int run_verify(GameContainer * game, Uint64 generations, Uint64 seed, Uint32 seeds, Uint32 density)
+{
+    const Uint32 depth = game->temporalDepth;
+    const Uint32 tilesX = (game->width + kActiveTileSize - 1) / kActiveTileSize;
+    const Uint32 count = tilesX * ((game->height + kActiveTileSize - 1) / kActiveTileSize);
+    Uint64 * expected = (Uint64 *)malloc(sizeof(Uint64) * count);
+    Uint64 * actual = (Uint64 *)malloc(sizeof(Uint64) * count);
+    GameContainer ref;
+    Uint32 s, i, x, y;
+    
+    if ( ! expected || ! actual)
+    {
+        fprintf(stderr, "Not enough memory for the tile hashes\n");
+        exit(EXIT_FAILURE);
+    }
+    
+    memset(&ref, 0, sizeof(GameContainer));
+    ref.width = game->width;
+    ref.height = game->height;
+    ref.format = BOARD_BYTES;
+    ref.computeBoardFunc = board_compute_reference;
+    ref.topology = game->topology;
+    ref.loadPath = game->loadPath;
+    if (game->loadPath)
+    {
+        seeds = 1;
+    }
+    
+    for (s = 0; s < seeds; s++)
+    {
+        Uint64 hash = 0, end;
+        
+        game_create_boards(game);
+        game_create_boards(&ref);
+        game_populate(game, seed + s, density);
+        game_populate(&ref, seed + s, density);
+        game->temporalDepth = depth;
+        game->activityReset = Yes;
+        end = game->generation + generations;
+        
+        while (game->generation < end)
+        {
+            if (game->temporalDepth > end - game->generation)
+            {
+                game->temporalDepth = (Uint32)(end - game->generation);
+            }
+            game_step(game);
+            while (ref.generation < game->generation)
+            {
+                game_step(&ref);
+            }
             
-            if ( ! game.playing)
+            hash = board_hash(game_board(game), actual);
+            if (hash == board_hash(game_board(&ref), expected))
+            {
+                continue;
+            }
+            // Find the first tile which differs, then its first cell which differs
+            for (i = 0; i < count && actual[i] == expected[i]; i++)
+            {
+            }
+            for (y = i / tilesX * kActiveTileSize; y < (i / tilesX + 1) * kActiveTileSize && y < game->height; y++)
+            {
+                for (x = i % tilesX * kActiveTileSize; x < (i % tilesX + 1) * kActiveTileSize && x < game->width; x++)
+                {
+                    if (board_get_cell(game_board(game), x, y) != board_get_cell(game_board(&ref), x, y))
+                    {
+                        printf("Seed %llu: generation %llu differs from the reference in tile (%u, %u), first at cell (%u, %u): %u instead of %u\n",
+                               (unsigned long long)(seed + s), (unsigned long long)game->generation, i % tilesX, i / tilesX,
+                               x, y, board_get_cell(game_board(game), x, y), board_get_cell(game_board(&ref), x, y));
+                        game_dispose_boards(game);
+                        game_dispose_boards(&ref);
+                        free(expected);
+                        free(actual);
+                        return (EXIT_FAILURE);
+                    }
+                }
+            }
+        }
+        printf("Seed %llu: %llu generations agree with the reference (hash %016llx)\n",
+               (unsigned long long)(seed + s), (unsigned long long)game->generation, (unsigned long long)hash);
+        game_dispose_boards(game);
+        game_dispose_boards(&ref);
+    }
+    
+    free(expected);
+    free(actual);
+    return (EXIT_SUCCESS);
+}
+
+/**
+ * Periodic checkpoints of a headless run. A forked child writes the
+ * snapshot: it sees the board as it was at the fork, the pages the parent
+ * goes on writing are copied for it by the kernel, so the simulation never
+ * waits for the disk.
+ */
+typedef struct Checkpoint
+{
+    const char * path;                  // Snapshot file, written to path.tmp then renamed
+    Uint64 every;                       // Generations between two checkpoints, 0 for none
+    double seconds;                     // Seconds between two checkpoints, 0 for none
+    Uint64 nextGeneration;
+    double nextTime;
+    pid_t writer;                       // Child writing the last checkpoint, 0 when none
+    Uint64 writerGeneration;            // Generation of the last checkpoint, the start of the run before the first
+} Checkpoint;
+
+/**
+ * Reap the child writing the last checkpoint
+ * @param checkpoint
+ * @param wait Block until it is done
+ */
+static void checkpoint_reap(Checkpoint * checkpoint, int wait)
+{
+    int status;
+    
+    if ( ! checkpoint->writer || waitpid(checkpoint->writer, &status, wait ? 0 : WNOHANG) == 0)
+    {
+        return;
+    }
+    if (WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS)
+    {
+        printf("Checkpoint of generation %llu written to %s\n", (unsigned long long)checkpoint->writerGeneration, checkpoint->path);
+    }
+    else
+    {
+        fprintf(stderr, "Checkpoint of generation %llu failed\n", (unsigned long long)checkpoint->writerGeneration);
+    }
+    checkpoint->writer = 0;
+}
+
+/**
+ * Take a checkpoint if one is due and the previous one is written. The
+ * snapshot goes to a temporary file renamed once synced, the last complete
+ * checkpoint is never lost.
+ * @param checkpoint
+ * @param game
+ * @param final End of the run: wait for the previous checkpoint and take one of this generation unless it has one
+ */
+static void checkpoint_update(Checkpoint * checkpoint, const GameContainer * game, int final)
+{
+    pid_t pid;
+    
+    checkpoint_reap(checkpoint, final);
+    if (final ? checkpoint->writerGeneration == game->generation :
+        checkpoint->writer ||
+        ! ((checkpoint->every && game->generation >= checkpoint->nextGeneration) ||
+           (checkpoint->seconds > 0 && get_seconds() >= checkpoint->nextTime)))
+    {
+        return;
+    }
+    
+    fflush(stdout);
+    pid = fork();
+    if (pid == 0)
+    {
+        // Only this thread lives in the child: no OpenMP, no exit handlers
+        char * temporary = (char *)malloc(strlen(checkpoint->path) + 5);
+        FILE * file;
+        int status = -1;
+        
+        if (temporary)
+        {
+            sprintf(temporary, "%s.tmp", checkpoint->path);
+            file = fopen(temporary, "wb");
+            if (file)
+            {
+                status = board_write_snapshot(game_board(game), game->generation, file);
+                status |= fflush(file) || fsync(fileno(file));
+                status |= fclose(file);
+                status |= rename(temporary, checkpoint->path);
+            }
+        }
+        _exit(status ? EXIT_FAILURE : EXIT_SUCCESS);
+    }
+    if (pid < 0)
+    {
+        fprintf(stderr, "Can't fork the checkpoint writer\n");
+    }
+    else
+    {
+        checkpoint->writer = pid;
+        checkpoint->writerGeneration = game->generation;
+    }
+    checkpoint->nextGeneration = game->generation + checkpoint->every;
+    checkpoint->nextTime = get_seconds() + checkpoint->seconds;
+}
+
+/**
+ * Output of --record
+ */
+typedef enum RecordFormat
+{
+    RECORD_DELTA,                       // Cells which changed, per 64x64 tile
+    RECORD_FRAMES                       // Raw 8-bit gray frames, one pixel per cell (ffmpeg -f rawvideo -pix_fmt gray)
+} RecordFormat;
+
+/**
+ * A recorded generation on its way to the writer thread: the tiles which
+ * changed since the previous recorded generation
+ */
+typedef struct RecordBuffer
+{
+    Uint64 generation;
+    Uint32 count;                       // Number of tiles
+    Uint32 * tiles;                     // Their indices, row by row
+    Uint64 * rows;                      // Their 64 rows of 64 cells, tile after tile
+} RecordBuffer;
+
+#define RECORD_BUFFERS 4                // Generations waiting for the writer at most
+
+/**
+ * Streams every Nth generation of a headless run to a file or a pipe. The
+ * compute loop only copies the changed tiles, told by the active tracking
+ * when it runs, in a buffer of a fixed ring. A thread of its own encodes and
+ * writes them. When the writer is behind and the ring is full the generation
+ * is skipped: its changes stay marked and go with the next recorded one. The
+ * last generation of the run is always recorded.
+ *
+ * The delta stream starts with the header "GOLDELT1", then the width, the
+ * height, the tiles per row and per column as Uint32. Each generation is a
+ * Uint64 generation and a Uint32 tile count, each tile a Uint32 indice, two
+ * Uint16 counts of cells born and died, a Uint64 mask of its rows which
+ * changed, then these rows XORed with the previous state (cell x in bit x).
+ * Every value is in the byte order of the host, the state before the first
+ * generation is empty.
+ */
+typedef struct Recorder
+{
+    RecordFormat format;
+    FILE * file;
+    int pipe;                           // The file is a command started by popen
+    Uint64 every;                       // Record every Nth generation
+    Uint64 nextGeneration;
+    Uint64 lastGeneration;              // Last generation handed to the writer
+    Uint32 width, height;
+    Uint32 tilesX, tilesY;
+    Uint8 * dirty;                      // Tiles changed since the last recorded generation
+    Uint64 * state;                     // Writer side: the rows of every tile, as last written
+    Uint8 * frame;                      // Writer side: a scanline of RECORD_FRAMES
+    RecordBuffer buffers[RECORD_BUFFERS];
+    Uint32 head;                        // Oldest buffer waiting for the writer
+    Uint32 queued;                      // Buffers waiting for the writer
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t filled;              // A buffer was queued
+    pthread_cond_t emptied;             // A buffer was written
+    int quit;
+    Uint64 recorded;                    // Generations written
+    Uint64 skipped;                     // Generations skipped on a full ring
+    int failed;                         // A write failed
+} Recorder;
+
+/**
+ * Write a recorded generation. Runs on the writer thread.
+ * @param rec
+ * @param buffer
+ */
+static void recorder_write(Recorder * rec, const RecordBuffer * buffer)
+{
+    Uint32 i, j, x, y;
+    int status = 0;
+    
+    if (rec->format == RECORD_DELTA)
+    {
+        const Uint64 generation = buffer->generation;
+        Uint32 count = 0;
+        
+        // Tiles copied but which came back to the state written before are left out
+        for (i = 0; i < buffer->count; i++)
+        {
+            count += memcmp(&rec->state[(size_t)buffer->tiles[i] * 64], &buffer->rows[(size_t)i * 64], 64 * sizeof(Uint64)) != 0;
+        }
+        status |= fwrite(&generation, sizeof(Uint64), 1, rec->file) != 1;
+        status |= fwrite(&count, sizeof(Uint32), 1, rec->file) != 1;
+    }
+    
+    for (i = 0; i < buffer->count; i++)
+    {
+        Uint64 * state = &rec->state[(size_t)buffer->tiles[i] * 64];
+        const Uint64 * rows = &buffer->rows[(size_t)i * 64];
+        
+        if (rec->format == RECORD_DELTA)
+        {
+            Uint64 changes[64], mask = 0;
+            Uint16 born = 0, died = 0;
+            Uint32 n = 0;
+            for (j = 0; j < 64; j++)
+            {
+                const Uint64 change = state[j] ^ rows[j];
+                if (change)
+                {
+                    born += __builtin_popcountll(change & rows[j]);
+                    died += __builtin_popcountll(change & state[j]);
+                    mask |= 1ULL << j;
+                    changes[n++] = change;
+                }
+            }
+            if (mask)
+            {
+                status |= fwrite(&buffer->tiles[i], sizeof(Uint32), 1, rec->file) != 1;
+                status |= fwrite(&born, sizeof(Uint16), 1, rec->file) != 1;
+                status |= fwrite(&died, sizeof(Uint16), 1, rec->file) != 1;
+                status |= fwrite(&mask, sizeof(Uint64), 1, rec->file) != 1;
+                status |= fwrite(changes, sizeof(Uint64), n, rec->file) != n;
+            }
+        }
+        memcpy(state, rows, 64 * sizeof(Uint64));
+    }
+    
+    if (rec->format == RECORD_FRAMES)
+    {
+        for (y = 0; y < rec->height; y++)
+        {
+            for (x = 0; x < rec->width; x++)
+            {
+                const Uint64 bits = rec->state[((size_t)(y / 64) * rec->tilesX + x / 64) * 64 + (y & 63)];
+                rec->frame[x] = (bits >> (x & 63)) & 1 ? 255 : 0;
+            }
+            status |= fwrite(rec->frame, rec->width, 1, rec->file) != 1;
+        }
+    }
+    rec->failed |= status;
+}
+
+/**
+ * Body of the writer thread: write the buffers in order as they come
+ * @param arg The recorder
+ */
+static void * recorder_thread(void * arg)
+{
+    Recorder * rec = (Recorder *)arg;
+    
+    pthread_mutex_lock(&rec->lock);
+    for (;;)
+    {
+        while ( ! rec->queued && ! rec->quit)
+        {
+            pthread_cond_wait(&rec->filled, &rec->lock);
+        }
+        if ( ! rec->queued)
+        {
+            break;
+        }
+        pthread_mutex_unlock(&rec->lock);
+        
+        recorder_write(rec, &rec->buffers[rec->head]);
+        
+        pthread_mutex_lock(&rec->lock);
+        rec->head = (rec->head + 1) % RECORD_BUFFERS;
+        rec->queued--;
+        rec->recorded++;
+        pthread_cond_signal(&rec->emptied);
+    }
+    pthread_mutex_unlock(&rec->lock);
+    return NULL;
+}
+
+/**
+ * Open the output and start the writer thread
+ * @param path A file, or "|command" to pipe the stream to a command
+ * @param format
+ * @param every Record every Nth generation
+ * @param width, height Size of the board
+ * @return The recorder. The program stops if it can't be created.
+ */
+static Recorder * recorder_create(const char * path, RecordFormat format, Uint64 every, Uint32 width, Uint32 height)
+{
+    Recorder * rec = (Recorder *)calloc(1, sizeof(Recorder));
+    Uint32 tiles, i;
+    int failed = ! rec;
+    
+    if (rec)
+    {
+        rec->format = format;
+        rec->every = every;
+        rec->width = width;
+        rec->height = height;
+        rec->tilesX = (width + 63) / 64;
+        rec->tilesY = (height + 63) / 64;
+        tiles = rec->tilesX * rec->tilesY;
+        rec->dirty = (Uint8 *)malloc(tiles);
+        rec->state = (Uint64 *)calloc((size_t)tiles * 64, sizeof(Uint64));
+        rec->frame = (Uint8 *)malloc(width);
+        failed = ! rec->dirty || ! rec->state || ! rec->frame;
+        for (i = 0; i < RECORD_BUFFERS; i++)
+        {
+            rec->buffers[i].tiles = (Uint32 *)malloc(sizeof(Uint32) * tiles);
+            rec->buffers[i].rows = (Uint64 *)malloc(sizeof(Uint64) * 64 * tiles);
+            failed |= ! rec->buffers[i].tiles || ! rec->buffers[i].rows;
+        }
+    }
+    if (failed)
+    {
+        fprintf(stderr, "Not enough memory for the recording buffers\n");
+        exit(EXIT_FAILURE);
+    }
+    
+    // Everything is new to the first recorded generation
+    memset(rec->dirty, 1, tiles);
+    rec->pipe = path[0] == '|';
+    rec->file = rec->pipe ? popen(path + 1, "w") : fopen(path, "wb");
+    if ( ! rec->file)
+    {
+        fprintf(stderr, "Can't open %s\n", path);
+        exit(EXIT_FAILURE);
+    }
+    if (format == RECORD_DELTA)
+    {
+        const Uint32 header[4] = { width, height, rec->tilesX, rec->tilesY };
+        fwrite("GOLDELT1", 8, 1, rec->file);
+        fwrite(header, sizeof(header), 1, rec->file);
+    }
+    
+    pthread_mutex_init(&rec->lock, NULL);
+    pthread_cond_init(&rec->filled, NULL);
+    pthread_cond_init(&rec->emptied, NULL);
+    if (pthread_create(&rec->thread, NULL, recorder_thread, rec))
+    {
+        fprintf(stderr, "Can't create the recording thread\n");
+        exit(EXIT_FAILURE);
+    }
+    return rec;
+}
+
+/**
+ * Follow a step of the game: mark the tiles it changed, and hand the
+ * generation to the writer when it is one to record
+ * @param rec
+ * @param game
+ * @param last The run is over: record this generation, waiting for the writer if needed
+ */
+static void recorder_update(Recorder * rec, const GameContainer * game, int last)
+{
+    const Board * board = game_board(game);
+    const Uint32 tiles = rec->tilesX * rec->tilesY;
+    RecordBuffer * buffer;
+    Uint32 i, y;
+    
+    if (game->changedTiles && game->tilesX == rec->tilesX && game->tilesY == rec->tilesY)
+    {
+        for (i = 0; i < tiles; i++)
+        {
+            rec->dirty[i] |= game->changedTiles[i];
+        }
+    }
+    else
+    {
+        memset(rec->dirty, 1, tiles);
+    }
+    if (game->generation < rec->nextGeneration && ! (last && game->generation > rec->lastGeneration))
+    {
+        return;
+    }
+    
+    pthread_mutex_lock(&rec->lock);
+    while (last && rec->queued == RECORD_BUFFERS)
+    {
+        pthread_cond_wait(&rec->emptied, &rec->lock);
+    }
+    if (rec->queued == RECORD_BUFFERS)
+    {
+        rec->skipped++;
+        rec->nextGeneration = game->generation + rec->every;
+        pthread_mutex_unlock(&rec->lock);
+        return;
+    }
+    buffer = &rec->buffers[(rec->head + rec->queued) % RECORD_BUFFERS];
+    pthread_mutex_unlock(&rec->lock);
+    
+    // The slot is out of the writer's reach until it is queued
+    buffer->generation = game->generation;
+    buffer->count = 0;
+    for (i = 0; i < tiles; i++)
+    {
+        if (rec->dirty[i])
+        {
+            const Uint32 tx = i % rec->tilesX, ty = i / rec->tilesX;
+            const Uint64 mask = tx * 64 + 64 <= rec->width ? ~0ULL : (1ULL << (rec->width & 63)) - 1;
+            Uint64 * rows = &buffer->rows[(size_t)buffer->count * 64];
+            for (y = 0; y < 64; y++)
+            {
+                rows[y] = ty * 64 + y < rec->height ? board_row_bits(board, tx * 64, ty * 64 + y) & mask : 0;
+            }
+            buffer->tiles[buffer->count++] = i;
+            rec->dirty[i] = No;
+        }
+    }
+    rec->nextGeneration = game->generation + rec->every;
+    rec->lastGeneration = game->generation;
+    
+    pthread_mutex_lock(&rec->lock);
+    rec->queued++;
+    pthread_cond_signal(&rec->filled);
+    pthread_mutex_unlock(&rec->lock);
+}
+
+/**
+ * Let the writer finish the queued generations, then close the output
+ * @param rec
+ */
+static void recorder_dispose(Recorder * rec)
+{
+    Uint32 i;
+    
+    pthread_mutex_lock(&rec->lock);
+    rec->quit = Yes;
+    pthread_cond_signal(&rec->filled);
+    pthread_mutex_unlock(&rec->lock);
+    pthread_join(rec->thread, NULL);
+    
+    rec->failed |= (rec->pipe ? pclose(rec->file) : fclose(rec->file)) != 0;
+    if (rec->failed)
+    {
+        fprintf(stderr, "Writing the recording failed\n");
+    }
+    printf("Recorded generations: %llu (%llu skipped by a busy writer)\n", (unsigned long long)rec->recorded, (unsigned long long)rec->skipped);
+    
+    for (i = 0; i < RECORD_BUFFERS; i++)
+    {
+        free(rec->buffers[i].tiles);
+        free(rec->buffers[i].rows);
+    }
+    pthread_mutex_destroy(&rec->lock);
+    pthread_cond_destroy(&rec->filled);
+    pthread_cond_destroy(&rec->emptied);
+    free(rec->dirty);
+    free(rec->state);
+    free(rec->frame);
+    free(rec);
+}
+
+/**
+ * How a benchmarked backend is set up on top of its compute function
+ */
+typedef enum BenchSetup
+{
+    BENCH_PLAIN = 0,                    // Nothing else
+    BENCH_SIMD,                         // Row kernel picked by simd_select
+    BENCH_TILED,                        // Tile size sized for the L2 cache
+    BENCH_POOL                          // Worker pool of the requested size
+} BenchSetup;
+
+/**
+ * A compute backend of the benchmark suite
+ */
+typedef struct BenchBackend
+{
+    const char * name;
+    BoardFormat format;
+    ComputeBoardFunc compute;
+    BenchSetup setup;
+    int threaded;                       // Measured with 1 thread up to one per core
+} BenchBackend;
+
+// Every registered ComputeBoardFunc, on both storages when it has both
+static const BenchBackend kBenchBackends[] = {
+    { "board_compute",              BOARD_BYTES,  board_compute,               BENCH_PLAIN, No  },
+    { "board_compute_packed",       BOARD_PACKED, board_compute_packed,        BENCH_PLAIN, No  },
+    { "board_compute_openmp",       BOARD_BYTES,  board_compute_openmp,        BENCH_PLAIN, Yes },
+    { "board_compute_packed_openmp", BOARD_PACKED, board_compute_packed_openmp, BENCH_PLAIN, Yes },
+    { "board_compute_simd",         BOARD_BYTES,  board_compute_simd,          BENCH_SIMD,  Yes },
+    { "board_compute_simd_packed",  BOARD_PACKED, board_compute_simd,          BENCH_SIMD,  Yes },
+    { "board_compute_tiled",        BOARD_BYTES,  board_compute_tiled,         BENCH_TILED, Yes },
+    { "board_compute_tiled_packed", BOARD_PACKED, board_compute_tiled,         BENCH_TILED, Yes },
+    { "board_compute_temporal",     BOARD_BYTES,  board_compute_temporal,      BENCH_TILED, Yes },
+    { "board_compute_temporal_packed", BOARD_PACKED, board_compute_temporal,   BENCH_TILED, Yes },
+    { "board_compute_active",       BOARD_BYTES,  board_compute_active,        BENCH_PLAIN, Yes },
+    { "board_compute_active_packed", BOARD_PACKED, board_compute_active,       BENCH_PLAIN, Yes },
+    { "board_compute_multithread",  BOARD_BYTES,  board_compute_multithread,   BENCH_POOL,  Yes },
+    { "board_compute_multithread_packed", BOARD_PACKED, board_compute_multithread, BENCH_POOL, Yes }
+};
+
+/**
+ * Set a game up for a backend: its compute function, and its row kernel,
+ * tile size or worker pool. The storage is the one of the backend.
+ * @param game
+ * @param backend
+ * @param threads Size of the worker pool
+ * @param tile Side of the tiles, 0 for tiles sized for the L2 cache
+ */
+static void backend_setup(GameContainer * game, const BenchBackend * backend, Uint32 threads, Uint32 tile)
+{
+    const char * isa;
+    
+    game->format = backend->format;
+    game->computeBoardFunc = backend->compute;
+    switch (backend->setup)
+    {
+        case BENCH_SIMD:
+            game->computeRowFunc = simd_select(game->format, &isa);
+            break;
+        case BENCH_TILED:
+            game_set_block_size(game, tile);
+            break;
+        case BENCH_POOL:
+            game->pool = worker_pool_create(threads);
+            if ( ! game->pool)
+            {
+                fprintf(stderr, "Not enough memory for the worker pool\n");
+                exit(EXIT_FAILURE);
+            }
+            game->computeRowFunc = game->format == BOARD_PACKED ? board_compute_packed_thread : board_compute_thread;
+            break;
+        default:
+            break;
+    }
+}
+
+const Uint32 kAutoClasses = 4;                                 // Density classes, cut by kAutoDensity
+static const double kAutoDensity[] = { 0.005, 0.05, 0.2 };     // Living cells per cell between two classes
+static const Uint32 kAutoTiles[] = { 128, 512, 2048 };         // Tile sides tried besides the L2-sized one
+const double kAutoTrialSeconds = 0.05;                         // Each candidate runs at least that long
+
+/**
+ * A tuned configuration: a backend of kBenchBackends and its parameters
+ */
+typedef struct AutoChoice
+{
+    const BenchBackend * backend;
+    Uint32 threads;                     // OpenMP threads, or size of the worker pool
+    Uint32 tile;                        // Side of the tiles, 0 for the L2-sized ones
+    double rate;                        // Generations/sec measured, 0 when read from the profile
+} AutoChoice;
+
+/**
+ * State of --auto. Candidate backends are measured on the board itself and
+ * the fastest is kept, per host, board size, density class... in a profile
+ * file, so the next run with the same class reads it instead. Every few
+ * generations the density is checked again, and the backend is switched
+ * when it moved to another class.
+ */
+typedef struct AutoTuner
+{
+    const char * path;                  // Profile file, NULL for none
+    char host[64];
+    Uint64 every;                       // Generations between two density checks
+    Uint64 nextCheck;                   // Generation of the next one
+    int densityClass;                   // Class of the current choice, -1 before the first
+    AutoChoice choice;
+    Uint32 switches;                    // Changes of configuration after the first choice
+} AutoTuner;
+
+/**
+ * Density class of the current board
+ * @param game
+ */
+static int auto_density_class(const GameContainer * game)
+{
+    const double density = (double)board_population(game_board(game)) / ((double)game->width * game->height);
+    int i = 0;
+    
+    while (i < (int)kAutoClasses - 1 && density >= kAutoDensity[i])
+    {
+        i++;
+    }
+    return i;
+}
+
+/**
+ * Tell if a backend can run the game
+ * @param game
+ * @param backend
+ */
+static int auto_candidate(const GameContainer * game, const BenchBackend * backend)
+{
+    // Those only see a dead world beyond the edges
+    return game->topology == TOPOLOGY_DEAD ||
+           (backend->compute != board_compute_temporal && backend->compute != board_compute_active);
+}
+
+/**
+ * Profile lines are "host cores rule topology size density backend threads tile",
+ * size being the log2 of the number of cells
+ * @param tuner
+ * @param game
+ * @param densityClass
+ * @param key Receive the key, the part before the backend
+ * @param size Size of key
+ */
+static void auto_key(const AutoTuner * tuner, const GameContainer * game, int densityClass, char * key, size_t size)
+{
+    const Uint64 cells = (Uint64)game->width * game->height;
+    
+    snprintf(key, size, "%s %d %s %d %d %d", tuner->host, omp_get_num_procs(), gRule.name, (int)game->topology,
+             63 - __builtin_clzll(cells), densityClass);
+}
+
+/**
+ * Find the choice of a density class in the profile file
+ * @param tuner
+ * @param game
+ * @param densityClass
+ * @param choice Receive the choice
+ * @return Yes if the profile has one
+ */
+static int auto_profile_read(const AutoTuner * tuner, const GameContainer * game, int densityClass, AutoChoice * choice)
+{
+    char key[256], line[512], name[64];
+    size_t length;
+    FILE * file;
+    Uint32 b;
+    int found = No;
+    
+    if ( ! tuner->path || ! (file = fopen(tuner->path, "r")))
+    {
+        return No;
+    }
+    auto_key(tuner, game, densityClass, key, sizeof(key));
+    length = strlen(key);
+    // The last line of a key wins
+    while (fgets(line, sizeof(line), file))
+    {
+        if (strncmp(line, key, length) || line[length] != ' ' ||
+            sscanf(line + length, "%63s %u %u", name, &choice->threads, &choice->tile) != 3)
+        {
+            continue;
+        }
+        for (b = 0; b < sizeof(kBenchBackends) / sizeof(kBenchBackends[0]); b++)
+        {
+            if ( ! strcmp(kBenchBackends[b].name, name) && choice->threads && auto_candidate(game, &kBenchBackends[b]))
+            {
+                choice->backend = &kBenchBackends[b];
+                choice->rate = 0;
+                found = Yes;
+            }
+        }
+    }
+    fclose(file);
+    return found;
+}
+
+/**
+ * Append a choice to the profile file
+ * @param tuner
+ * @param game
+ * @param densityClass
+ * @param choice
+ */
+static void auto_profile_write(const AutoTuner * tuner, const GameContainer * game, int densityClass, const AutoChoice * choice)
+{
+    char key[256];
+    FILE * file;
+    
+    if ( ! tuner->path)
+    {
+        return;
+    }
+    file = fopen(tuner->path, "a");
+    if ( ! file)
+    {
+        fprintf(stderr, "Can't write the tuning profile %s\n", tuner->path);
+        return;
+    }
+    if ( ! ftell(file))
+    {
+        fprintf(file, "# gamelive --auto profile: host cores rule topology log2(cells) density-class backend threads tile\n");
+    }
+    auto_key(tuner, game, densityClass, key, sizeof(key));
+    fprintf(file, "%s %s %u %u\n", key, choice->backend->name, choice->threads, choice->tile);
+    fclose(file);
+}
+
+/**
+ * Measure a configuration on a copy of the board of the game
+ * @param game
+ * @param trials The scratch games, one per storage, created on first use from the game
+ * @param backend
+ * @param threads
+ * @param tile
+ * @return Generations/sec
+ */
+static double auto_trial(const GameContainer * game, GameContainer trials[2], const BenchBackend * backend, Uint32 threads, Uint32 tile)
+{
+    GameContainer * trial = &trials[backend->format];
+    double start, elapsed;
+    Uint64 first;
+    
+    if ( ! trial->arena)
+    {
+        memset(trial, 0, sizeof(GameContainer));
+        trial->width = game->width;
+        trial->height = game->height;
+        trial->topology = game->topology;
+        trial->temporalDepth = game->temporalDepth ? game->temporalDepth : kTemporalDepth;
+        trial->format = backend->format;
+        game_create_boards(trial);
+    }
+    omp_set_num_threads(threads);
+    backend_setup(trial, backend, threads, tile);
+    board_convert(game_board(trial), game_board(game));
+    trial->activityReset = Yes;
+    
+    // The first step touches what is created on first use
+    game_step(trial);
+    first = trial->generation;
+    start = get_seconds();
+    do
+    {
+        game_step(trial);
+        elapsed = get_seconds() - start;
+    }
+    while (trial->generation < first + 2 || elapsed < kAutoTrialSeconds);
+    
+    if (trial->pool)
+    {
+        worker_pool_dispose(trial->pool);
+        trial->pool = NULL;
+    }
+    return (trial->generation - first) / elapsed;
+}
+
+/**
+ * Measure the candidates on the current board: every backend with all the
+ * cores, then the thread counts of the fastest, then its tile sizes
+ * @param game
+ * @param choice Receive the fastest
+ */
+static void auto_measure(const GameContainer * game, AutoChoice * choice)
+{
+    const Uint32 cores = (Uint32)omp_get_num_procs();
+    GameContainer trials[2];
+    Uint32 b, threads, t;
+    
+    memset(trials, 0, sizeof(trials));
+    memset(choice, 0, sizeof(AutoChoice));
+    for (b = 0; b < sizeof(kBenchBackends) / sizeof(kBenchBackends[0]); b++)
+    {
+        const BenchBackend * backend = &kBenchBackends[b];
+        const Uint32 count = backend->threaded ? cores : 1;
+        double rate;
+        
+        if ( ! auto_candidate(game, backend))
+        {
+            continue;
+        }
+        rate = auto_trial(game, trials, backend, count, 0);
+        if (rate > choice->rate)
+        {
+            choice->backend = backend;
+            choice->threads = count;
+            choice->tile = 0;
+            choice->rate = rate;
+        }
+    }
+    
+    // Fewer threads may do better on a small or memory-bound board
+    for (threads = 1; choice->backend->threaded && threads < cores; threads *= 2)
+    {
+        const double rate = auto_trial(game, trials, choice->backend, threads, 0);
+        if (rate > choice->rate)
+        {
+            choice->threads = threads;
+            choice->rate = rate;
+        }
+    }
+    for (t = 0; choice->backend->setup == BENCH_TILED && t < sizeof(kAutoTiles) / sizeof(kAutoTiles[0]); t++)
+    {
+        const double rate = auto_trial(game, trials, choice->backend, choice->threads, kAutoTiles[t]);
+        if (rate > choice->rate)
+        {
+            choice->tile = kAutoTiles[t];
+            choice->rate = rate;
+        }
+    }
+    
+    game_dispose_boards(&trials[BOARD_BYTES]);
+    game_dispose_boards(&trials[BOARD_PACKED]);
+}
+
+/**
+ * Switch the game to a configuration. The boards are built again in the
+ * storage of the new backend when it differs.
+ * @param game
+ * @param choice
+ */
+static void auto_apply(GameContainer * game, const AutoChoice * choice)
+{
+    const BenchBackend * backend = choice->backend;
+    
+    if (game->pool)
+    {
+        worker_pool_dispose(game->pool);
+        game->pool = NULL;
+    }
+    // The worker pool and the single core backends leave OpenMP to the conversions and counts
+    omp_set_num_threads(backend->threaded && backend->setup != BENCH_POOL ? (int)choice->threads : omp_get_num_procs());
+    
+    if (backend->format != game->format)
+    {
+        GameContainer old = *game;
+        const Uint64 generation = game->generation;
+        
+        memset(game->boards, 0, sizeof(game->boards));
+        game->arena = NULL;
+        game->scratch = NULL;
+        game->scratchSize = 0;
+        game->tileHashes = NULL;
+        game->changedTiles = NULL;
+        game->activeList = NULL;
+        game->tilePopulation = NULL;
+        backend_setup(game, backend, choice->threads, choice->tile);
+        game_create_boards(game);
+        board_convert(game_board(game), game_board(&old));
+        game->generation = generation;
+        game_dispose_boards(&old);
+    }
+    else
+    {
+        backend_setup(game, backend, choice->threads, choice->tile);
+    }
+    // Only the active tracking keeps the tile map up to date
+    if (backend->compute != board_compute_active)
+    {
+        game->changedTiles = NULL;
+        game->activeList = NULL;
+        game->tilePopulation = NULL;
+    }
+    game->activityReset = Yes;
+    game->hashValid = No;
+}
+
+/**
+ * Create the tuner of --auto
+ * @param path Profile file, NULL for none
+ * @param every Generations between two density checks
+ */
+static void auto_create(AutoTuner * tuner, const char * path, Uint64 every)
+{
+    char * c;
+    
+    memset(tuner, 0, sizeof(AutoTuner));
+    tuner->path = path;
+    tuner->every = every;
+    tuner->densityClass = -1;
+    if (gethostname(tuner->host, sizeof(tuner->host) - 1) || ! tuner->host[0])
+    {
+        strcpy(tuner->host, "localhost");
+    }
+    // A key is made of words
+    for (c = tuner->host; *c; c++)
+    {
+        *c = isspace((unsigned char)*c) ? '_' : *c;
+    }
+}
+
+/**
+ * Check the density of the board when it is time to, and pick the backend
+ * of its class: from the profile, or measured then saved there
+ * @param tuner
+ * @param game
+ */
+static void auto_update(AutoTuner * tuner, GameContainer * game)
+{
+    int densityClass;
+    AutoChoice choice;
+    
+    if (game->generation < tuner->nextCheck)
+    {
+        return;
+    }
+    tuner->nextCheck = game->generation + tuner->every;
+    densityClass = auto_density_class(game);
+    if (densityClass == tuner->densityClass)
+    {
+        return;
+    }
+    
+    if ( ! auto_profile_read(tuner, game, densityClass, &choice))
+    {
+        auto_measure(game, &choice);
+        auto_profile_write(tuner, game, densityClass, &choice);
+    }
+    printf("Generation %llu, density class %d: %s, %u threads", (unsigned long long)game->generation, densityClass,
+           choice.backend->name, choice.threads);
+    if (choice.backend->setup == BENCH_TILED && choice.tile)
+    {
+        printf(", %ux%u tiles", choice.tile, choice.tile);
+    }
+    else if (choice.backend->setup == BENCH_TILED)
+    {
+        printf(", L2-sized tiles");
+    }
+    if (choice.rate > 0)
+    {
+        printf(" (measured, %.4g cells/sec)\n", choice.rate * game->width * game->height);
+    }
+    else
+    {
+        printf(" (from the profile)\n");
+    }
+    tuner->densityClass = densityClass;
+    if (choice.backend == tuner->choice.backend && choice.threads == tuner->choice.threads && choice.tile == tuner->choice.tile)
+    {
+        return;
+    }
+    tuner->switches += tuner->choice.backend != NULL;
+    tuner->choice = choice;
+    auto_apply(game, &choice);
+}
+
+/**
+ * Run the simulation without any window: no SDL, no font, only the compute
+ * function in a tight loop. Print the timing at the end.
+ * @param game
+ * @param generations Number of generations to compute
+ * @param seed Seed of the random board
+ * @param density Percentage of living cells at start
+ * @param detectCycle Stop at the first board seen before, by its hash
+ * @param checkpoint When to write the checkpoints, NULL for none
+ * @param recorder Where to stream the generations, NULL for nowhere
+ * @param tuner Picks the backend as the run goes (--auto), NULL to keep the one of the game
+ * @return EXIT_FAILURE if game->checkAllocations is set and a generation past the first one allocated
+ */
+static int run_headless(GameContainer * game, Uint64 generations, Uint64 seed, Uint32 density, int detectCycle, Checkpoint * checkpoint,
+                        Recorder * recorder, AutoTuner * tuner)
+{
+    double start, elapsed;
+    const double cells = (double)game_sum(game, (Uint64)game->width * game->height);
+    CycleTable cycles;
+    Uint64 initial, warm = 0, allocations = 0;
+    int status = EXIT_SUCCESS;
+    
+    game_create_boards(game);
+    game_populate(game, seed, density);
+    printf("Initial population: %llu\n", (unsigned long long)game_sum(game, board_population(game_board(game))));
+    
+    // A snapshot goes on from its own generation
+    initial = game->generation;
+    generations += initial;
+    // The first choice is not timed
+    if (tuner)
+    {
+        auto_update(tuner, game);
+    }
+    
+    memset(&cycles, 0, sizeof(CycleTable));
+    if (detectCycle)
+    {
+        // Room for every generation of the run: the table is not grown while it runs
+        Uint64 capacity = 1024;
+        while (capacity < kCycleReserve && capacity <= 2 * (generations - game->generation))
+        {
+            capacity *= 2;
+        }
+        cycle_table_grow(&cycles, capacity);
+    }
+    start = get_seconds();
+    if (checkpoint)
+    {
+        checkpoint->nextGeneration = game->generation + checkpoint->every;
+        checkpoint->nextTime = start + checkpoint->seconds;
+        checkpoint->writerGeneration = game->generation;
+    }
+    while (game->generation < generations)
+    {
+        Uint64 first;
+        
+        if (checkpoint)
+        {
+            checkpoint_update(checkpoint, game, No);
+        }
+        if (recorder)
+        {
+            recorder_update(recorder, game, No);
+        }
+        if (tuner)
+        {
+            auto_update(tuner, game);
+        }
+        if (detectCycle && cycle_table_add(&cycles, game_hash(game), game->generation, &first))
+        {
+            printf("Cycle: generation %llu repeats generation %llu (period %llu)\n", (unsigned long long)game->generation,
+                   (unsigned long long)first, (unsigned long long)(game->generation - first));
+            break;
+        }
+        // Don't let a multi-generation sweep go past the end
+        if (game->temporalDepth > generations - game->generation)
+        {
+            game->temporalDepth = (Uint32)(generations - game->generation);
+        }
+        game_step(game);
+        // The first generation may carve what is created on first use (tile map, scratch tiles, OpenMP threads...)
+        if ( ! warm)
+        {
+            warm = game->generation;
+            allocations = heap_allocations();
+        }
+    }
+    allocations = warm ? heap_allocations() - allocations : 0;
+    if (recorder)
+    {
+        recorder_update(recorder, game, Yes);
+    }
+    elapsed = get_seconds() - start;
+    free(cycles.entries);
+    if (checkpoint)
+    {
+        // The last generations would be computed again after a --resume
+        checkpoint_update(checkpoint, game, Yes);
+        checkpoint_reap(checkpoint, Yes);
+    }
+    
+    printf("Generations: %llu\n", (unsigned long long)game->generation);
+    printf("Final population: %llu\n", (unsigned long long)game_sum(game, board_population(game_board(game))));
+    if (tuner)
+    {
+        printf("Backend switches: %u\n", tuner->switches);
+    }
+    if (game->changedTiles)
+    {
+        printf("Active tiles: %llu of %llu\n", (unsigned long long)game_sum(game, game->activeCount),
+               (unsigned long long)game_sum(game, (Uint64)game->tilesX * game->tilesY));
+    }
+#ifdef COUNT_ALLOCATIONS
+    allocations = game_sum(game, allocations);
+    printf("Heap allocations: %llu in the %llu generations after the first\n", (unsigned long long)allocations,
+           (unsigned long long)(warm ? game->generation - warm : 0));
+    if (game->checkAllocations && allocations)
+    {
+        fprintf(stderr, "The generations allocated on the heap once the run was started\n");
+        status = EXIT_FAILURE;
+    }
+#endif
+    printf("Total time: %.6f s\n", elapsed);
+    if (elapsed > 0)
+    {
+        printf("Generations/sec: %.2f\n", (game->generation - initial) / elapsed);
+        printf("Cells/sec: %.4g\n", cells * (game->generation - initial) / elapsed);
+    }
+    
+    if (game->savePath && ! game_save(game, game->savePath))
+    {
+        printf("Saved generation %llu to %s\n", (unsigned long long)game->generation, game->savePath);
+    }
+    game_dispose_boards(game);
+    return status;
+}
+
+/**
+ * Pick the size of the cells and of the window. The tiles shrink until the
+ * board fits in the window, huge boards then show several cells per pixel.
+ * @param game
+ * @param width Width of the window in pixels
+ * @param height Height of the window in pixels
+ */
+static void game_fit_window(GameContainer * game, Uint32 * width, Uint32 * height)
+{
+    while (game->tileSize > 1 && (game->width * game->tileSize > kMaxWindowWidth || game->height * game->tileSize > kMaxWindowHeight))
+    {
+        game->tileSize--;
+    }
+    while (game->width > kMaxWindowWidth * game->cellsPerPixel || game->height > kMaxWindowHeight * game->cellsPerPixel)
+    {
+        game->cellsPerPixel *= 2;
+    }
+    *width = (game->width * game->tileSize + game->cellsPerPixel - 1) / game->cellsPerPixel;
+    *height = (game->height * game->tileSize + game->cellsPerPixel - 1) / game->cellsPerPixel;
+}
+
+/**
+ * Measure how the OpenMP rasterizer scales: draw the random board in an
+ * offscreen surface the size of the window, with 1 thread, then 2, 4... up
+ * to the number of cores.
+ * @param game
+ * @param frames Number of frames per measure
+ * @param seed Seed of the random board
+ * @param density Percentage of living cells
+ */
+static void run_draw_bench(GameContainer * game, Uint64 frames, Uint64 seed, Uint32 density)
+{
+    Uint32 width, height, frame;
+    int threads;
+    const int cores = omp_get_num_procs();
+    double single = 0;
+    
+    game_fit_window(game, &width, &height);
+    game_create_boards(game);
+    game_populate(game, seed, density);
+    game->screen = SDL_CreateRGBSurface(SDL_SWSURFACE, width, height, 32, 0x00FF0000, 0x0000FF00, 0x000000FF, 0);
+    if ( ! game->screen)
+    {
+        fprintf(stderr, "Can't create a %ux%u surface\n", width, height);
+        exit(EXIT_FAILURE);
+    }
+    printf("Drawing %llu frames of %ux%u pixels (%u cells per pixel, %u pixels per cell)\n",
+           (unsigned long long)frames, width, height, game->cellsPerPixel, game->tileSize);
+    
+    for (threads = 1; ; threads *= 2)
+    {
+        double start, elapsed;
+        
+        // Powers of 2, then every core
+        threads = threads < cores ? threads : cores;
+        omp_set_num_threads(threads);
+        start = get_seconds();
+        for (frame = 0; frame < frames; frame++)
+        {
+            draw_board_openmp(game);
+        }
+        elapsed = get_seconds() - start;
+        if (threads == 1)
+        {
+            single = elapsed;
+        }
+        printf("Threads: %d  Frames/sec: %.2f  Speedup: %.2f\n", threads, frames / elapsed, single / elapsed);
+        if (threads == cores)
+        {
+            break;
+        }
+    }
+    omp_set_num_threads(cores);
+    
+    SDL_FreeSurface(game->screen);
+    game->screen = NULL;
+    game_dispose_boards(game);
+}
+
+/**
+ * Starting patterns of the benchmark suite
+ */
+typedef enum BenchPattern
+{
+    BENCH_RANDOM = 0,                   // Random, at each of the requested densities
+    BENCH_R_PENTOMINO,                  // One R-pentomino in the middle: a small chaotic area growing for 1103 generations
+    BENCH_GLIDER_GUNS,                  // Gosper guns every 128 cells, their streams colliding
+    BENCH_BREEDER,                      // The --load pattern, a breeder: its population grows quadratically
+    BENCH_PATTERNS
+} BenchPattern;
+
+static const char * kBenchPatternNames[BENCH_PATTERNS] = { "random", "r-pentomino", "glider-guns", "breeder" };
+
+static const char * kRPentomino[] = {
+    ".OO",
+    "OO.",
+    ".O."
+};
+
+static const char * kGosperGun[] = {
+    "........................O...........",
+    "......................O.O...........",
+    "............OO......OO............OO",
+    "...........O...O....OO............OO",
+    "OO........O.....O...OO..............",
+    "OO........O...O.OO....O.O...........",
+    "..........O.....O.......O...........",
+    "...........O...O....................",
+    "............OO......................"
+};
+
+/**
+ * Copy a small plaintext pattern ('O' alive) on the board, clipped
+ * @param board
+ * @param rows The pattern
+ * @param count Number of rows
+ * @param x, y Position of the top left corner
+ */
+static void board_stamp(Board * board, const char ** rows, Uint32 count, Uint32 x, Uint32 y)
+{
+    Uint32 i, j;
+    
+    for (i = 0; i < count && y + i < board->height; i++)
+    {
+        for (j = 0; rows[i][j] && x + j < board->width; j++)
+        {
+            board_set_cell(board, x + j, y + i, rows[i][j] == 'O');
+        }
+    }
+}
+
+/**
+ * Fill the current board of the game with a pattern, the other boards are
+ * cleared and every active tile is computed again
+ * @param game Its loadPath is the breeder
+ * @param pattern
+ * @param seed Seed of the random pattern
+ * @param density Percentage of living cells of the random pattern
+ */
+static void bench_fill(GameContainer * game, BenchPattern pattern, Uint64 seed, Uint32 density)
+{
+    Board * board = game_board(game);
+    Uint32 x, y;
+    
+    board_reset(game);
+    switch (pattern)
+    {
+        case BENCH_RANDOM:
+            board_randomize(board, seed, density);
+            break;
+        case BENCH_R_PENTOMINO:
+            board_stamp(board, kRPentomino, 3, board->width / 2, board->height / 2);
+            break;
+        case BENCH_GLIDER_GUNS:
+            for (y = 0; y + 9 <= board->height; y += 128)
+            {
+                for (x = 0; x + 36 <= board->width; x += 128)
+                {
+                    board_stamp(board, kGosperGun, 9, x, y);
+                }
+            }
+            break;
+        default:
+            game_load(game, game->loadPath);
+            break;
+    }
+}
+
+/**
+ * Run one backend on one board with a given number of threads: a warmup
+ * run, then the trials, each from the same starting board. Prints one CSV line.
+ * @param backend
+ * @param width, height Board size
+ * @param pattern
+ * @param threads
+ * @param trials
+ * @param seed, density Random pattern, the density is only printed for it
+ * @param breeder Pattern or snapshot file of the breeder
+ * @param single Generations/sec of the same run with 1 thread, 0 if unknown
+ * @return Generations/sec (median of the trials)
+ */
+static double bench_run(const BenchBackend * backend, Uint32 width, Uint32 height, BenchPattern pattern,
+                        Uint32 threads, Uint32 trials, Uint64 seed, Uint32 density, const char * breeder, double single)
+{
+    GameContainer game;
+    const double cells = (double)width * height;
+    // About 2e8 cell updates per trial, at least 2 generations. Every backend
+    // runs whole temporal blocks, so the final populations can be compared.
+    Uint64 generations = (Uint64)(2e8 / cells) > 2 ? (Uint64)(2e8 / cells) : 2;
+    double rates[16];
+    Uint32 trial, i;
+    
+    memset(&game, 0, sizeof(GameContainer));
+    game.width = width;
+    game.height = height;
+    game.temporalDepth = kTemporalDepth;
+    game.loadPath = breeder;
+    backend_setup(&game, backend, threads, 0);
+    game_create_boards(&game);
+    omp_set_num_threads(threads);
+    generations = (generations + game.temporalDepth - 1) / game.temporalDepth * game.temporalDepth;
+    
+    trials = trials < 16 ? trials : 16;
+    for (trial = 0; trial <= trials; trial++)
+    {
+        // Trial 0 is the warmup: page faults, caches, frequency
+        const Uint64 count = trial ? generations : (generations + 3) / 4;
+        double start;
+        
+        bench_fill(&game, pattern, seed, density);
+        game.generation = 0;
+        start = get_seconds();
+        while (game.generation < count)
+        {
+            game_step(&game);
+        }
+        if (trial)
+        {
+            rates[trial - 1] = game.generation / (get_seconds() - start);
+        }
+    }
+    
+    // Median of the trials
+    for (trial = 1; trial < trials; trial++)
+    {
+        for (i = trial; i > 0 && rates[i - 1] > rates[i]; i--)
+        {
+            const double t = rates[i];
+            rates[i] = rates[i - 1];
+            rates[i - 1] = t;
+        }
+    }
+    
+    {
+        const double rate = rates[trials / 2];
+        // Traffic model: the current board is read and the next one written once per sweep
+        const double bytes = 2.0 * game_board(&game)->stride * height / cells /
+                             (backend->compute == board_compute_temporal ? game.temporalDepth : 1);
+        char percent[16] = "";
+        if (pattern == BENCH_RANDOM)
+        {
+            sprintf(percent, "%u", density);
+        }
+        printf("%s,%u,%u,%u,%s,%s,%llu,%u,%.2f,%.4g,%.4f,%.2f,%llu\n", backend->name, threads, width, height,
+               kBenchPatternNames[pattern], percent, (unsigned long long)game.generation, trials, rate, rate * cells,
+               bytes, single > 0 ? rate / single : 1.0, (unsigned long long)board_population(game_board(&game)));
+        fflush(stdout);
+        
+        if (game.pool)
+        {
+            worker_pool_dispose(game.pool);
+        }
+        game_dispose_boards(&game);
+        return rate;
+    }
+}
+
+/**
+ * Run the benchmark suite: every backend whose name contains filter, on
+ * every size and pattern (the random one at every density), with 1 thread
+ * then 2, 4... up to one per core for the threaded ones. The results go to
+ * stdout as CSV, one line per run.
+ * @param sizes Board sides
+ * @param sizeCount
+ * @param densities Percentages of living cells of the random pattern
+ * @param densityCount
+ * @param filter Only the backends whose name contains it, NULL for all
+ * @param trials Number of measured runs (the median is kept)
+ * @param seed Random pattern
+ * @param breeder Pattern or snapshot file of the breeder, NULL to leave it out
+ */
+static void run_bench(const Uint32 * sizes, Uint32 sizeCount, const Uint32 * densities, Uint32 densityCount,
+                      const char * filter, Uint32 trials, Uint64 seed, const char * breeder)
+{
+    const int cores = omp_get_num_procs();
+    Uint32 b, size, d;
+    int pattern;
+    
+    printf("backend,threads,width,height,pattern,density,generations,trials,generations_per_sec,cells_per_sec,bytes_per_cell_update,speedup,population\n");
+    for (b = 0; b < sizeof(kBenchBackends) / sizeof(kBenchBackends[0]); b++)
+    {
+        const BenchBackend * backend = &kBenchBackends[b];
+        if (filter && ! strstr(backend->name, filter))
+        {
+            continue;
+        }
+        for (size = 0; size < sizeCount; size++)
+        {
+            // The breeder comes last, left out without a pattern file
+            for (pattern = 0; pattern < BENCH_PATTERNS && (pattern != BENCH_BREEDER || breeder); pattern++)
+            {
+                for (d = 0; d < (pattern == BENCH_RANDOM ? densityCount : 1); d++)
+                {
+                    int threads;
+                    double single = 0;
+                    for (threads = 1; ; threads *= 2)
+                    {
+                        threads = threads < cores ? threads : cores;
+                        if (threads == 1)
+                        {
+                            single = bench_run(backend, sizes[size], sizes[size], pattern, 1, trials, seed, densities[d], breeder, 0);
+                        }
+                        else
+                        {
+                            bench_run(backend, sizes[size], sizes[size], pattern, threads, trials, seed, densities[d], breeder, single);
+                        }
+                        if ( ! backend->threaded || threads == cores)
+                        {
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+    }
+    omp_set_num_threads(cores);
+}
+
+/**
+ * Set the OpenMP schedule used by the tiled scheduler
+ * @param str "static", "dynamic" or "guided", optionally followed by ",chunk"
+ * @return 1 if the argument is valid, 0 otherwise
+ */
+static int parse_schedule(const char * str)
+{
+    omp_sched_t kind;
+    const char * comma = strchr(str, ',');
+    const size_t length = comma ? (size_t)(comma - str) : strlen(str);
+    int chunk = 0;
+
+    if (length == 6 && ! strncmp(str, "static", 6))
+    {
+        kind = omp_sched_static;
+    }
+    else if (length == 7 && ! strncmp(str, "dynamic", 7))
+    {
+        kind = omp_sched_dynamic;
+    }
+    else if (length == 6 && ! strncmp(str, "guided", 6))
+    {
+        kind = omp_sched_guided;
+    }
+    else
+    {
+        return No;
+    }
+
+    if (comma)
+    {
+        char * end = NULL;
+        chunk = (int)strtol(comma + 1, &end, 10);
+        if (end == comma + 1 || *end != '\0' || chunk <= 0)
+        {
+            return No;
+        }
+    }
+
+    omp_set_schedule(kind, chunk);
+    return Yes;
+}
+
+/**
+ * Run HashLife without any window. The --load file or the random board is
+ * loaded in an unbounded universe. Unlike the dense compute functions
+ * nothing dies at the border of the board.
+ * @param game
+ * @param generations Number of generations to compute
+ * @param seed Seed of the random board
+ * @param density Percentage of living cells at start
+ * @param memoryCap Bytes of nodes kept before collecting the garbage
+ */
+static void run_hashlife(GameContainer * game, Uint64 generations, Uint64 seed, Uint32 density, size_t memoryCap)
+{
+    HashLife life;
+    double start, elapsed;
+    
+    if (game->loadPath)
+    {
+        hashlife_load(&life, game->loadPath, memoryCap);
+    }
+    else
+    {
+        game_create_boards(game);
+        board_randomize(game_board(game), seed, density);
+        hashlife_create(&life, game_board(game), memoryCap);
+        game_dispose_boards(game);
+    }
+    printf("Initial population: %llu\n", (unsigned long long)life.root->population);
+    
+    start = get_seconds();
+    hashlife_advance(&life, generations);
+    elapsed = get_seconds() - start;
+    
+    printf("Generations: %llu\n", (unsigned long long)life.generation);
+    printf("Final population: %llu\n", (unsigned long long)life.root->population);
+    printf("Total time: %.6f s\n", elapsed);
+    printf("Nodes: %llu (%.1f MB), %u garbage collections\n", (unsigned long long)life.nodeCount,
+           life.nodeCount * sizeof(LifeNode) / (1024.0 * 1024.0), life.collections);
+    if (elapsed > 0)
+    {
+        printf("Generations/sec: %.4g\n", generations / elapsed);
+    }
+    
+    hashlife_dispose(&life);
+}
+
+/**
+ * Run the sparse universe without any window. As with HashLife the random
+ * board is loaded in an unbounded universe.
+ * @param game
+ * @param generations Number of generations to compute
+ * @param seed Seed of the random board
+ * @param density Percentage of living cells at start
+ */
+static void run_sparse(GameContainer * game, Uint64 generations, Uint64 seed, Uint32 density)
+{
+    Sparse sparse;
+    double start, elapsed;
+    
+    sparse_create(&sparse);
+    if (game->loadPath)
+    {
+        sparse_load(&sparse, game->loadPath);
+    }
+    else
+    {
+        game_create_boards(game);
+        board_randomize(game_board(game), seed, density);
+        sparse_load_board(&sparse, game_board(game));
+        game_dispose_boards(game);
+    }
+    printf("Initial population: %llu\n", (unsigned long long)sparse_population(&sparse));
+    generations += sparse.generation;
+    
+    start = get_seconds();
+    while (sparse.generation < generations)
+    {
+        sparse_step(&sparse);
+    }
+    elapsed = get_seconds() - start;
+    
+    printf("Generations: %llu\n", (unsigned long long)sparse.generation);
+    printf("Final population: %llu\n", (unsigned long long)sparse_population(&sparse));
+    printf("Total time: %.6f s\n", elapsed);
+    printf("Chunks: %u (%.1f MB in the pool)\n", sparse.chunkCount,
+           sparse.blockCount * kChunkBlock * sizeof(Chunk) / (1024.0 * 1024.0));
+    if (elapsed > 0)
+    {
+        printf("Generations/sec: %.2f\n", sparse.generation / elapsed);
+    }
+    
+    sparse_dispose(&sparse);
+}
+
+/*
+ * Ensemble runs: many small independent boards, as for a parameter sweep or
+ * a soup search. The boards are stepped 64 at a time, in the bit lanes of a
+ * single grid of words: bit k of a cell belongs to board k, so the adders of
+ * rule_packed_word step the 64 boards at once, with no shift since the
+ * neighbours of a cell are the words around it.
+ */
+const Uint32 kEnsembleLanes = 64;       // Boards per batch, one per bit of a word
+const Uint32 kEnsemblePeriods = 6;      // Longest cycle found: still lifes and oscillators up to period 6
+
+/**
+ * What is left of a board of the ensemble
+ */
+typedef struct EnsembleResult
+{
+    Uint64 population;                  // At the stabilisation, or at the last generation
+    Uint64 hash;                        // Same as board_hash of that generation
+    Uint64 stabilised;                  // First generation of its cycle
+    Uint32 period;                      // 0 if still changing at the last generation
+} EnsembleResult;
+
+/**
+ * The batches left to a thread of the ensemble, stolen from by the others
+ */
+typedef struct EnsembleQueue
+{
+    Uint64 range;                       // First batch left in the low 32 bits, end in the high ones
+    Uint8 padding[56];                  // One queue per cache line
+} EnsembleQueue;
+
+/**
+ * An ensemble run: boards of the same size, board i from seed + i
+ */
+typedef struct Ensemble
+{
+    Uint32 width, height;               // Size of every board
+    Uint32 stride;                      // Words between two rows of a grid, the halo included
+    size_t gridWords;                   // Words of a grid, the halo rows included
+    Topology topology;
+    Uint32 count;                       // Number of boards
+    Uint32 batches;                     // Batches of kEnsembleLanes boards
+    Uint64 seed;                        // Seed of board 0
+    Uint32 density;
+    Uint64 generations;                 // Last generation computed
+    Uint64 steps;                       // Board generations computed, the stabilised boards of a batch included
+    int threads;
+    EnsembleQueue * queues;             // One per thread
+    Uint64 * rings;                     // kEnsemblePeriods + 1 grids per thread
+    EnsembleResult * results;           // One per board
+    Arena * arena;                      // Everything above
+} Ensemble;
+
+/**
+ * Fill each lane of a grid with the random board of its seed. The cells are
+ * drawn in the order of board_randomize, so lane k holds the board a
+ * single run with --seed (first + k) starts from.
+ * @param ens
+ * @param grid
+ * @param first First board of the batch
+ */
+static void ensemble_fill(const Ensemble * ens, Uint64 * grid, Uint32 first)
+{
+    const Uint64 threshold = (Uint64)ens->density * (0xFFFFFFFFULL / 100);
+    Uint32 lane, x, y;
+
+    memset(grid, 0, ens->gridWords * sizeof(Uint64));
+    for (lane = 0; lane < kEnsembleLanes && first + lane < ens->count; lane++)
+    {
+        Uint64 state = (ens->seed + first + lane) * 0x9E3779B97F4A7C15ULL + 1;
+        for (y = 0; y < ens->height; y++)
+        {
+            Uint64 * row = grid + (size_t)(y + 1) * ens->stride + 1;
+            for (x = 0; x < ens->width; x++)
+            {
+                row[x] |= (Uint64)((random_next(&state) >> 32) < threshold) << lane;
+            }
+        }
+    }
+}
+
+/**
+ * Cell of a grid, the halo included (-1 to width, -1 to height)
+ */
+static inline Uint64 * ensemble_cell(const Ensemble * ens, Uint64 * grid, int x, int y)
+{
+    return grid + (ptrdiff_t)(y + 1) * ens->stride + x + 1;
+}
+
+/**
+ * Surround the boards of a grid with what lies beyond their edges, as
+ * board_fill_halo does for a single board
+ * @param ens
+ * @param grid
+ */
+static void ensemble_fill_halo(const Ensemble * ens, Uint64 * grid)
+{
+    const int width = (int)ens->width;
+    const int height = (int)ens->height;
+    int x, y;
+
+    if (ens->topology == TOPOLOGY_DEAD)
+    {
+        return;
+    }
+    // The columns first: the halo rows then bring the corners with them
+    for (y = 0; y < height; y++)
+    {
+        *ensemble_cell(ens, grid, -1, y) = ens->topology == TOPOLOGY_ALIVE ? ~0ULL : *ensemble_cell(ens, grid, width - 1, y);
+        *ensemble_cell(ens, grid, width, y) = ens->topology == TOPOLOGY_ALIVE ? ~0ULL : *ensemble_cell(ens, grid, 0, y);
+    }
+    for (x = -1; x <= width; x++)
+    {
+        switch (ens->topology)
+        {
+            case TOPOLOGY_TORUS:
+                *ensemble_cell(ens, grid, x, -1) = *ensemble_cell(ens, grid, x, height - 1);
+                *ensemble_cell(ens, grid, x, height) = *ensemble_cell(ens, grid, x, 0);
+                break;
+            case TOPOLOGY_KLEIN:
+                *ensemble_cell(ens, grid, x, -1) = *ensemble_cell(ens, grid, width - 1 - x, height - 1);
+                *ensemble_cell(ens, grid, x, height) = *ensemble_cell(ens, grid, width - 1 - x, 0);
+                break;
+            default:
+                *ensemble_cell(ens, grid, x, -1) = ~0ULL;
+                *ensemble_cell(ens, grid, x, height) = ~0ULL;
+                break;
+        }
+    }
+}
+
+/**
+ * Compute the next generation of the 64 boards of a grid
+ * @param ens
+ * @param current
+ * @param next Its halo is left as it is
+ */
+static void ensemble_step(const Ensemble * ens, Uint64 * current, Uint64 * next)
+{
+    const int width = (int)ens->width;
+    int x, y;
+
+    ensemble_fill_halo(ens, current);
+    for (y = 0; y < (int)ens->height; y++)
+    {
+        const Uint64 * above = ensemble_cell(ens, current, 0, y - 1);
+        const Uint64 * center = above + ens->stride;
+        const Uint64 * below = center + ens->stride;
+        Uint64 * result = ensemble_cell(ens, next, 0, y);
+        for (x = 0; x < width; x++)
+        {
+            result[x] = rule_packed_word(above[x - 1], above[x], above[x + 1], center[x - 1], center[x], center[x + 1],
+                                         below[x - 1], below[x], below[x + 1]);
+        }
+    }
+}
+
+/**
+ * The lanes in which two grids differ
+ * @param ens
+ * @param a, b
+ * @param pending Lanes looked at: the comparison ends once they all differ
+ * @return A bit set for each lane which differs
+ */
+static Uint64 ensemble_differ(const Ensemble * ens, Uint64 * a, Uint64 * b, Uint64 pending)
+{
+    Uint64 differ = 0;
+    Uint32 x, y;
+
+    for (y = 0; y < ens->height && (differ & pending) != pending; y++)
+    {
+        const Uint64 * rowA = ensemble_cell(ens, a, 0, (int)y);
+        const Uint64 * rowB = ensemble_cell(ens, b, 0, (int)y);
+        for (x = 0; x < ens->width; x++)
+        {
+            differ |= rowA[x] ^ rowB[x];
+        }
+    }
+    return differ;
+}
+
+/**
+ * Fill the result of the board in a lane of a grid. The hash is the one of
+ * board_hash: the 64 cells of a tile row are gathered from the lane.
+ * @param ens
+ * @param grid
+ * @param lane
+ * @param result
+ */
+static void ensemble_lane_result(const Ensemble * ens, Uint64 * grid, Uint32 lane, EnsembleResult * result)
+{
+    Uint32 tx, ty, x, y;
+
+    result->population = 0;
+    result->hash = 0;
+    for (ty = 0; ty * kActiveTileSize < ens->height; ty++)
+    {
+        for (tx = 0; tx * kActiveTileSize < ens->width; tx++)
+        {
+            const Uint32 right = (tx + 1) * kActiveTileSize < ens->width ? (tx + 1) * kActiveTileSize : ens->width;
+            const Uint32 bottom = (ty + 1) * kActiveTileSize < ens->height ? (ty + 1) * kActiveTileSize : ens->height;
+            Uint64 hash = hash_mix((Uint64)ty << 32 | tx);
+            for (y = ty * kActiveTileSize; y < bottom; y++)
+            {
+                const Uint64 * row = ensemble_cell(ens, grid, 0, (int)y);
+                Uint64 bits = 0;
+                for (x = tx * kActiveTileSize; x < right; x++)
+                {
+                    bits |= ((row[x] >> lane) & 1) << (x - tx * kActiveTileSize);
+                }
+                result->population += __builtin_popcountll(bits);
+                hash = hash_mix(hash ^ bits);
+            }
+            result->hash += hash;
+        }
+    }
+}
+
+/**
+ * Run a batch of 64 boards until each one stabilised, or up to the last
+ * generation. The thread keeps the last kEnsemblePeriods generations in its
+ * ring: a board which is the same as p generations ago has entered a cycle of
+ * period p, and the first time it happens is where the cycle starts.
+ * @param ens
+ * @param ring The grids of the thread
+ * @param batch
+ */
+static void ensemble_run_batch(Ensemble * ens, Uint64 * ring, Uint32 batch)
+{
+    const Uint32 first = batch * kEnsembleLanes;
+    const Uint32 lanes = ens->count - first < kEnsembleLanes ? ens->count - first : kEnsembleLanes;
+    const Uint32 slots = kEnsemblePeriods + 1;
+    Uint64 pending = lanes == 64 ? ~0ULL : (1ULL << lanes) - 1;
+    Uint64 generation = 0;
+    Uint32 lane, p;
+
+    ensemble_fill(ens, ring, first);
+    while (pending && generation < ens->generations)
+    {
+        Uint64 * next = ring + (generation + 1) % slots * ens->gridWords;
+        ensemble_step(ens, ring + generation % slots * ens->gridWords, next);
+        generation++;
+
+        for (p = 1; p <= kEnsemblePeriods && p <= generation && pending; p++)
+        {
+            const Uint64 settled = pending & ~ensemble_differ(ens, next, ring + (generation - p) % slots * ens->gridWords, pending);
+            for (lane = 0; lane < lanes; lane++)
+            {
+                if (settled >> lane & 1)
+                {
+                    EnsembleResult * result = &ens->results[first + lane];
+                    ensemble_lane_result(ens, next, lane, result);
+                    result->stabilised = generation - p;
+                    result->period = p;
+                }
+            }
+            pending &= ~settled;
+        }
+    }
+    // Still changing at the last generation
+    for (lane = 0; lane < lanes; lane++)
+    {
+        if (pending >> lane & 1)
+        {
+            EnsembleResult * result = &ens->results[first + lane];
+            ensemble_lane_result(ens, ring + generation % slots * ens->gridWords, lane, result);
+            result->stabilised = generation;
+            result->period = 0;
+        }
+    }
+    __atomic_fetch_add(&ens->steps, generation * lanes, __ATOMIC_RELAXED);
+}
+
+/**
+ * Take the next batch of a thread: the front of its own range, or else the
+ * back half of the range of another thread
+ * @param ens
+ * @param self The thread
+ * @param batch The batch taken
+ * @return 0 once no batch is left
+ */
+static int ensemble_take(Ensemble * ens, int self, Uint32 * batch)
+{
+    EnsembleQueue * own = &ens->queues[self];
+    Uint64 range = __atomic_load_n(&own->range, __ATOMIC_ACQUIRE);
+    int i;
+
+    while ((Uint32)range < (Uint32)(range >> 32))
+    {
+        if (__atomic_compare_exchange_n(&own->range, &range, range + 1, No, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+        {
+            *batch = (Uint32)range;
+            return Yes;
+        }
+    }
+    for (i = 1; i < ens->threads; i++)
+    {
+        EnsembleQueue * victim = &ens->queues[(self + i) % ens->threads];
+        range = __atomic_load_n(&victim->range, __ATOMIC_ACQUIRE);
+        while ((Uint32)range < (Uint32)(range >> 32))
+        {
+            const Uint32 begin = (Uint32)range;
+            const Uint32 end = (Uint32)(range >> 32);
+            const Uint32 split = end - (end - begin + 1) / 2;
+            if (__atomic_compare_exchange_n(&victim->range, &range, (Uint64)split << 32 | begin, No,
+                                            __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+            {
+                // Nobody steals from an empty range: the thread is alone to refill its own
+                *batch = split;
+                __atomic_store_n(&own->range, (Uint64)end << 32 | (split + 1), __ATOMIC_RELEASE);
+                return Yes;
+            }
+        }
+    }
+    return No;
+}
+
+/**
+ * Run an ensemble of random boards without any window. Each board gets its
+ * final population, where it stabilised and its hash, written as CSV; when
+ * the CSV goes to stdout the rest goes to stderr.
+ * @param game The size and the topology of the boards
+ * @param count Number of boards
+ * @param generations Last generation computed
+ * @param seed Seed of the first board, the next ones follow
+ * @param density Percentage of living cells at start
+ * @param csvPath Where the results go, stdout if NULL
+ * @return EXIT_SUCCESS, or EXIT_FAILURE if the results can't be written
+ */
+static int run_ensemble(const GameContainer * game, Uint32 count, Uint64 generations, Uint64 seed, Uint32 density, const char * csvPath)
+{
+    Ensemble ens;
+    FILE * csv = csvPath ? fopen(csvPath, "w") : stdout;
+    FILE * log = csvPath ? stdout : stderr;
+    Uint64 stable = 0;
+    double start, elapsed;
+    Uint32 i;
+    int t;
+
+    if ( ! csv)
+    {
+        fprintf(stderr, "Can't write %s: %s\n", csvPath, strerror(errno));
+        return (EXIT_FAILURE);
+    }
+    memset(&ens, 0, sizeof(Ensemble));
+    ens.width = game->width;
+    ens.height = game->height;
+    ens.stride = game->width + 2;
+    ens.gridWords = (size_t)ens.stride * (game->height + 2);
+    ens.topology = game->topology;
+    ens.count = count;
+    ens.batches = (count + kEnsembleLanes - 1) / kEnsembleLanes;
+    ens.seed = seed;
+    ens.density = density;
+    ens.generations = generations;
+    ens.threads = omp_get_max_threads();
+    ens.arena = arena_create(ens.threads * (sizeof(EnsembleQueue) + (kEnsemblePeriods + 1) * ens.gridWords * sizeof(Uint64)) +
+                             count * sizeof(EnsembleResult) + 3 * kBoardAlignment);
+    ens.queues = ens.arena ? (EnsembleQueue *)arena_alloc(ens.arena, ens.threads * sizeof(EnsembleQueue)) : NULL;
+    ens.rings = ens.arena ? (Uint64 *)arena_alloc(ens.arena, ens.threads * (kEnsemblePeriods + 1) * ens.gridWords * sizeof(Uint64)) : NULL;
+    ens.results = ens.arena ? (EnsembleResult *)arena_alloc(ens.arena, count * sizeof(EnsembleResult)) : NULL;
+    if ( ! ens.queues || ! ens.rings || ! ens.results)
+    {
+        fprintf(stderr, "Not enough memory for %u boards of %ux%u on %d threads\n", count, ens.width, ens.height, ens.threads);
+        exit(EXIT_FAILURE);
+    }
+
+    // Each thread starts with its share of the batches
+    for (t = 0; t < ens.threads; t++)
+    {
+        const Uint64 begin = (Uint64)ens.batches * t / ens.threads;
+        const Uint64 end = (Uint64)ens.batches * (t + 1) / ens.threads;
+        ens.queues[t].range = end << 32 | begin;
+    }
+    fprintf(log, "Rule %s, ensemble of %u boards of %ux%u, %u batches of %u on %d threads\n", gRule.name, count, ens.width, ens.height,
+            ens.batches, kEnsembleLanes, ens.threads);
+
+    start = get_seconds();
+    #pragma omp parallel
+    {
+        const int self = omp_get_thread_num();
+        Uint64 * ring = ens.rings + (size_t)self * (kEnsemblePeriods + 1) * ens.gridWords;
+        Uint32 batch;
+        while (ensemble_take(&ens, self, &batch))
+        {
+            ensemble_run_batch(&ens, ring, batch);
+        }
+    }
+    elapsed = get_seconds() - start;
+
+    fprintf(csv, "board,seed,population,stabilised,period,hash\n");
+    for (i = 0; i < count; i++)
+    {
+        const EnsembleResult * result = &ens.results[i];
+        stable += result->period != 0;
+        fprintf(csv, "%u,%llu,%llu,%llu,%u,%016llx\n", i, (unsigned long long)(seed + i), (unsigned long long)result->population,
+                (unsigned long long)result->stabilised, result->period, (unsigned long long)result->hash);
+    }
+    if (csvPath && fclose(csv))
+    {
+        fprintf(stderr, "Can't write %s: %s\n", csvPath, strerror(errno));
+        arena_dispose(ens.arena);
+        return (EXIT_FAILURE);
+    }
+
+    fprintf(log, "Stabilised: %llu of %u boards within %llu generations\n", (unsigned long long)stable, count, (unsigned long long)generations);
+    fprintf(log, "Total time: %.6f s\n", elapsed);
+    if (elapsed > 0)
+    {
+        fprintf(log, "Board generations/sec: %.4g\n", ens.steps / elapsed);
+        fprintf(log, "Cells/sec: %.4g\n", (double)ens.steps * ens.width * ens.height / elapsed);
+    }
+    arena_dispose(ens.arena);
+    return (EXIT_SUCCESS);
+}
+
+/**
+ * Read a number from the command line
+ * @param str The argument
+ * @param value The parsed value
+ * @return 1 if the argument is valid, 0 otherwise
+ */
+static int parse_count(const char * str, Uint64 * value)
+{
+    char * end = NULL;
+    unsigned long long result = strtoull(str, &end, 10);
+    
+    if (end == str || *end != '\0' || *str == '-')
+    {
+        return No;
+    }
+    *value = (Uint64)result;
+    return Yes;
+}
+
+/**
+ * Read a comma separated list of board sides from the command line
+ * @param str The argument
+ * @param sizes The parsed sides
+ * @param count In: room in sizes, out: number of sides
+ * @return 1 if the argument is valid, 0 otherwise
+ */
+static int parse_sizes(const char * str, Uint32 * sizes, Uint32 * count)
+{
+    Uint32 n = 0;
+    
+    while (*str && n < *count)
+    {
+        char * end = NULL;
+        unsigned long result = strtoul(str, &end, 10);
+        
+        if (end == str || (*end != ',' && *end != '\0') || result == 0 || result > 0xFFFFFF)
+        {
+            return No;
+        }
+        sizes[n++] = (Uint32)result;
+        str = *end ? end + 1 : end;
+    }
+    *count = n;
+    return n > 0 && ! *str;
+}
+
+/**
+ * Read a strictly positive number from the command line
+ * @param str The argument
+ * @param value The parsed value
+ * @return 1 if the argument is valid, 0 otherwise
+ */
+static int parse_dimension(const char * str, Uint32 * value)
+{
+    char * end = NULL;
+    unsigned long result = strtoul(str, &end, 10);
+    
+    if (end == str || *end != '\0' || result == 0 || result > 0xFFFFFF)
+    {
+        return No;
+    }
+    *value = (Uint32)result;
+    return Yes;
+}
+
+/*
+ * Entry point
+ */
+int main(int argc, char** argv) 
+{
+    GameContainer game;
+    const char * mode = NULL;
+    int headless = No;
+    int drawBench = No;
+    Uint32 windowWidth, windowHeight;
+    Uint64 generations = 1000;
+    Uint64 seed = 1;
+    Uint32 density = 50;
+    Uint32 block = 0;
+    Uint32 threads = 0;
+    Uint32 memory = 1024;
+    int hashlife = No;
+    int sparse = No;
+    int bench = No;
+    int verify = No;
+    int status = EXIT_SUCCESS;
+    int detectCycle = No;
+    int specialized;
+    int mpiRun = No;
+    Uint64 mpiRebalance = 0;
+    int autoTune = No;
+    Uint64 autoEvery = 1000;
+    const char * autoProfile = NULL;
+    Uint32 ensemble = 0;
+    const char * ensembleCsv = NULL;
+    const char * metricsAddress = NULL;
+    char autoPath[4096];
+    AutoTuner tuner;
+    Uint32 verifySeeds = 4;
+    Checkpoint checkpoint;
+    int resume = No;
+    const char * recordPath = NULL;
+    RecordFormat recordFormat = RECORD_DELTA;
+    Uint64 recordEvery = 1;
+    Uint32 benchSizes[16] = { 256, 1024, 4096, 8192 };
+    Uint32 benchSizeCount = 4;
+    Uint32 benchDensities[16] = { 10, 30, 50 };
+    Uint32 benchDensityCount = 3;
+    Uint32 benchTrials = 3;
+    const char * benchFilter = NULL;
+    int i;
+    
+    memset(&game, 0, sizeof(GameContainer));
+    memset(&checkpoint, 0, sizeof(Checkpoint));
+    game.computeBoardFunc = board_compute;
+    game.drawBoardFunc = draw_board;
+    game.width = kDefaultBoardWidth;
+    game.height = kDefaultBoardHeight;
+    game.tileSize = kTileSize;
+    game.cellsPerPixel = 1;
+    game.temporalDepth = kTemporalDepth;
+    omp_set_schedule(omp_sched_static, 0);
+    rule_parse("B3/S23", &gRule);
+    
+    for (i = 1; i < argc; i++)
+    {
+        if ( ! strcmp(argv[i], "--openmp") || ! strcmp(argv[i], "--thread") || ! strcmp(argv[i], "--opengl") || ! strcmp(argv[i], "--simd") || ! strcmp(argv[i], "--tiled") ||
+            ! strcmp(argv[i], "--temporal") || ! strcmp(argv[i], "--active"))
+        {
+            if (mode)
+            {
+                fprintf(stderr, "Only one of --openmp, --simd, --tiled, --temporal, --active, --thread or --opengl may be used\n");
+                return (EXIT_FAILURE);
+            }
+            mode = argv[i];
+        }
+        else if ( ! strcmp(argv[i], "--packed"))
+        {
+            game.format = BOARD_PACKED;
+        }
+        else if ( ! strcmp(argv[i], "--rule") && i + 1 < argc)
+        {
+            if ( ! rule_parse(argv[++i], &gRule))
+            {
+                fprintf(stderr, "Invalid rule: %s (B3/S23, B2/S345/C4 or R5,C0,M1,S34..58,B34..45,NM without B0)\n", argv[i]);
+                return (EXIT_FAILURE);
+            }
+        }
+        else if ( ! strcmp(argv[i], "--topology") && i + 1 < argc)
+        {
+            static const char * names[] = { "dead", "torus", "klein", "alive" };
+            Uint32 t;
+            i++;
+            for (t = 0; t < sizeof(names) / sizeof(names[0]) && strcmp(argv[i], names[t]); t++);
+            if (t == sizeof(names) / sizeof(names[0]))
+            {
+                fprintf(stderr, "Invalid topology: %s (dead, torus, klein or alive)\n", argv[i]);
+                return (EXIT_FAILURE);
+            }
+            game.topology = (Topology)t;
+        }
+        else if ( ! strcmp(argv[i], "--schedule") && i + 1 < argc)
+        {
+            if ( ! parse_schedule(argv[++i]))
+            {
+                fprintf(stderr, "Invalid schedule: %s (static, dynamic or guided[,chunk])\n", argv[i]);
+                return (EXIT_FAILURE);
+            }
+        }
+        else if ( ! strcmp(argv[i], "--tile") && i + 1 < argc)
+        {
+            if ( ! parse_dimension(argv[++i], &block))
+            {
+                fprintf(stderr, "Invalid tile size: %s\n", argv[i]);
+                return (EXIT_FAILURE);
+            }
+        }
+        else if ( ! strcmp(argv[i], "--depth") && i + 1 < argc)
+        {
+            if ( ! parse_dimension(argv[++i], &game.temporalDepth))
+            {
+                fprintf(stderr, "Invalid depth: %s\n", argv[i]);
+                return (EXIT_FAILURE);
+            }
+        }
+        else if ( ! strcmp(argv[i], "--threads") && i + 1 < argc)
+        {
+            if ( ! parse_dimension(argv[++i], &threads))
+            {
+                fprintf(stderr, "Invalid number of threads: %s\n", argv[i]);
+                return (EXIT_FAILURE);
+            }
+        }
+        else if ( ! strcmp(argv[i], "--sim-thread"))
+        {
+            game.simulationThread = Yes;
+        }
+        else if ( ! strcmp(argv[i], "--rate") && i + 1 < argc)
+        {
+            Uint64 rate;
+            if ( ! parse_count(argv[++i], &rate))
+            {
+                fprintf(stderr, "Invalid number of generations per second: %s\n", argv[i]);
+                return (EXIT_FAILURE);
+            }
+            game.targetRate = (double)rate;
+            game.simulationThread = Yes;
+        }
+        else if ( ! strcmp(argv[i], "--hashlife"))
+        {
+            hashlife = Yes;
+        }
+        else if ( ! strcmp(argv[i], "--sparse"))
+        {
+            sparse = Yes;
+        }
+        else if ( ! strcmp(argv[i], "--jump") && i + 1 < argc)
+        {
+            Uint32 jump;
+            // The jump expands the root to level K + 4
+            if ( ! parse_dimension(argv[++i], &jump) || jump + 4 > LIFE_MAX_LEVEL)
+            {
+                fprintf(stderr, "Invalid jump: %s (generations = 2^K with K <= %d)\n", argv[i], LIFE_MAX_LEVEL - 4);
+                return (EXIT_FAILURE);
+            }
+            generations = (Uint64)1 << jump;
+        }
+        else if ( ! strcmp(argv[i], "--memory") && i + 1 < argc)
+        {
+            if ( ! parse_dimension(argv[++i], &memory))
+            {
+                fprintf(stderr, "Invalid memory cap: %s\n", argv[i]);
+                return (EXIT_FAILURE);
+            }
+        }
+        else if ( ! strcmp(argv[i], "--headless"))
+        {
+            headless = Yes;
+        }
+        else if ( ! strcmp(argv[i], "--draw-bench"))
+        {
+            drawBench = Yes;
+        }
+        else if ( ! strcmp(argv[i], "--bench"))
+        {
+            bench = Yes;
+        }
+        else if ( ! strcmp(argv[i], "--verify"))
+        {
+            verify = Yes;
+            headless = Yes;
+        }
+        else if ( ! strcmp(argv[i], "--check-allocations"))
+        {
+#ifdef COUNT_ALLOCATIONS
+            game.checkAllocations = Yes;
+#else
+            fprintf(stderr, "This build can't count the heap allocations (glibc without a sanitizer only)\n");
+            return (EXIT_FAILURE);
+#endif
+        }
+        else if ( ! strcmp(argv[i], "--verify-seeds") && i + 1 < argc)
+        {
+            if ( ! parse_dimension(argv[++i], &verifySeeds))
+            {
+                fprintf(stderr, "Invalid number of seeds: %s\n", argv[i]);
+                return (EXIT_FAILURE);
+            }
+        }
+        else if ( ! strcmp(argv[i], "--load") && i + 1 < argc)
+        {
+            game.loadPath = argv[++i];
+        }
+        else if ( ! strcmp(argv[i], "--save") && i + 1 < argc)
+        {
+            game.savePath = argv[++i];
+        }
+        else if ( ! strcmp(argv[i], "--checkpoint") && i + 1 < argc)
+        {
+            checkpoint.path = argv[++i];
+        }
+        else if ( ! strcmp(argv[i], "--checkpoint-every") && i + 1 < argc)
+        {
+            if ( ! parse_count(argv[++i], &checkpoint.every) || ! checkpoint.every)
             {
-                switch (evt.type)
-                {
-                    case SDL_MOUSEBUTTONDOWN:
-                        
-                        if (evt.button.button == SDL_BUTTON_LEFT)
-                        {
-                            if (button_is_clicked(game.startBtn, evt.button.x, evt.button.y))
-                            {
-                                game.playing = Yes;
-                                button_set_active(game.resetBtn, 0);
-                                button_set_active(game.startBtn, 0);
-                                button_set_active(game.stopBtn, 1);
-                            }
-                            else if (button_is_clicked(game.resetBtn, evt.button.x, evt.button.y))
-                            {
-                                board_reset(&game);
-                            }
-                            else 
-                            {
-                                mouseButtonDown = Yes;
-                                game.board[evt.button.y / kTileSize][evt.button.x / kTileSize] = 1;
-                            }
-                            
-                        }
-                        break;
-                        
-                    case SDL_MOUSEBUTTONUP:
-                        if ( ! game.playing)
-                        {
-                                mouseButtonDown = evt.button.button != SDL_BUTTON_LEFT;
-                        }
-                        break;
-                        
-                    case SDL_MOUSEMOTION:
-                        if (mouseButtonDown)
-                        {
-                            game.board[evt.motion.y / kTileSize][evt.button.x / kTileSize] = 1;
-                        }
-                        break;
-                }
-            } 
+                fprintf(stderr, "Invalid number of generations: %s\n", argv[i]);
+                return (EXIT_FAILURE);
+            }
+        }
+        else if ( ! strcmp(argv[i], "--checkpoint-seconds") && i + 1 < argc)
+        {
+            Uint64 seconds;
+            if ( ! parse_count(argv[++i], &seconds) || ! seconds)
+            {
+                fprintf(stderr, "Invalid number of seconds: %s\n", argv[i]);
+                return (EXIT_FAILURE);
+            }
+            checkpoint.seconds = (double)seconds;
+        }
+        else if ( ! strcmp(argv[i], "--record") && i + 1 < argc)
+        {
+            recordPath = argv[++i];
+        }
+        else if ( ! strcmp(argv[i], "--record-format") && i + 1 < argc)
+        {
+            i++;
+            if ( ! strcmp(argv[i], "frames") || ! strcmp(argv[i], "delta"))
+            {
+                recordFormat = ! strcmp(argv[i], "frames") ? RECORD_FRAMES : RECORD_DELTA;
+            }
             else
             {
-                if (evt.type == SDL_MOUSEBUTTONDOWN)
-                {
-                    game.playing = ! button_is_clicked(game.stopBtn, evt.button.x, evt.button.y);
-                    button_set_active(game.resetBtn, !game.playing);
-                    button_set_active(game.startBtn, !game.playing);
-                    button_set_active(game.stopBtn,   game.playing);
-                }
+                fprintf(stderr, "Invalid recording format: %s (frames or delta)\n", argv[i]);
+                return (EXIT_FAILURE);
             }
         }
-        if ( ! game.useOpenGL)
+        else if ( ! strcmp(argv[i], "--record-every") && i + 1 < argc)
         {
-            SDL_FillRect(game.screen, NULL, 0);
+            if ( ! parse_count(argv[++i], &recordEvery) || ! recordEvery)
+            {
+                fprintf(stderr, "Invalid number of generations: %s\n", argv[i]);
+                return (EXIT_FAILURE);
+            }
         }
-        
-        drawTime = get_usec();
-        if (game.playing == Yes)
+        else if ( ! strcmp(argv[i], "--resume"))
         {
-            game.computeBoardFunc(game.board, game.temp);
-        } 
-        draw_time(game.screen, game.defaultFont, "Compute: ",get_usec() - drawTime, 30);
-        
-        drawTime = get_usec();
-        game.drawBoardFunc(game);
-        
-        button_draw(game.startBtn, game.screen);
-        button_draw(game.stopBtn,  game.screen);
-        button_draw(game.resetBtn, game.screen);
-        
-        result = ticks - start;
-        if (result)
+            resume = Yes;
+        }
+        else if ( ! strcmp(argv[i], "--mpi"))
         {
-            draw_fps(game.screen, game.defaultFont, (++frame * 1000) / result);
+#ifdef USE_MPI
+            mpiRun = Yes;
+#else
+            fprintf(stderr, "This build has no MPI, see make mpi\n");
+            return (EXIT_FAILURE);
+#endif
         }
-        draw_time(game.screen, game.defaultFont, "Draw: ", get_usec() - drawTime, 50);
-
-        if ( ! game.useOpenGL)
+        else if ( ! strcmp(argv[i], "--auto"))
+        {
+            autoTune = Yes;
+        }
+        else if ( ! strcmp(argv[i], "--auto-every") && i + 1 < argc)
         {
-            SDL_Flip(game.screen);
+            if ( ! parse_count(argv[++i], &autoEvery) || ! autoEvery)
+            {
+                fprintf(stderr, "Invalid number of generations: %s\n", argv[i]);
+                return (EXIT_FAILURE);
+            }
+        }
+        else if ( ! strcmp(argv[i], "--auto-profile") && i + 1 < argc)
+        {
+            autoProfile = argv[++i];
+        }
+        else if ( ! strcmp(argv[i], "--ensemble") && i + 1 < argc)
+        {
+            if ( ! parse_dimension(argv[++i], &ensemble))
+            {
+                fprintf(stderr, "Invalid number of boards: %s\n", argv[i]);
+                return (EXIT_FAILURE);
+            }
+        }
+        else if ( ! strcmp(argv[i], "--ensemble-csv") && i + 1 < argc)
+        {
+            ensembleCsv = argv[++i];
+        }
+        else if ( ! strcmp(argv[i], "--mpi-rebalance") && i + 1 < argc)
+        {
+            if ( ! parse_count(argv[++i], &mpiRebalance))
+            {
+                fprintf(stderr, "Invalid number of generations: %s\n", argv[i]);
+                return (EXIT_FAILURE);
+            }
+        }
+        else if ( ! strcmp(argv[i], "--detect-cycle"))
+        {
+            detectCycle = Yes;
+        }
+        else if ( ! strcmp(argv[i], "--bench-sizes") && i + 1 < argc)
+        {
+            benchSizeCount = sizeof(benchSizes) / sizeof(benchSizes[0]);
+            if ( ! parse_sizes(argv[++i], benchSizes, &benchSizeCount))
+            {
+                fprintf(stderr, "Invalid board sizes: %s (N,N,... up to 16 of them)\n", argv[i]);
+                return (EXIT_FAILURE);
+            }
+        }
+        else if ( ! strcmp(argv[i], "--bench-densities") && i + 1 < argc)
+        {
+            Uint32 d;
+            int valid;
+            benchDensityCount = sizeof(benchDensities) / sizeof(benchDensities[0]);
+            valid = parse_sizes(argv[++i], benchDensities, &benchDensityCount);
+            for (d = 0; valid && d < benchDensityCount; d++)
+            {
+                valid = benchDensities[d] <= 100;
+            }
+            if ( ! valid)
+            {
+                fprintf(stderr, "Invalid densities: %s (P,P,... up to 16 percentages)\n", argv[i]);
+                return (EXIT_FAILURE);
+            }
+        }
+        else if ( ! strcmp(argv[i], "--bench-trials") && i + 1 < argc)
+        {
+            if ( ! parse_dimension(argv[++i], &benchTrials) || benchTrials > 16)
+            {
+                fprintf(stderr, "Invalid number of trials: %s (1 to 16)\n", argv[i]);
+                return (EXIT_FAILURE);
+            }
+        }
+        else if ( ! strcmp(argv[i], "--bench-filter") && i + 1 < argc)
+        {
+            benchFilter = argv[++i];
+        }
+        else if ( ! strcmp(argv[i], "--metrics") && i + 1 < argc)
+        {
+            metricsAddress = argv[++i];
+        }
+        else if ( ! strcmp(argv[i], "--profile-csv") && i + 1 < argc)
+        {
+            game.profileCsv = argv[++i];
+        }
+        else if ( ! strcmp(argv[i], "--profile-trace") && i + 1 < argc)
+        {
+            game.profileTrace = argv[++i];
+        }
+        else if ( ! strcmp(argv[i], "--generations") && i + 1 < argc)
+        {
+            if ( ! parse_count(argv[++i], &generations))
+            {
+                fprintf(stderr, "Invalid number of generations: %s\n", argv[i]);
+                return (EXIT_FAILURE);
+            }
+        }
+        else if ( ! strcmp(argv[i], "--seed") && i + 1 < argc)
+        {
+            if ( ! parse_count(argv[++i], &seed))
+            {
+                fprintf(stderr, "Invalid seed: %s\n", argv[i]);
+                return (EXIT_FAILURE);
+            }
+        }
+        else if ( ! strcmp(argv[i], "--density") && i + 1 < argc)
+        {
+            if ( ! parse_dimension(argv[++i], &density) || density > 100)
+            {
+                fprintf(stderr, "Invalid density: %s\n", argv[i]);
+                return (EXIT_FAILURE);
+            }
+        }
+        else if ( ! strcmp(argv[i], "--width") && i + 1 < argc)
+        {
+            if ( ! parse_dimension(argv[++i], &game.width))
+            {
+                fprintf(stderr, "Invalid width: %s\n", argv[i]);
+                return (EXIT_FAILURE);
+            }
+        }
+        else if ( ! strcmp(argv[i], "--height") && i + 1 < argc)
+        {
+            if ( ! parse_dimension(argv[++i], &game.height))
+            {
+                fprintf(stderr, "Invalid height: %s\n", argv[i]);
+                return (EXIT_FAILURE);
+            }
         }
         else
         {
-            glClear(GL_COLOR_BUFFER_BIT);
-
-            glBegin(GL_TRIANGLES);
-                glColor3ub(255,0,0);    glVertex2d(-0.75,-0.75);
-                glColor3ub(0,255,0);    glVertex2d(0,0.75);
-                glColor3ub(0,0,255);    glVertex2d(0.75,-0.75);
-            glEnd();
-
-            glFlush();
-            SDL_GL_SwapBuffers();
+            fprintf(stderr, "Unknow argument: %s\n", argv[i]);
+            fprintf(stderr, "Usage: %s [--openmp|--simd|--tiled|--temporal|--active|--thread|--opengl] [--packed] [--width N] [--height N]\n"
+                            "       [--tile N] [--schedule static|dynamic|guided[,chunk]] [--depth K] [--threads N]\n"
+                            "       [--sim-thread] [--rate GENERATIONS_PER_SEC] [--profile-csv FILE] [--profile-trace FILE] [--metrics [HOST:]PORT]\n"
+                            "       [--load FILE.rle|FILE.cells|SNAPSHOT] [--save FILE.rle|FILE.cells|SNAPSHOT]\n"
+                            "       [--rule B3/S23|B2/S345/C4|R5,C0,M1,S34..58,B34..45,NM] [--topology dead|torus|klein|alive]\n"
+                            "       %s --headless [--generations N] [--seed N] [--density PERCENT] [--detect-cycle] [--check-allocations] [...]\n"
+                            "       %s --headless --auto [--auto-every N] [--auto-profile FILE] [...]\n"
+                            "       %s --headless --checkpoint FILE [--checkpoint-every N] [--checkpoint-seconds T] [--resume] [...]\n"
+                            "       %s --headless --record FILE|'|COMMAND' [--record-format frames|delta] [--record-every N] [...]\n"
+                            "       %s --verify [--generations N] [--seed N] [--verify-seeds N] [--density PERCENT] [...]\n"
+                            "       mpirun -np RANKS %s --headless --mpi [--mpi-rebalance N] [--packed] [--topology dead|torus|alive] [...]\n"
+                            "       %s --headless --hashlife [--generations N|--jump K] [--memory MB] [...]\n"
+                            "       %s --headless --sparse [--generations N] [...]\n"
+                            "       %s --headless --ensemble BOARDS [--ensemble-csv FILE] [--generations N] [--seed N] [...]\n"
+                            "       %s --headless --draw-bench [--generations FRAMES] [...]\n"
+                            "       %s --bench [--bench-sizes N,N,...] [--bench-trials N] [--bench-filter NAME] [--bench-densities P,P,...] [--seed N] [--load BREEDER]\n",
+                            argv[0], argv[0], argv[0], argv[0], argv[0], argv[0], argv[0], argv[0], argv[0], argv[0], argv[0],
+                            argv[0]);
+            return (EXIT_FAILURE);
         }
     }
-}
-
-/*
- * Entry point
- */
-int main(int argc, char** argv) 
-{
-    GameContainer game;
     
-    if (argc == 1)
+    if ((checkpoint.path || recordPath || game.checkAllocations) && ( ! headless || hashlife || sparse || drawBench || verify))
     {
-        game.computeBoardFunc = board_compute;
-        game.drawBoardFunc = draw_board;
-        printf("Using single core\n");
+        fprintf(stderr, "--checkpoint, --record and --check-allocations only apply to --headless runs of the board\n");
+        return (EXIT_FAILURE);
+    }
+    // The board is only written by the window and the headless run of the board
+    if (game.savePath && (hashlife || sparse || drawBench || verify || bench))
+    {
+        fprintf(stderr, "--save only writes the board of a window or of a --headless run, not --hashlife, --sparse, --verify or the benchmarks\n");
+        return (EXIT_FAILURE);
+    }
+    // Every jump of the sum must fit the largest root
+    if (hashlife && generations >> (LIFE_MAX_LEVEL - 3))
+    {
+        fprintf(stderr, "--hashlife runs fewer than 2^%d generations\n", LIFE_MAX_LEVEL - 3);
+        return (EXIT_FAILURE);
+    }
+    // Each rank runs the headless driver on its part of the board
+    if (mpiRun && ( ! headless || mode || hashlife || sparse || verify || drawBench || bench || detectCycle || checkpoint.path || recordPath ||
+                   game.loadPath || game.savePath || rule_is_extended(&gRule) || game.topology == TOPOLOGY_KLEIN))
+    {
+        fprintf(stderr, "--mpi only runs --headless random boards of a Life-like rule, dead, torus or alive edges, on its own backend\n");
+        return (EXIT_FAILURE);
+    }
+#ifdef USE_MPI
+    if (mpiRun)
+    {
+        mpi_start(&argc, &argv);
+    }
+#endif
+    
+    // Generations and Larger than Life only have the plain byte kernel
+    if (rule_is_extended(&gRule) && ((mode && strcmp(mode, "--openmp")) || game.format == BOARD_PACKED ||
+                                     hashlife || sparse || bench || verify || drawBench || detectCycle || checkpoint.path))
+    {
+        fprintf(stderr, "%s only runs on the default or --openmp byte board, without --detect-cycle or --checkpoint\n", gRule.name);
+        return (EXIT_FAILURE);
+    }
+    // The other backends see past the edges on their own, or not at all
+    if (game.topology != TOPOLOGY_DEAD &&
+        ((mode && ( ! strcmp(mode, "--temporal") || ! strcmp(mode, "--active") || ( ! strcmp(mode, "--opengl") && game.topology == TOPOLOGY_KLEIN))) ||
+         hashlife || sparse || bench || rule_is_extended(&gRule) || (game.simulationThread && game.format == BOARD_PACKED)))
+    {
+        fprintf(stderr, "--topology doesn't support --active, --temporal, --hashlife, --sparse, --bench, extended rules, "
+                        "klein on --opengl, or --sim-thread with --packed\n");
+        return (EXIT_FAILURE);
+    }
+    // The tuner picks the backend and the storage itself
+    if (autoTune && ( ! headless || mode || game.format == BOARD_PACKED || hashlife || sparse || verify || drawBench || bench || mpiRun ||
+                      rule_is_extended(&gRule)))
+    {
+        fprintf(stderr, "--auto only picks the backend of --headless runs of a Life-like rule, without another mode or --packed\n");
+        return (EXIT_FAILURE);
+    }
+    // The boards of an ensemble are stepped together on a kernel of their own
+    if ((ensemble || ensembleCsv) && ( ! headless || ! ensemble || mode || game.format == BOARD_PACKED || hashlife || sparse || verify ||
+                                       drawBench || bench || mpiRun || autoTune || detectCycle || checkpoint.path || recordPath ||
+                                       game.loadPath || game.savePath || game.simulationThread || rule_is_extended(&gRule)))
+    {
+        fprintf(stderr, "--ensemble only runs --headless random boards of a Life-like rule, on its own backend\n");
+        return (EXIT_FAILURE);
+    }
+    // The metrics follow a single board, stepped by game_step
+    if (metricsAddress && (hashlife || sparse || verify || drawBench || bench || ensemble || mpiRun))
+    {
+        fprintf(stderr, "--metrics only follows the board of a window or of a --headless run\n");
+        return (EXIT_FAILURE);
+    }
+    if (autoTune && ! autoProfile && getenv("HOME"))
+    {
+        snprintf(autoPath, sizeof(autoPath), "%s/.gamelive-profile", getenv("HOME"));
+        autoProfile = autoPath;
+    }
+    if (checkpoint.path && ! checkpoint.every && checkpoint.seconds <= 0)
+    {
+        checkpoint.every = 10000;
+    }
+    if (resume)
+    {
+        SnapshotHeader header;
+        if ( ! checkpoint.path)
+        {
+            fprintf(stderr, "--resume needs --checkpoint FILE\n");
+            return (EXIT_FAILURE);
+        }
+        // The run goes on to the same --generations, from the last checkpoint if there is one
+        if ( ! snapshot_read_header(checkpoint.path, &header))
+        {
+            game.loadPath = checkpoint.path;
+            generations = generations > header.generation ? generations - header.generation : 0;
+            printf("Resuming from generation %llu of %s\n", (unsigned long long)header.generation, checkpoint.path);
+        }
+    }
+    
+    // A snapshot brings the size of its board
+    if (game.loadPath)
+    {
+        SnapshotHeader header;
+        if ( ! snapshot_read_header(game.loadPath, &header))
+        {
+            game.width = header.width;
+            game.height = header.height;
+        }
+        else if (access(game.loadPath, R_OK))
+        {
+            fprintf(stderr, "Can't read %s\n", game.loadPath);
+            return (EXIT_FAILURE);
+        }
+    }
+    
+    specialized = rule_select(&gRule);
+    
+    // The benchmark picks the backends itself, only the CSV goes to stdout
+    if (bench)
+    {
+        run_bench(benchSizes, benchSizeCount, benchDensities, benchDensityCount, benchFilter, benchTrials, seed, game.loadPath);
+        return (EXIT_SUCCESS);
     }
-    else if (argc == 2)
+    if (ensemble)
     {
-        if ( ! strcmp(argv[1], "--openmp"))
+        return (run_ensemble(&game, ensemble, generations, seed, density, ensembleCsv));
+    }
+    
+    printf("Rule %s, %s\n", gRule.name, rule_is_extended(&gRule) ? "plain byte kernel" : specialized ? "specialized kernels" : "generic kernels");
+    if (rule_is_extended(&gRule))
+    {
+        game.computeBoardFunc = mode ? board_compute_extended_openmp : board_compute_extended;
+        if (mode)
         {
-            game.computeBoardFunc = board_compute_openmp;
             game.drawBoardFunc = draw_board_openmp;
             printf("Using OpenMP with as much core as possible (%d)\n", omp_get_num_procs());
         }
-        else if ( ! strcmp(argv[1], "--thread"))
+        else
         {
-            game.computeBoardFunc = board_compute;
-            game.drawBoardFunc = draw_board_multithread;
-            printf("Using multithreading\n");
+            printf("Using single core\n");
         }
-        else if ( ! strcmp(argv[1], "--opengl"))
+    }
+#ifdef USE_MPI
+    else if (mpiRun)
+    {
+        game.computeBoardFunc = board_compute_mpi;
+    }
+#endif
+    else if (autoTune)
+    {
+        auto_create(&tuner, autoProfile, autoEvery);
+        printf("Picking the backend as the run goes (--auto, %d cores)\n", omp_get_num_procs());
+    }
+    else if ( ! mode)
+    {
+        game.computeBoardFunc = game.format == BOARD_PACKED ? board_compute_packed : board_compute;
+        printf("Using single core\n");
+    }
+    else if ( ! strcmp(mode, "--openmp"))
+    {
+        game.computeBoardFunc = game.format == BOARD_PACKED ? board_compute_packed_openmp : board_compute_openmp;
+        game.drawBoardFunc = draw_board_openmp;
+        printf("Using OpenMP with as much core as possible (%d)\n", omp_get_num_procs());
+    }
+    else if ( ! strcmp(mode, "--simd"))
+    {
+        const char * isa = NULL;
+        game.computeRowFunc = simd_select(game.format, &isa);
+        game.computeBoardFunc = board_compute_simd;
+        game.drawBoardFunc = draw_board_openmp;
+        printf("Using %s with OpenMP (%d cores)\n", isa, omp_get_num_procs());
+    }
+    else if ( ! strcmp(mode, "--tiled"))
+    {
+        game_set_block_size(&game, block);
+        game.computeBoardFunc = board_compute_tiled;
+        game.drawBoardFunc = draw_board_openmp;
+        printf("Using OpenMP on %ux%u tiles (%d cores)\n", game.blockWidth, game.blockHeight, omp_get_num_procs());
+    }
+    else if ( ! strcmp(mode, "--temporal"))
+    {
+        game_set_block_size(&game, block);
+        game.computeBoardFunc = board_compute_temporal;
+        game.drawBoardFunc = draw_board_openmp;
+        printf("Using OpenMP on %ux%u tiles, %u generations per sweep (%d cores)\n",
+               game.blockWidth, game.blockHeight, game.temporalDepth, omp_get_num_procs());
+    }
+    else if ( ! strcmp(mode, "--active"))
+    {
+        game.computeBoardFunc = board_compute_active;
+        game.drawBoardFunc = draw_board_active;
+        game.partialDraw = Yes;
+        game.redrawAll = Yes;
+        printf("Using OpenMP on the active %ux%u tiles only (%d cores)\n", kActiveTileSize, kActiveTileSize, omp_get_num_procs());
+    }
+    else if ( ! strcmp(mode, "--thread"))
+    {
+        if ( ! threads)
         {
-            game.useOpenGL = Yes;
-            game.computeBoardFunc = board_compute;
-            game.drawBoardFunc = draw_board;
+            threads = (Uint32)sysconf(_SC_NPROCESSORS_ONLN);
         }
-        else
+        game.pool = worker_pool_create(threads);
+        if ( ! game.pool)
         {
-            fprintf(stderr, "Unknow argument: %s\n", argv[1]);
+            fprintf(stderr, "Not enough memory for the worker pool\n");
             return (EXIT_FAILURE);
         }
+        game.computeRowFunc = game.format == BOARD_PACKED ? board_compute_packed_thread : board_compute_thread;
+        game.computeBoardFunc = board_compute_multithread;
+        game.drawBoardFunc = draw_board_multithread;
+        printf("Using multithreading (%u threads)\n", game.pool->count);
     }
     else
     {
-        fprintf(stderr, "Only --openmp argument may be used for this program\n");
-        return (EXIT_FAILURE);        
+        game.computeBoardFunc = board_compute_gpu;
+        game.drawBoardFunc = draw_board_gpu;
+        game.useOpenGL = Yes;
+        printf("Using OpenGL: the board is computed and drawn on the GPU\n");
     }
+    printf("Board of %ux%u cells%s\n", game.width, game.height, game.format == BOARD_PACKED ? ", one bit per cell" : "");
     
-    // Initialize our libs
-    if (game.useOpenGL)
+    if (game.simulationThread && ! headless)
+    {
+        if (game.useOpenGL)
+        {
+            fprintf(stderr, "--sim-thread can't be used with --opengl\n");
+            return (EXIT_FAILURE);
+        }
+        // The renderer may skip generations: no partial draw. The worker pool is kept for the compute.
+        if (game.drawBoardFunc == draw_board_active || game.drawBoardFunc == draw_board_multithread)
+        {
+            game.drawBoardFunc = draw_board_openmp;
+        }
+        game.partialDraw = No;
+        if (game.targetRate > 0)
+        {
+            printf("Computing on a thread of its own, %.0f generations/sec\n", game.targetRate);
+        }
+        else
+        {
+            printf("Computing on a thread of its own, as fast as possible\n");
+        }
+    }
+    
+    // Once the backend and its pool are picked: the counters are per thread
+    if (metricsAddress)
     {
-        SDL_Init(SDL_OPENGL);
+        metrics_create(&game, metricsAddress);
+        printf("Serving the metrics on http://%s/metrics\n", game.metrics->address);
     }
-    else
+    
+    if (headless)
     {
-        SDL_Init(SDL_INIT_EVERYTHING);
+        if (game.useOpenGL)
+        {
+            fprintf(stderr, "--opengl can't be used with --headless\n");
+            return (EXIT_FAILURE);
+        }
+        if (hashlife)
+        {
+            printf("Using HashLife\n");
+            run_hashlife(&game, generations, seed, density, (size_t)memory * 1024 * 1024);
+        }
+        else if (drawBench)
+        {
+            run_draw_bench(&game, generations, seed, density);
+        }
+        else if (sparse)
+        {
+            printf("Using the sparse universe (%d cores)\n", omp_get_num_procs());
+            run_sparse(&game, generations, seed, density);
+        }
+        else if (verify)
+        {
+            status = run_verify(&game, generations, seed, verifySeeds, density);
+        }
+#ifdef USE_MPI
+        else if (mpiRun)
+        {
+            mpi_domain_create(&game, mpiRebalance);
+            status = run_headless(&game, generations, seed, density, No, NULL, NULL, NULL);
+            mpi_domain_dispose(&game);
+        }
+#endif
+        else
+        {
+            Recorder * recorder = NULL;
+            if (recordPath)
+            {
+                recorder = recorder_create(recordPath, recordFormat, recordEvery, game.width, game.height);
+            }
+            status = run_headless(&game, generations, seed, density, detectCycle, checkpoint.path ? &checkpoint : NULL, recorder,
+                                  autoTune ? &tuner : NULL);
+            if (recorder)
+            {
+                recorder_dispose(recorder);
+            }
+        }
+        if (game.metrics)
+        {
+            metrics_dispose(&game);
+        }
+        if (game.pool)
+        {
+            worker_pool_dispose(game.pool);
+        }
+        return (status);
     }
+    
+    game_fit_window(&game, &windowWidth, &windowHeight);
+    
+    // Initialize our libs
+    SDL_Init(SDL_INIT_EVERYTHING);
     TTF_Init();
     
-    // Create the video screen
-    SDL_SetVideoMode(kBoardWidth * kTileSize, kBoardHeight * kTileSize, 32, 0);
+    // Create the video screen. Swap the OpenGL buffers on the display refresh.
+    if (game.useOpenGL)
+    {
+        SDL_GL_SetAttribute(SDL_GL_DOUBLEBUFFER, 1);
+        SDL_GL_SetAttribute(SDL_GL_SWAP_CONTROL, 1);
+    }
+    SDL_SetVideoMode(windowWidth, windowHeight, 32, game.useOpenGL ? SDL_OPENGL : 0);
     
     // Create the game
     initialize_game(&game);
+    if (game.simulationThread)
+    {
+        game.simulation = simulation_create(&game);
+    }
 
-    do_main_loop(game);
+    do_main_loop(&game);
     
     // Exit gently
+    if (game.simulation)
+    {
+        simulation_dispose(&game);
+    }
     dispose_game(&game);
+    if (game.metrics)
+    {
+        metrics_dispose(&game);
+    }
+    if (game.pool)
+    {
+        worker_pool_dispose(game.pool);
+    }
     TTF_Quit();
     SDL_Quit();
     